@@ -73,6 +73,21 @@ void setup() {
   MONITOR_SERIAL.print('.');
   MONITOR_SERIAL.println(radar.firmware_bugfix_version, HEX);
 
+  // Optional: wake the task the moment the UART receives bytes, instead of
+  // polling every 10 ms. Needs HardwareSerial::onReceive() (arduino-esp32
+  // 2.0.3 and later).
+  //   static ld2410_task_notify_wake_source radarWake;
+  //   radar.setWakeSource(radarWake);
+  //   RADAR_SERIAL.onReceive([]() { radar.notifyDataAvailable(); });
+
+  // Optional: be told about every frame instead of polling the getters in
+  // loop(). The callback runs in the reader task, so it only hands the
+  // snapshot over to a queue that another task (or loop()) receives from.
+  //   static QueueHandle_t frames = xQueueCreate(4, sizeof(RadarSnapshot));
+  //   radar.onDataFrame([](ld2410_base &, const RadarSnapshot &snapshot, void *queue) {
+  //     xQueueSend((QueueHandle_t)queue, &snapshot, 0);
+  //   }, frames);
+
   // Spawn the background reader task. Defaults: stack=4096, priority=1,
   // core=tskNO_AFFINITY (FreeRTOS picks a free core). Override the args if
   // your sketch needs to pin to a specific core or change priority.
@@ -0,0 +1,76 @@
+/*
+ * Example sketch reading two LD2410 radars from one FreeRTOS task on ESP32.
+ *
+ * Each radar could have its own radar.autoReadTask(), but every task needs
+ * its own stack and wakes up on its own. An ld2410_scheduler services all of
+ * the registered radars from a single task instead: it drains both UARTs,
+ * then parses their frames in turn under a time budget.
+ *
+ * On boards without FreeRTOS, leave out scheduler.autoReadTask() and call
+ * scheduler.service() from loop() instead of each radar's read().
+ *
+ * Pin map (ESP32):
+ *   Radar 1 -> LD2410 TX→GPIO 32, RX→GPIO 33 (Serial1)
+ *   Radar 2 -> LD2410 TX→GPIO 16, RX→GPIO 17 (Serial2)
+ */
+
+#if !defined(ESP32)
+  #error "This example uses a FreeRTOS task and needs an ESP32 with two spare UARTs."
+#endif
+
+#define MONITOR_SERIAL Serial
+
+#include <ld2410.h>
+#include <ld2410_scheduler.h>
+
+ld2410 radar1;
+ld2410 radar2;
+ld2410_scheduler scheduler;
+uint32_t lastReading = 0;
+
+void printRadar(const char *name, ld2410 &radar) {
+  MONITOR_SERIAL.print(name);
+  if (!radar.isConnected()) {
+    MONITOR_SERIAL.println(F(": not connected"));
+  } else if (radar.presenceDetected()) {
+    MONITOR_SERIAL.print(F(": target at "));
+    MONITOR_SERIAL.print(radar.getSnapshot().detection_distance);
+    MONITOR_SERIAL.println(F("cm"));
+  } else {
+    MONITOR_SERIAL.println(F(": no target"));
+  }
+}
+
+void setup() {
+  MONITOR_SERIAL.begin(115200);
+  Serial1.begin(256000, SERIAL_8N1, 32, 33);
+  Serial2.begin(256000, SERIAL_8N1, 16, 17);
+  delay(500);
+
+  if (!radar1.begin(Serial1)) {
+    MONITOR_SERIAL.println(F("Radar 1 not connected"));
+  }
+  if (!radar2.begin(Serial2)) {
+    MONITOR_SERIAL.println(F("Radar 2 not connected"));
+  }
+  scheduler.add(radar1);
+  scheduler.add(radar2);
+
+  // Optional: wake the task as soon as either UART receives bytes.
+  //   static ld2410_task_notify_wake_source radarWake;
+  //   scheduler.setWakeSource(radarWake);
+  //   Serial1.onReceive([]() { radar1.notifyDataAvailable(); });
+  //   Serial2.onReceive([]() { radar2.notifyDataAvailable(); });
+
+  if (!scheduler.autoReadTask()) {
+    MONITOR_SERIAL.println(F("autoReadTask: failed to create FreeRTOS task"));
+  }
+}
+
+void loop() {
+  if (millis() - lastReading > 1000) {
+    lastReading = millis();
+    printRadar("Radar 1", radar1);
+    printRadar("Radar 2", radar2);
+  }
+}
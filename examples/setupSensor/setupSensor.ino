@@ -50,8 +50,11 @@
 #endif
 
 #include <ld2410.h>
+#include <ld2410_calibration.h>
 
 ld2410 radar;
+ld2410_calibration calibration;
+bool calibrating = false;
 bool engineeringMode = false;
 String command;
 
@@ -85,12 +88,56 @@ void setup(void)
   {
     MONITOR_SERIAL.println(F("not connected"));
   }
-  MONITOR_SERIAL.println(F("Supported commands\nread: read current values from the sensor\nreadconfig: read the configuration from the sensor\nsetmaxvalues <motion gate> <stationary gate> <inactivitytimer>\nsetsensitivity <gate> <motionsensitivity> <stationarysensitivity>\nenableengineeringmode: enable engineering mode\ndisableengineeringmode: disable engineering mode\nrestart: restart the sensor\nreadversion: read firmware version\nfactoryreset: factory reset the sensor\n"));
+  MONITOR_SERIAL.println(F("Supported commands\nread: read current values from the sensor\nreadconfig: read the configuration from the sensor\nsetmaxvalues <motion gate> <stationary gate> <inactivitytimer>\nsetsensitivity <gate> <motionsensitivity> <stationarysensitivity>\nenableengineeringmode: enable engineering mode\ndisableengineeringmode: disable engineering mode\nrestart: restart the sensor\nreadversion: read firmware version\nfactoryreset: factory reset the sensor\ncalibrate <seconds>: measure the empty room and set every gate's sensitivity just above it\n"));
+}
+
+void printCalibrationReport()
+{
+  const ld2410_calibration_report &report = calibration.report();
+  MONITOR_SERIAL.print(F("Calibration from "));
+  MONITOR_SERIAL.print(report.frames);
+  MONITOR_SERIAL.print(F(" frames: "));
+  if(calibration.status() == LD2410_CALIBRATION_SUCCEEDED)
+  {
+    MONITOR_SERIAL.println(F("OK"));
+  }
+  else if(calibration.status() == LD2410_CALIBRATION_NO_FRAMES)
+  {
+    MONITOR_SERIAL.println(F("no engineering frames received"));
+    return;
+  }
+  else
+  {
+    MONITOR_SERIAL.println(F("failed"));
+    return;
+  }
+  for(uint8_t gate = 0; gate < 9; gate++)
+  {
+    MONITOR_SERIAL.print(F("Gate "));
+    MONITOR_SERIAL.print(gate);
+    MONITOR_SERIAL.print(F(" moving energy max "));
+    MONITOR_SERIAL.print(report.moving.max[gate]);
+    MONITOR_SERIAL.print(F(" sensitivity "));
+    MONITOR_SERIAL.print(report.old_moving[gate]);
+    MONITOR_SERIAL.print(F("->"));
+    MONITOR_SERIAL.print(report.new_moving[gate]);
+    MONITOR_SERIAL.print(F(" stationary energy max "));
+    MONITOR_SERIAL.print(report.stationary.max[gate]);
+    MONITOR_SERIAL.print(F(" sensitivity "));
+    MONITOR_SERIAL.print(report.old_stationary[gate]);
+    MONITOR_SERIAL.print(F("->"));
+    MONITOR_SERIAL.println(report.new_stationary[gate]);
+  }
 }
 
 void loop()
 {
   radar.read(); //Always read frames from the sensor
+  if(calibrating && calibration.step())  //Calibration runs in the background, a step on each loop
+  {
+    calibrating = false;
+    printCalibrationReport();
+  }
   if(MONITOR_SERIAL.available())
   {
     char typedCharacter = MONITOR_SERIAL.read();
@@ -295,6 +342,24 @@ void loop()
           MONITOR_SERIAL.println(F("Failed"));
         }
       }
+      else if(command.startsWith("calibrate"))
+      {
+        int firstSpace = command.indexOf(' ');
+        uint32_t seconds = firstSpace > 0 ? (command.substring(firstSpace,command.length())).toInt() : 30;
+        command = "";
+        MONITOR_SERIAL.print(F("Calibrating for "));
+        MONITOR_SERIAL.print(seconds);
+        MONITOR_SERIAL.print(F("s, leave the room empty: "));
+        if(calibration.start(radar, seconds * 1000))
+        {
+          calibrating = true;
+          MONITOR_SERIAL.println(F("started"));
+        }
+        else
+        {
+          MONITOR_SERIAL.println(F("failed"));
+        }
+      }
       else if(command.equals("factoryreset"))
       {
         command = "";
@@ -13,54 +13,299 @@
 #ifndef ld2410_cpp
 #define ld2410_cpp
 #include "ld2410.h"
+#include "ld2410_capture.h"
+#include "ld2410_history.h"
+#include "ld2410_gates.h"
+#include "ld2410_background.h"
+#include "ld2410_scheduler.h"
+#include "ld2410_linux.h"
 
 // Magic header bytes for the two frame kinds. The protocol document
 // (HLK-LD2410C V1.00 §2.3) defines them as fixed 4-byte preambles; the
 // parser validates all four bytes before committing to a frame.
 static const uint8_t LD2410_DATA_HDR[4] = {0xF4, 0xF3, 0xF2, 0xF1};
 static const uint8_t LD2410_CMD_HDR[4]  = {0xFD, 0xFC, 0xFB, 0xFA};
+static const uint8_t LD2410_DATA_FTR[4] = {0xF8, 0xF7, 0xF6, 0xF5};
+static const uint8_t LD2410_CMD_FTR[4]  = {0x04, 0x03, 0x02, 0x01};
+
+// States of the command engine, see service_commands_().
+enum : uint8_t {
+    LD2410_ENGINE_IDLE = 0,
+    LD2410_ENGINE_ENTERING,
+    LD2410_ENGINE_COMMAND_GAP,
+    LD2410_ENGINE_COMMAND_SENT,
+    LD2410_ENGINE_LEAVE_GAP,
+    LD2410_ENGINE_LEAVING,
+    LD2410_ENGINE_REBOOTING
+};
+static const uint8_t LD2410_COMMAND_SLOT_CLAIMED = 0x80;		// being filled in by queueCommand()
+
+static bool ld2410_command_finished(uint8_t status) {
+    return status == LD2410_COMMAND_SUCCEEDED || status == LD2410_COMMAND_FAILED ||
+           status == LD2410_COMMAND_TIMED_OUT;
+}
+
+// Offset of the first byte in p[0..n) that can start a header (0xF4 or 0xFD),
+// or n if there is none. memchr is word-at-a-time on newlib (ESP32, ARM) and
+// SIMD on glibc, so runs of junk after a reboot, a baud mismatch or line noise
+// are crossed far faster than by testing one byte per loop iteration. The
+// 0xFD search only has to cover the bytes before the first 0xF4.
+static uint16_t ld2410_find_header_start(const uint8_t* p, uint16_t n) {
+    const uint8_t* data = static_cast<const uint8_t*>(memchr(p, 0xF4, n));
+    const uint16_t limit = data ? (uint16_t)(data - p) : n;
+    const uint8_t* command = static_cast<const uint8_t*>(memchr(p, 0xFD, limit));
+    return command ? (uint16_t)(command - p) : limit;
+}
 
-ld2410::ld2410()	//Constructor function
+ld2410_base::ld2410_base(uint8_t *ring, uint16_t ringSize, uint8_t *frame, uint16_t frameSize) :	//Constructor function
+	radar_data_frame_(frame), max_frame_length_(frameSize), ring_(ring, ringSize)
 {
 }
 
-ld2410::~ld2410()	//Destructor function
+ld2410_base::~ld2410_base()	//Destructor function
 {
+	if(scheduler_ != nullptr)
+	{
+		scheduler_->remove(*this);
+	}
+#if defined(__linux__) && !defined(ARDUINO)
+	if(reactor_ != nullptr)
+	{
+		reactor_->remove(*this);
+	}
+#endif
 }
 
-void ld2410::add_to_buffer(uint8_t byte) {
-    // Inserisce il byte nel buffer circolare
-    circular_buffer[buffer_head] = byte;
-    buffer_head = (buffer_head + 1) % LD2410_BUFFER_SIZE;
+// Bulk UART ingestion: the producer side of ring_.
+//
+// Instead of one available()/read() round trip per byte, copy whatever the
+// UART has ready straight into the contiguous free span at the head of the
+// ring. A pass needs at most two reads: one up to the end of the array and
+// one for the wrapped remainder. They are only ever asked for bytes
+// available() has already promised, so nothing waits.
+//
+// On overflow, overflow_policy_ decides what goes. Dropping the oldest bytes
+// or frames consumes from the ring, a consumer-side operation, which is safe
+// because ingestion always runs on the parser's thread (read(), the
+// autoReadTask loop and the command wait loop all ingest and then parse).
+//
+// While rx_muted_ is set (the reboot window after requestRestart()) the
+// UART is drained with drain_uart_() instead.
+//
+// limit caps the bytes taken in one call. ld2410_reactor passes the ring's
+// free space, so a backlog in the kernel buffer is fed in chunks, each one
+// parsed before the next, rather than overwriting itself.
+// Only on cores where Stream::readBytes() is virtual (ESP32 and ESP8266,
+// LD2410_BULK_READBYTES) does it reach the UART driver's bulk copy. On the
+// AVR and ArduinoCore-API cores it is Stream's own loop, which calls
+// timedRead(), and so millis(), for every byte; a plain read() loop is
+// cheaper there.
+uint16_t ld2410_base::uart_read_(uint8_t *buffer, uint16_t length) {
+#if defined(LD2410_BULK_READBYTES)
+    return (uint16_t)radar_uart_->readBytes(buffer, length);
+#else
+    Stream *uart = radar_uart_;
+    uint16_t got = 0;
+    while (got < length) {
+        const int value = uart->read();
+        if (value < 0) {
+            break;
+        }
+        buffer[got++] = (uint8_t)value;
+    }
+    return got;
+#endif
+}
 
-    // Gestione del caso in cui il buffer si riempia
-    if (buffer_head == buffer_tail) {
-        buffer_tail = (buffer_tail + 1) % LD2410_BUFFER_SIZE;  // Sovrascrive i dati più vecchi
+// Every byte taken from the UART goes through here or ingest_uart_(), so a
+// capture is the exact byte stream even across commands and muted windows.
+// The bytes are read into the emptied ring's free span and never committed.
+void ld2410_base::drain_uart_() {
+    ring_.clear();
+    int available = radar_uart_->available();
+    while (available > 0) {
+        uint16_t span;
+        uint8_t* scratch = ring_.write_span(span);
+        const uint16_t chunk = ((uint32_t)available < span) ? (uint16_t)available : span;
+        const uint16_t got = chunk == 0 ? 0 : uart_read_(scratch, chunk);
+        if (got == 0) {
+            break;
+        }
+        capture_chunk_(scratch, got);
+        available = radar_uart_->available();
     }
 }
 
-// Funzione per leggere il buffer
-bool ld2410::read_from_buffer(uint8_t &byte) {
-    if (buffer_head == buffer_tail) {
-        return false;  // Buffer vuoto
-    } else {
-        byte = circular_buffer[buffer_tail];
-        buffer_tail = (buffer_tail + 1) % LD2410_BUFFER_SIZE;
-        return true;
+uint16_t ld2410_base::ingest_uart_(uint16_t limit) {
+    uint16_t ingested = 0;
+    int available = radar_uart_->available();
+    if (rx_muted_.load(ld2410_acquire)) {
+        drain_uart_();
+        return 0;
+    }
+    if (available > limit) {
+        available = limit;
+    }
+    while (available > 0) {
+        const uint16_t used = ring_.used();
+        const uint16_t free_space = ring_.size() - used;
+        note_high_water_((uint32_t)used + (uint32_t)available);
+        if ((uint32_t)available > free_space) {
+            const uint32_t excess = (uint32_t)available - free_space;
+            if (overflow_policy_ == LD2410_OVERFLOW_DROP_NEWEST) {
+                if (free_space == 0) {
+                    // Full: what is left of this batch goes, read in small
+                    // pieces straight off the UART.
+                    uint8_t discard[16];
+                    uint32_t lost = 0;
+                    while (lost < (uint32_t)available) {
+                        const uint32_t left = (uint32_t)available - lost;
+                        const uint16_t got = uart_read_(discard, left < sizeof(discard) ? left : sizeof(discard));
+                        if (got == 0) {
+                            break;
+                        }
+                        capture_chunk_(discard, got);
+                        lost += got;
+                    }
+                    count_(STAT_BUFFER_OVERRUNS);
+                    count_(STAT_BYTES_DROPPED, lost);
+                    break;
+                }
+                // Otherwise fill what is free; the rest goes next time round.
+            } else {
+                uint16_t lost;
+                if (overflow_policy_ == LD2410_OVERFLOW_DROP_FRAME) {
+                    lost = whole_frames_to_drop_(excess);
+                } else {
+                    lost = excess < used ? (uint16_t)excess : used;
+                }
+                if (lost > 0) {
+                    ring_.consume(lost);
+                    count_(STAT_BUFFER_OVERRUNS);
+                    count_(STAT_BYTES_DROPPED, lost);
+                }
+            }
+        }
+        uint16_t span;
+        uint8_t* destination = ring_.write_span(span);
+        const uint16_t chunk = ((uint32_t)available < span) ? (uint16_t)available : span;
+        const uint16_t got = uart_read_(destination, chunk);
+        if (got == 0) {
+            break;
+        }
+        capture_chunk_(destination, got);
+        ring_.commit(got);
+        ingested += got;
+        available -= got;
+        if (available <= 0 && ingested < limit) {
+            // Pick up bytes that landed during the copy, as far as they fit:
+            // overwriting what this call has just ingested, before it could
+            // be parsed, gains nothing, and the rest keeps for the next call.
+            available = radar_uart_->available();
+            const uint16_t room = ring_.size() - ring_.used();
+            if (available > room) {
+                available = room;
+            }
+            if (available > limit - ingested) {
+                available = limit - ingested;
+            }
+        }
+    }
+    return ingested;
+}
+
+// How many bytes LD2410_OVERFLOW_DROP_FRAME drops from the tail to free at
+// least `needed`: frames with a plausible header and length go whole, junk a
+// byte at a time, and it stops at the first header after `needed`, or at the
+// start of one still arriving. The parser then picks up at a frame boundary
+// instead of in the middle of a half-overwritten frame.
+uint16_t ld2410_base::whole_frames_to_drop_(uint32_t needed) const {
+    const uint16_t used = ring_.used();
+    uint16_t drop = 0;
+    while (drop < used) {
+        const uint16_t left = used - drop;
+        uint16_t magic = 0;	// header bytes matched at drop
+        const uint8_t first = ring_.peek(drop);
+        if (first == 0xF4 || first == 0xFD) {
+            const uint8_t* header = (first == 0xF4) ? LD2410_DATA_HDR : LD2410_CMD_HDR;
+            magic = 1;
+            while (magic < 4 && magic < left && ring_.peek(drop + magic) == header[magic]) {
+                magic++;
+            }
+        }
+        const bool at_frame = (magic == 4 || (magic > 0 && magic == left));
+        if (at_frame && drop >= needed) {
+            break;
+        }
+        uint16_t step = 1;
+        if (magic == 4 && left >= 6) {
+            const uint16_t intra = (uint16_t)ring_.peek(drop + 4) | ((uint16_t)ring_.peek(drop + 5) << 8);
+            if (intra != 0 && intra + 10 <= max_frame_length_) {
+                step = (intra + 10 < left) ? intra + 10 : left;
+            }
+        } else if (at_frame) {
+            step = left;	// a frame only just starting goes too
+        }
+        drop += step;
+    }
+    return drop;
+}
+
+void ld2410_base::capture_chunk_(const uint8_t *data, uint16_t length) {
+    if (capture_ != nullptr) {
+        const uint32_t now = micros();
+        ld2410_capture_chunk(*capture_, now - capture_last_us_, data, length);
+        capture_last_us_ = now;
+    }
+}
+
+void ld2410_base::note_high_water_(uint32_t waiting) {
+    const uint8_t epoch = high_water_epoch_.load(ld2410_acquire);
+    if (epoch != high_water_seen_.load(ld2410_relaxed)) {
+        high_water_.store(waiting, ld2410_relaxed);
+        high_water_seen_.store(epoch, ld2410_release);
+    } else if (waiting > high_water_.load(ld2410_relaxed)) {
+        high_water_.store(waiting, ld2410_relaxed);
     }
 }
 
-bool ld2410::begin(Stream &radarStream, bool waitForRadar) {
+bool ld2410_base::begin(Stream &radarStream, bool waitForRadar) {
+    return begin(radarStream, waitForRadar ? LD2410_STARTUP_FIRMWARE : LD2410_STARTUP_NO_WAIT);
+}
+
+// LD2410_STARTUP_FIRMWARE proves the radar is there by querying its firmware
+// version, which takes a configuration mode window of three commands and
+// their gaps and stops the radar reporting while it lasts. The radar sends a
+// data frame about every 100ms of its own accord, so LD2410_STARTUP_PASSIVE
+// instead just waits for one to parse: the sensor has a reading as soon as
+// begin() returns, and the firmware version is queued to be fetched by
+// read() or the autoReadTask afterwards. That query is still one
+// configuration mode window, only later; its callback frees the queue slot
+// once it has finished. A radar that stays silent may have been left in
+// configuration mode, which the firmware query also ends, so passive startup
+// falls back to it for a last try.
+bool ld2410_base::begin(Stream &radarStream, ld2410_startup startup, uint32_t timeoutMs) {
     radar_uart_ = &radarStream;
     
     if (debug_uart_ != nullptr) {
         debug_uart_->println(F("ld2410 started"));
     }
     
-    if (!waitForRadar) {
+    if (startup == LD2410_STARTUP_NO_WAIT) {
         return true;
     }
     
+    if (startup == LD2410_STARTUP_PASSIVE) {
+        if (listen_for_frame_(timeoutMs, 0)) {
+            if (debug_uart_ != nullptr) {
+                debug_uart_->print(F("\nLD2410 data frame received"));
+            }
+            queueCommand(ld2410_command::requestFirmwareVersion(), firmware_queried_);
+            return true;
+        }
+        timeoutMs = 0;			// one firmware query and no more
+    }
+    
     // Prova a leggere la versione firmware
     if (debug_uart_ != nullptr) {
         debug_uart_->print(F("\nLD2410 firmware: "));
@@ -69,13 +314,13 @@ bool ld2410::begin(Stream &radarStream, bool waitForRadar) {
     uint32_t start_time = millis();
     bool firmware_received = false;
     
-    while (millis() - start_time < 1000) { // timeout di 1 secondo
+    do {
         if (requestFirmwareVersion()) {
             firmware_received = true;
             break;
         }
         yield();
-    }
+    } while (millis() - start_time < timeoutMs);
     
     if (firmware_received) {
         if (debug_uart_ != nullptr) {
@@ -95,7 +340,27 @@ bool ld2410::begin(Stream &radarStream, bool waitForRadar) {
     return false;
 }
 
-void ld2410::debug(Stream &terminalStream)
+// Completion of passive startup's background firmware query. The ACK decoder
+// has already stored the version; a callback job frees its slot when it
+// finishes, where one without would hold it until commandStatus() was asked.
+void ld2410_base::firmware_queried_(ld2410_base &sensor, ld2410_command_handle, ld2410_command_status status, void *) {
+    if (sensor.debug_uart_ == nullptr) {
+        return;
+    }
+    sensor.debug_uart_->print(F("\nLD2410 firmware: "));
+    if (status != LD2410_COMMAND_SUCCEEDED) {
+        sensor.debug_uart_->print(F("no response"));
+        return;
+    }
+    sensor.debug_uart_->print(F(" v"));
+    sensor.debug_uart_->print(sensor.firmware_major_version);
+    sensor.debug_uart_->print('.');
+    sensor.debug_uart_->print(sensor.firmware_minor_version);
+    sensor.debug_uart_->print('.');
+    sensor.debug_uart_->print(sensor.firmware_bugfix_version);
+}
+
+void ld2410_base::debug(Stream &terminalStream)
 {
 	debug_uart_ = &terminalStream;		//Set the stream used for the terminal
 	#if defined(ESP8266)
@@ -106,7 +371,7 @@ void ld2410::debug(Stream &terminalStream)
 	#endif
 }
 
-bool ld2410::isConnected()
+bool ld2410_base::isConnected()
 {
 	if(millis() - radar_uart_last_packet_ < radar_uart_timeout)	//Use the last reading
 	{
@@ -119,50 +384,83 @@ bool ld2410::isConnected()
 	return false;
 }
 
-bool ld2410::read() {
-    bool new_data = false;
+bool ld2410_base::read() {
     // Leggi tutti i dati disponibili dal buffer UART
-    while (radar_uart_->available()) {
-        add_to_buffer(radar_uart_->read());
-        new_data = true;
-    }
+    bool new_data = ingest_uart_() > 0;
 
     // Prova a leggere e processare un frame
     bool frame_processed = read_frame_();
+
+    // Advance any queued command now that its ACK may have been parsed
+    service_commands_();
+    check_connection_();
     
     // Restituisce true se sono stati letti nuovi dati o se un frame è stato processato
     return new_data || frame_processed;
 }
 
 
+// One pass of a background read loop: block until the wake source reports
+// UART data or `timeoutMs` passes, then ingest everything the UART holds and
+// parse every complete frame in the ring. Without a wake source it sleeps
+// LD2410_POLL_INTERVAL_MS (or the timeout, if shorter) instead, which is the
+// classic polling loop. Either way every pass blocks at least once, so a
+// busy line cannot starve lower-priority tasks. While a command is in flight
+// the wait is capped at LD2410_POLL_INTERVAL_MS so the engine's 50 ms gaps
+// and ACK timeouts are not stretched by a quiet line. Returns true if at
+// least one frame was parsed.
+bool ld2410_base::waitAndRead(uint32_t timeoutMs) {
+    if (command_state_ != LD2410_ENGINE_IDLE && timeoutMs > LD2410_POLL_INTERVAL_MS) {
+        timeoutMs = LD2410_POLL_INTERVAL_MS;
+    }
+    if (wake_source_ != nullptr) {
+        wake_source_->wait(timeoutMs);
+    } else {
+        delay(timeoutMs < LD2410_POLL_INTERVAL_MS ? timeoutMs : LD2410_POLL_INTERVAL_MS);
+    }
+    ingest_uart_();
+    bool parsed = false;
+    while (read_frame_()) {
+        parsed = true;
+    }
+    service_commands_();
+    check_connection_();
+    return parsed;
+}
+
+void ld2410_base::setWakeSource(ld2410_wake_source &source) {
+    wake_source_ = &source;
+}
+
+void ld2410_base::notifyDataAvailable() {
+    if (wake_source_ != nullptr) {
+        wake_source_->notify();
+    }
+}
+
 #if defined(ESP32)
-void ld2410::taskFunction(void* param) {
-    ld2410* sensor = static_cast<ld2410*>(param);
+// With a wake source set the task sleeps until the UART reports data, so a
+// frame is parsed as soon as it lands rather than up to 10 ms later, and an
+// idle line costs no wakeups beyond one per LD2410_TASK_WAKE_TIMEOUT_MS.
+void ld2410_base::taskFunction(void* param) {
+    ld2410_base* sensor = static_cast<ld2410_base*>(param);
     for (;;) {
-        // Legge i dati dalla UART e li aggiunge al buffer circolare
-        bool new_data = false;
-        while (sensor->radar_uart_->available()) {
-            sensor->add_to_buffer(sensor->radar_uart_->read());
-            new_data = true;
-        }
-
-        // Se ci sono nuovi dati, tenta di processare un frame
-        if (new_data) {
-            bool frame_processed = sensor->read_frame_();
-        }
-        
-        // Delay per evitare il sovraccarico del task
-        vTaskDelay(pdMS_TO_TICKS(10));
+        sensor->waitAndRead(LD2410_TASK_WAKE_TIMEOUT_MS);
     }
 }
 
 // Avvia il task FreeRTOS che legge in continuo dalla UART del radar.
 // Ritorna true se il task è stato creato con successo. Se un task era già
 // attivo viene ignorata la nuova richiesta e si ritorna true.
-bool ld2410::autoReadTask(uint32_t stack, UBaseType_t priority, BaseType_t core) {
+// A sensor serviced by an ld2410_scheduler is read by the scheduler's task
+// instead, so it cannot have its own.
+bool ld2410_base::autoReadTask(uint32_t stack, UBaseType_t priority, BaseType_t core) {
     if (taskHandle_ != nullptr) {
         return true;
     }
+    if (scheduler_ != nullptr) {
+        return false;
+    }
     BaseType_t result = xTaskCreatePinnedToCore(
         taskFunction,
         "LD2410Task",
@@ -180,7 +478,7 @@ bool ld2410::autoReadTask(uint32_t stack, UBaseType_t priority, BaseType_t core)
 }
 
 // Ferma il task se in esecuzione.
-void ld2410::stopAutoReadTask() {
+void ld2410_base::stopAutoReadTask() {
     if (taskHandle_ != nullptr) {
         vTaskDelete(taskHandle_);
         taskHandle_ = nullptr;
@@ -188,121 +486,370 @@ void ld2410::stopAutoReadTask() {
 }
 #endif
 
-// Reports whether autoReadTask() is currently running. Always false on
+// Reports whether autoReadTask() is currently running. On Linux the
+// equivalent is an ld2410_reactor inside run(). Always false on other
 // platforms without the FreeRTOS task path, so consumer code can branch on
 // runtime mode without compile-time #ifs.
-bool ld2410::isAutoReadTaskRunning() {
+bool ld2410_base::isAutoReadTaskRunning() {
 #if defined(ESP32)
-    return taskHandle_ != nullptr;
+    return taskHandle_ != nullptr || (scheduler_ != nullptr && scheduler_->isAutoReadTaskRunning());
+#elif defined(__linux__) && !defined(ARDUINO)
+    return reactor_ != nullptr && reactor_->isRunning();
 #else
     return false;
 #endif
 }
 
 
-bool ld2410::presenceDetected()
+bool ld2410_base::presenceDetected()
 {
-	return target_type_ != 0;
+	return snapshot_.target_type != 0;
 }
 
-bool ld2410::stationaryTargetDetected()
+bool ld2410_base::stationaryTargetDetected()
 {
-	if((target_type_ & 0x02) && stationary_target_distance_ > 0 && stationary_target_energy_ > 0)
+	if((snapshot_.target_type & 0x02) && snapshot_.stationary_target_distance > 0 && snapshot_.stationary_target_energy > 0)
 	{
 		return true;
 	}
 	return false;
 }
 
-uint16_t ld2410::stationaryTargetDistance()
+uint16_t ld2410_base::stationaryTargetDistance()
 {
-	//if(stationary_target_energy_ > 0)
+	//if(snapshot_.stationary_target_energy > 0)
 	{
-		return stationary_target_distance_;
+		return snapshot_.stationary_target_distance;
 	}
 	//return 0;
 }
 
-uint8_t ld2410::stationaryTargetEnergy()
+uint8_t ld2410_base::stationaryTargetEnergy()
 {
-	//if(stationary_target_distance_ > 0)
+	//if(snapshot_.stationary_target_distance > 0)
 	{
-		return stationary_target_energy_;
+		return snapshot_.stationary_target_energy;
 	}
 	//return 0;
 }
 
-bool ld2410::movingTargetDetected()
+bool ld2410_base::movingTargetDetected()
 {
-	if((target_type_ & 0x01) && moving_target_distance_ > 0 && moving_target_energy_ > 0)
+	if((snapshot_.target_type & 0x01) && snapshot_.moving_target_distance > 0 && snapshot_.moving_target_energy > 0)
 	{
 		return true;
 	}
 	return false;
 }
 
-uint16_t ld2410::movingTargetDistance()
+uint16_t ld2410_base::movingTargetDistance()
 {
-	//if(moving_target_energy_ > 0)
+	//if(snapshot_.moving_target_energy > 0)
 	{
-		return moving_target_distance_;
+		return snapshot_.moving_target_distance;
 	}
 	//return 0;
 }
 
-uint8_t ld2410::movingTargetEnergy() {
-    if (moving_target_energy_ > 100) {
+uint8_t ld2410_base::movingTargetEnergy() {
+    if (snapshot_.moving_target_energy > 100) {
         return 100;  // Limita a 100 se il valore è superiore
     }
-    return moving_target_energy_;  // Restituisci il valore se è già compreso tra 0 e 100
+    return snapshot_.moving_target_energy;  // Restituisci il valore se è già compreso tra 0 e 100
 }
 
-uint16_t ld2410::detectionDistance() {
-    return detection_distance_;
+uint16_t ld2410_base::detectionDistance() {
+    return snapshot_.detection_distance;
 }
 
-uint8_t ld2410::movingEnergyAtGate(uint8_t gate) {
+uint8_t ld2410_base::movingEnergyAtGate(uint8_t gate) {
     if (gate >= 9) {
         return 0;
     }
-    return engineering_motion_energy_[gate];
+    return snapshot_.moving_gate_energy[gate];
 }
 
-uint8_t ld2410::stationaryEnergyAtGate(uint8_t gate) {
+uint8_t ld2410_base::stationaryEnergyAtGate(uint8_t gate) {
     if (gate >= 9) {
         return 0;
     }
-    return engineering_stationary_energy_[gate];
+    return snapshot_.stationary_gate_energy[gate];
 }
 
-bool ld2410::engineeringRetrieved() {
+bool ld2410_base::engineeringRetrieved() {
     return engineering_data_received_;
 }
 
+ld2410_engineering_mode ld2410_base::engineeringMode() {
+    return (ld2410_engineering_mode)engineering_mode_.load(ld2410_acquire);
+}
+
+// Seqlock read side: a copy that may mix two frames is taken again. A frame
+// is written in well under a microsecond, so retries are rare and short.
+RadarSnapshot ld2410_base::getSnapshot() {
+    RadarSnapshot copy;
+    uint32_t seq;
+    do {
+        seq = snapshot_seq_.read_begin();
+        copy = snapshot_;
+    } while (snapshot_seq_.read_retry(seq));
+    return copy;
+}
+
+// Set the history and the callbacks up before autoReadTask() is started: the
+// parser reads them without synchronisation.
+void ld2410_base::setHistory(ld2410_history &history) {
+    history.clear_();
+    history_ = &history;
+}
+
+void ld2410_base::setGateWindow(ld2410_gate_window &window) {
+    window.clear_();
+    gate_window_ = &window;
+}
+
+void ld2410_base::setBackground(ld2410_background &background) {
+    background.clear_();
+    background_ = &background;
+}
+
+// Each counter is read once; with the parser running elsewhere the result is
+// not one instant across all of them, but no counter is ever torn.
+RadarStats ld2410_base::getStats() {
+    uint32_t now[STAT_COUNT];
+    for (uint8_t i = 0; i < STAT_COUNT; i++) {
+        now[i] = stats_[i].load(ld2410_relaxed) - stats_base_[i];
+    }
+    RadarStats stats;
+    stats.data_frames = now[STAT_DATA_FRAMES];
+    stats.engineering_frames = now[STAT_ENGINEERING_FRAMES];
+    stats.ack_frames = now[STAT_ACK_FRAMES];
+    stats.unknown_acks = now[STAT_UNKNOWN_ACKS];
+    stats.invalid_frames = now[STAT_INVALID_FRAMES];
+    stats.header_resyncs = now[STAT_HEADER_RESYNCS];
+    stats.bad_lengths = now[STAT_BAD_LENGTHS];
+    stats.footer_mismatches = now[STAT_FOOTER_MISMATCHES];
+    stats.bytes_discarded = now[STAT_BYTES_DISCARDED];
+    stats.buffer_overruns = now[STAT_BUFFER_OVERRUNS];
+    stats.bytes_dropped = now[STAT_BYTES_DROPPED];
+    if (high_water_seen_.load(ld2410_acquire) == high_water_epoch_.load(ld2410_relaxed)) {
+        stats.buffer_high_water = high_water_.load(ld2410_relaxed);
+    }
+    return stats;
+}
+
+// The counters themselves are never written from here, only a baseline, so
+// a reset from loop() cannot race the autoReadTask's increments. The
+// high-water mark is not a count, so instead ingestion restarts it when it
+// sees the epoch move on, and until then getStats() reports 0.
+void ld2410_base::resetStats() {
+    for (uint8_t i = 0; i < STAT_COUNT; i++) {
+        stats_base_[i] = stats_[i].load(ld2410_relaxed);
+    }
+    high_water_epoch_.store((uint8_t)(high_water_epoch_.load(ld2410_relaxed) + 1), ld2410_release);
+}
+
+// Like the callbacks, set before autoReadTask() is started.
+void ld2410_base::setOverflowPolicy(ld2410_overflow_policy policy) {
+    overflow_policy_ = policy;
+}
+
+// Writes the capture header straight away, with the firmware version as far
+// as it is known, so begin() (which asks for it) should come first.
+void ld2410_base::startCapture(Print &sink) {
+    ld2410_capture_header(sink, firmware_major_version, firmware_minor_version, firmware_bugfix_version);
+    capture_last_us_ = micros();
+    capture_ = &sink;
+}
+
+void ld2410_base::stopCapture() {
+    capture_ = nullptr;
+}
+
+void ld2410_base::onDataFrame(ld2410_frame_callback callback, void *context) {
+    data_frame_callback_ = callback;
+    data_frame_context_ = context;
+}
+
+void ld2410_base::onEngineeringFrame(ld2410_frame_callback callback, void *context) {
+    engineering_frame_callback_ = callback;
+    engineering_frame_context_ = context;
+}
+
+void ld2410_base::onAck(ld2410_ack_callback callback, void *context) {
+    ack_callback_ = callback;
+    ack_context_ = context;
+}
+
+void ld2410_base::onConnectionLost(ld2410_event_callback callback, void *context) {
+    connection_lost_callback_ = callback;
+    connection_lost_context_ = context;
+}
 
-bool ld2410::check_frame_end_() {
+// Called by read_frame_() once a frame has been framed and parsed, after it
+// has left the ring. Every well-formed ACK is reported, a NAK included;
+// data frames only once they decoded. snapshot_ is only written by this
+// context, so the callbacks can be handed a reference to it.
+void ld2410_base::frame_parsed_(bool ok) {
+    if (ok) {
+        connection_up_ = true;
+    }
     if (ack_frame_) {
-        return (radar_data_frame_[0] == 0xFD &&
-                radar_data_frame_[1] == 0xFC &&
-                radar_data_frame_[2] == 0xFB &&
-                radar_data_frame_[3] == 0xFA &&
-                radar_data_frame_[radar_data_frame_position_ - 4] == 0x04 &&
-                radar_data_frame_[radar_data_frame_position_ - 3] == 0x03 &&
-                radar_data_frame_[radar_data_frame_position_ - 2] == 0x02 &&
-                radar_data_frame_[radar_data_frame_position_ - 1] == 0x01);
+        if (ack_callback_ != nullptr) {
+            ack_callback_(*this, latest_ack_, ok, ack_context_);
+        }
+        return;
+    }
+    if (!ok) {
+        return;
+    }
+    if (data_frame_callback_ != nullptr) {
+        data_frame_callback_(*this, snapshot_, data_frame_context_);
+    }
+    if (snapshot_.engineering && engineering_frame_callback_ != nullptr) {
+        engineering_frame_callback_(*this, snapshot_, engineering_frame_context_);
+    }
+    if (snapshot_.changed != 0 && change_callback_ != nullptr) {
+        change_callback_(*this, snapshot_, change_context_);
+    }
+}
+
+// Change detection is off until either of these is called, so sketches that
+// do not use it do not pay for the comparisons on every frame.
+void ld2410_base::setChangeThresholds(uint16_t distance, uint8_t energy, uint8_t stateFrames) {
+    change_distance_ = distance;
+    change_energy_ = energy;
+    change_state_frames_ = stateFrames > 0 ? stateFrames : 1;
+    change_detection_ = true;
+}
+
+void ld2410_base::onChange(ld2410_frame_callback callback, void *context) {
+    change_callback_ = callback;
+    change_context_ = context;
+    if (callback != nullptr) {
+        change_detection_ = true;
+    }
+}
+
+uint16_t ld2410_base::takeChanges() {
+    return changes_.exchange(0, ld2410_acquire);
+}
+
+template <typename T>
+static inline uint16_t ld2410_difference(T a, T b) {
+    return (uint16_t)(a > b ? a - b : b - a);
+}
+
+// If value has moved more than deadband away from reported, make it the new
+// reported value.
+template <typename T>
+static bool ld2410_track(T value, T &reported, uint16_t deadband) {
+    if (ld2410_difference(value, reported) <= deadband) {
+        return false;
+    }
+    reported = value;
+    return true;
+}
+
+// Whether any of the nine gate energies has moved more than deadband.
+static bool ld2410_gates_moved(const uint8_t *value, const uint8_t *reported, uint8_t deadband) {
+    uint8_t moved = 0;
+    for (uint8_t gate = 0; gate < 9; gate++) {
+        moved |= (uint8_t)(ld2410_difference(value[gate], reported[gate]) > deadband);
+    }
+    return moved != 0;
+}
+
+// Change detection for parse_data_frame_(). Distances and energies are
+// compared with the value they had when their change was last reported, not
+// with the previous frame: a reading that jitters around one level is never
+// reported, one that drifts is reported each time it has moved a deadband.
+// A new target state is only reported once it has been seen in
+// change_state_frames_ frames in a row, so a single-frame dropout does not
+// toggle presence.
+uint16_t ld2410_base::detect_changes_() {
+    if (reported_.sequence == 0) {
+        reported_ = snapshot_;		// first frame: everything is news
+        pending_state_frames_ = 0;
+        return LD2410_CHANGED_ALL;
+    }
+    uint16_t changed = 0;
+    const uint8_t state = snapshot_.target_type & 0x03;
+    const uint8_t reported_state = reported_.target_type & 0x03;
+    if (state == reported_state) {
+        pending_state_frames_ = 0;
     } else {
-        return (radar_data_frame_[0] == 0xF4 &&
-                radar_data_frame_[1] == 0xF3 &&
-                radar_data_frame_[2] == 0xF2 &&
-                radar_data_frame_[3] == 0xF1 &&
-                radar_data_frame_[radar_data_frame_position_ - 4] == 0xF8 &&
-                radar_data_frame_[radar_data_frame_position_ - 3] == 0xF7 &&
-                radar_data_frame_[radar_data_frame_position_ - 2] == 0xF6 &&
-                radar_data_frame_[radar_data_frame_position_ - 1] == 0xF5);
+        if (state != pending_state_) {
+            pending_state_ = state;
+            pending_state_frames_ = 0;
+        }
+        if (++pending_state_frames_ >= change_state_frames_) {
+            if ((state == 0) != (reported_state == 0)) {
+                changed |= LD2410_CHANGED_PRESENCE;
+            }
+            if ((state ^ reported_state) & 0x01) {
+                changed |= LD2410_CHANGED_MOVING_TARGET;
+            }
+            if ((state ^ reported_state) & 0x02) {
+                changed |= LD2410_CHANGED_STATIONARY_TARGET;
+            }
+            reported_.target_type = snapshot_.target_type;
+            pending_state_frames_ = 0;
+        }
+    }
+    if (ld2410_track(snapshot_.moving_target_distance, reported_.moving_target_distance, change_distance_)) {
+        changed |= LD2410_CHANGED_MOVING_DISTANCE;
+    }
+    if (ld2410_track(snapshot_.moving_target_energy, reported_.moving_target_energy, change_energy_)) {
+        changed |= LD2410_CHANGED_MOVING_ENERGY;
+    }
+    if (ld2410_track(snapshot_.stationary_target_distance, reported_.stationary_target_distance, change_distance_)) {
+        changed |= LD2410_CHANGED_STATIONARY_DISTANCE;
+    }
+    if (ld2410_track(snapshot_.stationary_target_energy, reported_.stationary_target_energy, change_energy_)) {
+        changed |= LD2410_CHANGED_STATIONARY_ENERGY;
+    }
+    if (ld2410_track(snapshot_.detection_distance, reported_.detection_distance, change_distance_)) {
+        changed |= LD2410_CHANGED_DETECTION_DISTANCE;
     }
+    if (snapshot_.engineering != reported_.engineering) {
+        reported_.engineering = snapshot_.engineering;
+        changed |= LD2410_CHANGED_ENGINEERING;
+    }
+    if (snapshot_.engineering &&
+        (ld2410_gates_moved(snapshot_.moving_gate_energy, reported_.moving_gate_energy, change_energy_) ||
+         ld2410_gates_moved(snapshot_.stationary_gate_energy, reported_.stationary_gate_energy, change_energy_))) {
+        memcpy(reported_.moving_gate_energy, snapshot_.moving_gate_energy, sizeof(reported_.moving_gate_energy));
+        memcpy(reported_.stationary_gate_energy, snapshot_.stationary_gate_energy, sizeof(reported_.stationary_gate_energy));
+        changed |= LD2410_CHANGED_GATE_ENERGY;
+    }
+    return changed;
+}
+
+// The radar is silent while it reboots after a restart command, which is
+// not a lost connection.
+void ld2410_base::check_connection_() {
+    if (connection_up_ && command_state_ != LD2410_ENGINE_REBOOTING && millis() - radar_uart_last_packet_ >= LD2410_CONNECTION_LOST_MS) {
+        connection_up_ = false;
+        if (connection_lost_callback_ != nullptr) {
+            connection_lost_callback_(*this, connection_lost_context_);
+        }
+    }
+}
+
+
+bool ld2410_base::check_frame_end_() {
+    // The header was matched before the frame was framed, so only the footer
+    // at the position given by the length field is left to check.
+    const uint8_t* footer = ack_frame_ ? LD2410_CMD_FTR : LD2410_DATA_FTR;
+    const uint16_t end = frame_.length;
+    return (frame_[end - 4] == footer[0] &&
+            frame_[end - 3] == footer[1] &&
+            frame_[end - 2] == footer[2] &&
+            frame_[end - 1] == footer[3]);
 }
 
-void ld2410::print_frame_()
+void ld2410_base::print_frame_()
 {
 	if(debug_uart_ != nullptr)
 	{
@@ -314,19 +861,19 @@ void ld2410::print_frame_()
 		{
 			debug_uart_->print(F("\nData : "));
 		}
-		for(uint8_t i = 0; i < radar_data_frame_position_ ; i ++)
+		for(uint16_t i = 0; i < frame_.length ; i ++)
 		{
-			if(radar_data_frame_[i] < 0x10)
+			if(frame_[i] < 0x10)
 			{
 				debug_uart_->print('0');
 			}
-			debug_uart_->print(radar_data_frame_[i],HEX);
+			debug_uart_->print(frame_[i],HEX);
 			debug_uart_->print(' ');
 		}
 	}
 }
 
-// Length-driven frame parser.
+// Length-driven, zero-copy frame parser.
 //
 // Layout (HLK-LD2410C protocol V1.00 §2.3):
 //   [0..3]  4-byte magic header  (F4 F3 F2 F1 for data, FD FC FB FA for cmd)
@@ -335,97 +882,106 @@ void ld2410::print_frame_()
 //   [N+1..N+4] 4-byte footer    (F8 F7 F6 F5 for data, 04 03 02 01 for cmd)
 // Total frame length = intra_len + 10.
 //
-// The previous parser (a) committed to a frame after a single 0xF4/0xFD byte
-// and (b) tested the footer pattern after every byte from position 8 onwards.
-// Both broke alignment under any kind of byte loss or when intra-frame data
-// happened to contain bytes resembling the footer (e.g. a stationary distance
-// of 244 cm has 0xF4 as its low byte). This version validates all four header
-// bytes before committing, captures the length once, accumulates exactly that
-// many bytes, then validates the footer and parses. On any mid-frame
-// inconsistency it resyncs, and if the offending byte is itself a candidate
-// header start it is reused as the new position 0 so we don't lose a header.
-bool ld2410::read_frame_() {
-    uint8_t byte_read;
-    while (read_from_buffer(byte_read)) {
-        const uint8_t pos = radar_data_frame_position_;
-
-        // Stage A: locate the magic header (positions 0..3).
-        if (pos == 0) {
-            if (byte_read == 0xF4) {
-                radar_data_frame_[0] = byte_read;
-                radar_data_frame_position_ = 1;
-                ack_frame_ = false;
-            } else if (byte_read == 0xFD) {
-                radar_data_frame_[0] = byte_read;
-                radar_data_frame_position_ = 1;
-                ack_frame_ = true;
-            }
-            // else: drop byte, keep scanning
+// Frames are validated and decoded where they sit in the ring: the
+// parser peeks at the tail of ring_, waits until the whole frame (as given by its
+// length field) has arrived, then hands parse_data_frame_() /
+// parse_command_frame_() a FrameView over one or two spans of the ring.
+// Nothing is copied unless keepFrameData() is on; getFrameData() otherwise
+// makes a copy only when it is called.
+//
+// All four header bytes are validated before committing, the length is read
+// once, and the footer is only checked at the position the length dictates,
+// so payload bytes that resemble a header or footer (a stationary distance of
+// 244 cm has 0xF4 as its low byte) cannot break alignment. When a candidate
+// header turns out to be bogus -- a mismatching header byte, an impossible
+// length or a missing footer -- only its first byte is discarded, so a real
+// header that starts inside the rejected bytes is still found; the scan then
+// jumps straight to the next 0xF4/0xFD candidate.
+bool ld2410_base::read_frame_() {
+    for (;;) {
+        const uint16_t used = ring_.used();
+        if (used == 0) {
+            return false;
+        }
+        const uint16_t tail = ring_.tail_index();
+        const uint8_t* storage = ring_.storage();
+
+        // Stage A: locate the magic header (positions 0..3). Junk is skipped
+        // a contiguous region at a time, up to the next 0xF4/0xFD or to the
+        // end of the array, whichever comes first.
+        const uint8_t first = storage[tail];
+        if (first != 0xF4 && first != 0xFD) {
+            uint16_t span;
+            const uint8_t* junk = ring_.read_span(span);
+            const uint16_t skipped = ld2410_find_header_start(junk, span);
+            ring_.consume(skipped);
+            count_(STAT_HEADER_RESYNCS);
+            count_(STAT_BYTES_DISCARDED, skipped);
             continue;
         }
-
-        if (pos < 4) {
-            const uint8_t expected = (ack_frame_ ? LD2410_CMD_HDR : LD2410_DATA_HDR)[pos];
-            if (byte_read == expected) {
-                radar_data_frame_[pos] = byte_read;
-                radar_data_frame_position_ = pos + 1;
-            } else if (byte_read == 0xF4) {
-                radar_data_frame_[0] = byte_read;
-                radar_data_frame_position_ = 1;
-                ack_frame_ = false;
-            } else if (byte_read == 0xFD) {
-                radar_data_frame_[0] = byte_read;
-                radar_data_frame_position_ = 1;
-                ack_frame_ = true;
-            } else {
-                radar_data_frame_position_ = 0;
-            }
+        if (used < 4) {
+            return false;
+        }
+        const uint8_t* header = (first == 0xF4) ? LD2410_DATA_HDR : LD2410_CMD_HDR;
+        if (ring_.peek(1) != header[1] ||
+            ring_.peek(2) != header[2] ||
+            ring_.peek(3) != header[3]) {
+            ring_.consume(1);
+            count_(STAT_HEADER_RESYNCS);
+            count_(STAT_BYTES_DISCARDED);
             continue;
         }
 
-        // Stage B: capture the length field, then the body.
-        radar_data_frame_[pos] = byte_read;
-        radar_data_frame_position_ = pos + 1;
-
-        if (pos == 5) {
-            const uint16_t intra = (uint16_t)radar_data_frame_[4]
-                                 | ((uint16_t)radar_data_frame_[5] << 8);
-            if (intra == 0 || intra + 10 > LD2410_MAX_FRAME_LENGTH) {
-                radar_data_frame_position_ = 0;
-            }
+        // Stage B: the length field, then wait for the whole frame.
+        if (used < 6) {
+            return false;
+        }
+        const uint16_t intra = (uint16_t)ring_.peek(4) | ((uint16_t)ring_.peek(5) << 8);
+        if (intra == 0 || intra + 10 > max_frame_length_) {
+            ring_.consume(1);
+            count_(STAT_BAD_LENGTHS);
+            count_(STAT_BYTES_DISCARDED);
             continue;
         }
-
-        if (pos < 6) continue;
-
-        const uint16_t intra = (uint16_t)radar_data_frame_[4]
-                             | ((uint16_t)radar_data_frame_[5] << 8);
         const uint16_t total = intra + 10;
-        if (radar_data_frame_position_ < total) continue;
-
-        // Frame fully received. Validate footer once at the known position.
-        const bool footer_ok = check_frame_end_();
-        const bool was_ack   = ack_frame_;
-        bool ok = false;
-        if (footer_ok) {
-            ok = was_ack ? parse_command_frame_() : parse_data_frame_();
+        if (used < total) {
+            return false;
+        }
+
+        // Frame fully received: describe it in place, one span or two.
+        const uint16_t to_end = ring_.size() - tail;
+        frame_.first = &storage[tail];
+        frame_.first_length = (total < to_end) ? total : to_end;
+        frame_.second = storage;
+        frame_.length = total;
+        ack_frame_ = (first == 0xFD);
+
+        if (!check_frame_end_()) {
+            ring_.consume(1);
+            count_(STAT_FOOTER_MISMATCHES);
+            count_(STAT_BYTES_DISCARDED);
+            continue;
         }
-        radar_data_frame_position_ = 0;
+        const bool ok = ack_frame_ ? parse_command_frame_() : parse_data_frame_();
+        count_(ack_frame_ ? STAT_ACK_FRAMES : !ok ? STAT_INVALID_FRAMES : snapshot_.engineering ? STAT_ENGINEERING_FRAMES : STAT_DATA_FRAMES);
+        ring_.consume(total);
+        frame_parsed_(ok);
         if (ok) return true;
     }
-    return false;
 }
 
-bool ld2410::parse_data_frame_() {
-    uint16_t intra_frame_data_length = radar_data_frame_[4] | (radar_data_frame_[5] << 8);
+bool ld2410_base::parse_data_frame_() {
+    uint16_t intra_frame_data_length = frame_.le16(4);
 
-    // Frame totale = header(4) + length(2) + intra-frame + footer(4) = intra+10
-    if (radar_data_frame_position_ != intra_frame_data_length + 10) {
+    // Frame totale = header(4) + length(2) + intra-frame + footer(4) = intra+10.
+    // Table 12 needs 13 bytes of intra-frame data; anything shorter would read
+    // past the footer.
+    if (frame_.length != intra_frame_data_length + 10 || intra_frame_data_length < 13) {
         return false;
     }
 
     // Per Tabella 11, il primo byte intra-frame indica il tipo: 0x02 basic, 0x01 engineering.
-    uint8_t data_type = radar_data_frame_[6];
+    uint8_t data_type = frame_[6];
     if (data_type != 0x01 && data_type != 0x02) {
         return false;
     }
@@ -435,31 +991,27 @@ bool ld2410::parse_data_frame_() {
     // ma in engineering la posizione varia. Calcoliamo gli offset dinamicamente.
     uint16_t tail_index = intra_frame_data_length + 4;        // 0x55
     uint16_t cal_index = intra_frame_data_length + 5;         // 0x00
-    if (radar_data_frame_[7] != 0xAA ||
-        radar_data_frame_[tail_index] != 0x55 ||
-        radar_data_frame_[cal_index] != 0x00) {
+    if (frame_[7] != 0xAA ||
+        frame_[tail_index] != 0x55 ||
+        frame_[cal_index] != 0x00) {
         return false;
     }
 
     // Tabella 12: dati basic (presenti sia in 0x01 che in 0x02)
-    // Sezione critica: su ESP32 dual-core il task pinnato a core 0 può aggiornare
-    // i campi mentre il loop utente li legge da core 1. Il critical section
-    // evita stati inconsistenti tra campi di uno stesso frame e funge da
-    // memory barrier per i lettori dei singoli getter.
-#if defined(ESP32)
-    portENTER_CRITICAL(&data_mux_);
-#endif
-    target_type_ = radar_data_frame_[8];
-    // ESP8266 (Xtensa LX106) faults on 16-bit loads from odd addresses, and
-    // offsets 9 and 15 are odd. memcpy compiles to a single unaligned load on
-    // targets that support it (ESP32 / ARM / x86) and to byte loads on those
-    // that don't, so one form works everywhere. LD2410 payloads are little-
-    // endian, matching every supported Arduino target.
-    memcpy(&moving_target_distance_,     &radar_data_frame_[9],  sizeof(uint16_t));
-    moving_target_energy_ = radar_data_frame_[11];
-    memcpy(&stationary_target_distance_, &radar_data_frame_[12], sizeof(uint16_t));
-    stationary_target_energy_ = radar_data_frame_[14];
-    memcpy(&detection_distance_,         &radar_data_frame_[15], sizeof(uint16_t));
+    // Seqlock write section: on dual-core ESP32 the task may be updating
+    // snapshot_ while the user's loop reads it from the other core.
+    snapshot_seq_.begin_write();
+    snapshot_.sequence++;
+    snapshot_.target_type = frame_[8];
+    // Fields are decoded straight out of the ring. le16() assembles each
+    // 16-bit value from its two bytes, which is endian-independent and never
+    // issues the unaligned 16-bit load that faults on ESP8266 (offsets 9 and
+    // 15 are odd), even when a field straddles the end of the buffer.
+    snapshot_.moving_target_distance = frame_.le16(9);
+    snapshot_.moving_target_energy = frame_[11];
+    snapshot_.stationary_target_distance = frame_.le16(12);
+    snapshot_.stationary_target_energy = frame_[14];
+    snapshot_.detection_distance = frame_.le16(15);
 
     // Tabella 14: extra engineering. Layout (full-frame index, 0-based):
     //   17 = max moving gate N (ridondante con max_moving_gate da requestCurrentConfiguration)
@@ -467,233 +1019,492 @@ bool ld2410::parse_data_frame_() {
     //   19..27 = energie motion gate 0..8
     //   28..36 = energie stationary gate 0..8
     //   poi M byte di retain + tail/cal (gestiti sopra)
-    if (data_type == 0x01 && intra_frame_data_length >= 33) {
+    snapshot_.engineering = (data_type == 0x01 && intra_frame_data_length >= 33);
+    if (snapshot_.engineering) {
         for (uint8_t gate = 0; gate < 9; gate++) {
-            engineering_motion_energy_[gate] = radar_data_frame_[19 + gate];
-            engineering_stationary_energy_[gate] = radar_data_frame_[28 + gate];
+            snapshot_.moving_gate_energy[gate] = frame_[19 + gate];
+            snapshot_.stationary_gate_energy[gate] = frame_[28 + gate];
         }
         engineering_data_received_ = true;
     }
-
-    last_valid_frame_length = radar_data_frame_position_;
+    engineering_mode_.store(snapshot_.engineering ? LD2410_ENGINEERING_ON : LD2410_ENGINEERING_OFF, ld2410_release);
+
+    // Remember where the frame lives so getFrameData() can copy it out later,
+    // or copy it now if the consumer asked for every frame to be kept.
+    last_valid_frame_length = frame_.length;
+    raw_frame_position_ = ring_.read_position();
+    if (keep_frame_data_.load(ld2410_relaxed)) {
+        frame_.copy_to(radar_data_frame_);
+        kept_frame_length_.store(frame_.length, ld2410_release);
+    }
     radar_uart_last_packet_ = millis();
-#if defined(ESP32)
-    portEXIT_CRITICAL(&data_mux_);
-#endif
+    if (change_detection_) {
+        snapshot_.changed = detect_changes_();
+        if ((changes_.load(ld2410_relaxed) & snapshot_.changed) != snapshot_.changed) {
+            changes_.fetch_or(snapshot_.changed, ld2410_release);	// skip the atomic RMW when takeChanges() would see the bits anyway
+        }
+    }
+    if (history_ != nullptr) {
+        history_->record_(snapshot_, radar_uart_last_packet_);
+    }
+    if (gate_window_ != nullptr && snapshot_.engineering) {
+        gate_window_->record_(snapshot_);
+    }
+    if (background_ != nullptr && snapshot_.engineering) {
+        background_->update_(snapshot_);
+    }
+    snapshot_seq_.end_write();
     return true;
 }
 
 
 // ---------------------------------------------------------------------------
-// Command synchronization helpers.
+// Asynchronous command engine.
+//
+// queueCommand() may be called from any thread. It claims a free slot in
+// command_jobs_ with a compare-and-swap, fills it in and publishes it as
+// QUEUED with a release store; nothing else is shared with the caller.
+//
+// Everything else runs in the context that parses frames: read(),
+// waitAndRead() (and so the autoReadTask) call service_commands_() after
+// parsing, and the blocking request*/set* wrappers do the same themselves
+// when no task is running. The engine therefore owns the UART, the ring and
+// the cmd_seq_/cmd_ack_seq_ pair without any locking, and it never blocks:
+// each call advances the state machine as far as the ACKs received and the
+// clock allow, then returns.
+//
+//   IDLE ──> ENTERING ──ack──> COMMAND_GAP ──50 ms──> COMMAND_SENT
+//               │ NAK/timeout                             │ ACK/NAK/timeout
+//               └──────────────> LEAVE_GAP <──────────────┘
+//                                    │ 50 ms
+//                                 LEAVING ──ACK/timeout──> (REBOOTING) ──> IDLE
 //
-// begin_command_() is called by every request*/set* function right before
-// writing the command bytes to the UART. It bumps cmd_seq_ and resets the
-// expected-ACK opcode under data_mux_, and -- when no autoReadTask is
-// running -- discards any stale frame state (circular buffer, in-progress
-// parser state, UART RX FIFO bytes) from a previous command that may have
-// timed out. When the task is running it must NOT touch UART or buffer
-// state because the task owns them; the seq bump alone is enough to
-// invalidate stale ACKs.
+// As before, leave-config is always attempted, even when the radar refused
+// to enter configuration mode, and the command's result is the ACK of the
+// command itself. REBOOTING is the 800 ms reception mute after a restart.
+// A transaction loops COMMAND_SENT back to COMMAND_GAP for each of its
+// commands, leaving early on the first one that does not succeed.
 //
-// wait_for_ack_() drives the wait loop. Two modes:
-//   - no task running: drains UART hardware into the circular buffer and
-//     calls read_frame_() ourselves until either a matching ACK is parsed
-//     or the timeout expires.
-//   - task running:    leaves UART alone; polls cmd_ack_seq_ while letting
-//     the task fill the buffer and parse frames in its own context.
-// In both modes the matching condition is identical:
-//   cmd_ack_seq_ == cmd_seq_ AND latest_ack_ == expected_op
-// returning latest_command_success_ on match, false on timeout.
+// begin_command_() bumps cmd_seq_, sets the expected-ACK opcode and discards
+// any stale frame state (circular buffer, UART RX FIFO bytes) from a
+// previous command that may have timed out. command_acked_() then matches
+//   cmd_ack_seq_ == cmd_seq_ AND latest_ack_ == expected_ack_opcode_
 // ---------------------------------------------------------------------------
-void ld2410::begin_command_(uint8_t expected_op)
+void ld2410_base::begin_command_(uint8_t expected_op)
 {
-	bool task_running = false;
-#if defined(ESP32)
-	task_running = (taskHandle_ != nullptr);
-	portENTER_CRITICAL(&data_mux_);
-#endif
 	expected_ack_opcode_ = expected_op;
 	cmd_seq_++;
-	if (!task_running) {
-		// Discard any half-parsed frame and drop the circular buffer contents
-		// so a stale ACK left over from a previous timeout cannot be matched
-		// by the new command.
-		buffer_tail = buffer_head;
-		radar_data_frame_position_ = 0;
-	}
-#if defined(ESP32)
-	portEXIT_CRITICAL(&data_mux_);
-#endif
-	if (!task_running) {
-		// Drain in-flight UART bytes from the previous command's timeout.
-		while (radar_uart_->available()) {
-			radar_uart_->read();
-		}
-	}
+	// Discard any half-received frame and drop the circular buffer contents
+	// so a stale ACK left over from a previous timeout cannot be matched by
+	// the new command, then drain in-flight UART bytes. The engine runs in
+	// the parsing context, so it is the ring's only consumer.
+	drain_uart_();
 }
 
-bool ld2410::wait_for_ack_(uint8_t expected_op, uint32_t timeout_ms)
+bool ld2410_base::command_acked_(bool &success)
 {
-	uint32_t start = millis();
-	bool task_running = false;
-#if defined(ESP32)
-	task_running = (taskHandle_ != nullptr);
-#endif
-	while (millis() - start < timeout_ms) {
-		if (!task_running) {
-			// Drive UART -> circular buffer -> parser ourselves
-			while (radar_uart_->available()) {
-				add_to_buffer(radar_uart_->read());
-			}
-			read_frame_();
-		}
-
-		bool got_ack = false;
-		bool ok = false;
-#if defined(ESP32)
-		portENTER_CRITICAL(&data_mux_);
-#endif
-		if (cmd_ack_seq_ == cmd_seq_ && latest_ack_ == expected_op) {
-			got_ack = true;
-			ok = latest_command_success_;
-		}
-#if defined(ESP32)
-		portEXIT_CRITICAL(&data_mux_);
-#endif
-		if (got_ack) {
-			return ok;
-		}
-
-#if defined(ESP32)
-		if (task_running) {
-			vTaskDelay(pdMS_TO_TICKS(1));
-		}
-#endif
-		yield();
+	if (cmd_ack_seq_ == cmd_seq_ && latest_ack_ == expected_ack_opcode_) {
+		success = latest_command_success_;
+		return true;
 	}
 	return false;
 }
 
-bool ld2410::parse_command_frame_()
-{
-	uint16_t intra_frame_data_length_ = radar_data_frame_[4] + (radar_data_frame_[5] << 8);
-	#ifdef LD2410_DEBUG_COMMANDS
-	if(debug_uart_ != nullptr)
-	{
-		print_frame_();
-		debug_uart_->print(F("\nACK frame payload: "));
-		debug_uart_->print(intra_frame_data_length_);
-		debug_uart_->print(F(" bytes"));
-	}
-	#endif
-	// Atomic update of (latest_ack_, latest_command_success_, cmd_ack_seq_).
-	// wait_for_ack_() reads this triplet to decide if the current command's
-	// ACK has landed. cmd_ack_seq_ mirrors cmd_seq_ only on opcode match,
-	// preventing false positives from stale ACKs of previously-timed-out commands.
-	uint8_t this_ack = radar_data_frame_[6];
-	bool this_success = (radar_data_frame_[8] == 0x00 && radar_data_frame_[9] == 0x00);
-#if defined(ESP32)
-	portENTER_CRITICAL(&data_mux_);
-#endif
-	latest_ack_ = this_ack;
-	latest_command_success_ = this_success;
-	if (this_ack == expected_ack_opcode_) {
-		cmd_ack_seq_ = cmd_seq_;
-	}
-#if defined(ESP32)
-	portEXIT_CRITICAL(&data_mux_);
-#endif
-	if(intra_frame_data_length_ == 8 && latest_ack_ == 0xFF)
-	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for entering configuration mode: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
-		}
-	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0xFE)
-	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for leaving configuration mode: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
-		}
+ld2410_command_handle ld2410_base::queueCommand(const ld2410_command &command, ld2410_command_callback callback, void *context) {
+    return queue_job_(command, nullptr, callback, context);
+}
+
+ld2410_command_handle ld2410_base::queueTransaction(ld2410_transaction &transaction, ld2410_command_callback callback, void *context) {
+    if (transaction.count_ == 0) {
+        return 0;
+    }
+    return queue_job_(transaction.commands_[0], &transaction, callback, context);
+}
+
+bool ld2410_base::commitTransaction(ld2410_transaction &transaction) {
+    if (transaction.count_ == 0) {
+        return true;
+    }
+    return wait_for_job_(queue_job_(transaction.commands_[0], &transaction, nullptr, nullptr, true));
+}
+
+// Prefer a free slot; failing that, recycle one whose result was never
+// collected. A slot a blocking call is waiting on is never recycled, or the
+// waiter would find its handle gone and report failure for a command that
+// succeeded; it frees the slot itself when it collects the result.
+ld2410_command_handle ld2410_base::queue_job_(const ld2410_command &command, ld2410_transaction *transaction, ld2410_command_callback callback, void *context, bool waited) {
+    if (radar_uart_ == nullptr) {
+        return 0;
+    }
+    command_job_ *job = nullptr;
+    for (uint8_t pass = 0; pass < 2 && job == nullptr; pass++) {
+        for (uint8_t i = 0; i < LD2410_COMMAND_QUEUE_LENGTH; i++) {
+            uint8_t status = command_jobs_[i].status.load(ld2410_acquire);
+            if (pass == 0 ? status != LD2410_COMMAND_UNKNOWN :
+                    !ld2410_command_finished(status) || command_jobs_[i].waited.load(ld2410_relaxed)) {
+                continue;
+            }
+            if (command_jobs_[i].status.compare_exchange_strong(status, LD2410_COMMAND_SLOT_CLAIMED, ld2410_acq_rel)) {
+                job = &command_jobs_[i];
+                break;
+            }
+        }
+    }
+    if (job == nullptr) {
+        return 0;
+    }
+    ld2410_command_handle handle = next_command_handle_.fetch_add(1, ld2410_relaxed);
+    if (handle == 0) {
+        handle = next_command_handle_.fetch_add(1, ld2410_relaxed);
+    }
+    job->command = command;
+    job->transaction = transaction;
+    job->callback = callback;
+    job->context = context;
+    job->waited.store(waited, ld2410_relaxed);
+    job->handle.store(handle, ld2410_relaxed);
+    if (transaction != nullptr) {
+        for (uint8_t i = 0; i < transaction->count_; i++) {
+            transaction->results_[i] = LD2410_COMMAND_QUEUED;
+        }
+    }
+    job->status.store(LD2410_COMMAND_QUEUED, ld2410_release);
+    notifyDataAvailable();		// a sleeping autoReadTask picks the command up now
+    return handle;
+}
+
+ld2410_command_status ld2410_base::commandStatus(ld2410_command_handle handle) {
+    if (handle == 0) {
+        return LD2410_COMMAND_UNKNOWN;
+    }
+    for (uint8_t i = 0; i < LD2410_COMMAND_QUEUE_LENGTH; i++) {
+        command_job_ &job = command_jobs_[i];
+        uint8_t status = job.status.load(ld2410_acquire);
+        if (status == LD2410_COMMAND_UNKNOWN || job.handle.load(ld2410_relaxed) != handle) {
+            continue;
+        }
+        if (status == LD2410_COMMAND_SLOT_CLAIMED) {
+            return LD2410_COMMAND_QUEUED;
+        }
+        if (ld2410_command_finished(status) &&
+            !job.status.compare_exchange_strong(status, LD2410_COMMAND_UNKNOWN, ld2410_acq_rel)) {
+            return LD2410_COMMAND_UNKNOWN;	// collected by someone else meanwhile
+        }
+        return (ld2410_command_status)status;
+    }
+    return LD2410_COMMAND_UNKNOWN;
+}
+
+bool ld2410_base::commandsPending() {
+    for (uint8_t i = 0; i < LD2410_COMMAND_QUEUE_LENGTH; i++) {
+        const uint8_t status = command_jobs_[i].status.load(ld2410_acquire);
+        if (status == LD2410_COMMAND_QUEUED || status == LD2410_COMMAND_RUNNING ||
+            status == LD2410_COMMAND_SLOT_CLAIMED) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Handles are issued in queueCommand() order, so the oldest queued command is
+// the one whose handle is the fewest steps past the last one started.
+int8_t ld2410_base::next_queued_command_() {
+    int8_t oldest = -1;
+    uint16_t oldest_age = 0;
+    for (uint8_t i = 0; i < LD2410_COMMAND_QUEUE_LENGTH; i++) {
+        if (command_jobs_[i].status.load(ld2410_acquire) != LD2410_COMMAND_QUEUED) {
+            continue;
+        }
+        const uint16_t age = (uint16_t)(command_jobs_[i].handle.load(ld2410_relaxed) - last_started_handle_);
+        if (oldest < 0 || age < oldest_age) {
+            oldest = (int8_t)i;
+            oldest_age = age;
+        }
+    }
+    return oldest;
+}
+
+const ld2410_command &ld2410_base::active_command_() const {
+    const command_job_ &job = command_jobs_[command_active_];
+    return job.transaction != nullptr ? job.transaction->commands_[command_index_] : job.command;
+}
+
+void ld2410_base::service_commands_() {
+    if (radar_uart_ == nullptr) {
+        return;
+    }
+    for (;;) {
+        const uint32_t now = millis();
+        const uint32_t elapsed = now - command_since_;
+        bool success = false;
+        switch (command_state_) {
+        case LD2410_ENGINE_IDLE: {
+            const int8_t next = next_queued_command_();
+            if (next < 0) {
+                return;
+            }
+            command_active_ = next;
+            last_started_handle_ = command_jobs_[next].handle.load(ld2410_relaxed);
+            command_jobs_[next].status.store(LD2410_COMMAND_RUNNING, ld2410_release);
+            command_index_ = 0;
+            command_result_ = LD2410_COMMAND_TIMED_OUT;
+            send_command_(ld2410_command::enterConfigurationMode());
+            command_state_ = LD2410_ENGINE_ENTERING;
+            command_since_ = now;
+            return;
+        }
+        case LD2410_ENGINE_ENTERING:
+            if (command_acked_(success)) {
+                command_result_ = success ? LD2410_COMMAND_RUNNING : LD2410_COMMAND_FAILED;
+            } else if (elapsed < radar_uart_command_timeout_) {
+                return;
+            }
+            command_state_ = success ? LD2410_ENGINE_COMMAND_GAP : LD2410_ENGINE_LEAVE_GAP;
+            command_since_ = now;
+            break;
+        case LD2410_ENGINE_COMMAND_GAP:
+            if (elapsed < LD2410_COMMAND_GAP_MS) {
+                return;
+            }
+            command_result_ = LD2410_COMMAND_TIMED_OUT;
+            send_command_(active_command_());
+            command_state_ = LD2410_ENGINE_COMMAND_SENT;
+            command_since_ = now;
+            return;
+        case LD2410_ENGINE_COMMAND_SENT:
+            if (command_acked_(success)) {
+                command_result_ = success ? LD2410_COMMAND_SUCCEEDED : LD2410_COMMAND_FAILED;
+            } else if (elapsed < radar_uart_command_timeout_) {
+                return;
+            }
+            command_since_ = now;
+            if (command_jobs_[command_active_].transaction != nullptr) {
+                ld2410_transaction &transaction = *command_jobs_[command_active_].transaction;
+                transaction.results_[command_index_] = (ld2410_command_status)command_result_;
+                if (success && active_command_().opcode != 0xA3 && command_index_ + 1 < transaction.count_) {
+                    command_index_++;
+                    command_state_ = LD2410_ENGINE_COMMAND_GAP;
+                    break;
+                }
+            }
+            command_state_ = LD2410_ENGINE_LEAVE_GAP;
+            break;
+        case LD2410_ENGINE_LEAVE_GAP:
+            if (elapsed < LD2410_COMMAND_GAP_MS) {
+                return;
+            }
+            send_command_(ld2410_command::leaveConfigurationMode());
+            command_state_ = LD2410_ENGINE_LEAVING;
+            command_since_ = now;
+            return;
+        case LD2410_ENGINE_LEAVING:
+            if (!command_acked_(success) && elapsed < radar_uart_command_timeout_) {
+                return;
+            }
+            if (command_result_ == LD2410_COMMAND_SUCCEEDED && active_command_().opcode == 0xA3) {
+                // After ACK 0xA3 the radar reboots and emits ~500-800ms of
+                // garbage or silence on its UART. Fed to the parser, those
+                // bytes could occasionally match a 0xF4/0xFD frame start and
+                // clobber the field cache with synthetic data, so ingestion
+                // discards everything until the window has passed.
+                rx_muted_.store(true, ld2410_release);
+                command_state_ = LD2410_ENGINE_REBOOTING;
+                command_since_ = now;
+                return;
+            }
+            finish_command_();
+            break;
+        case LD2410_ENGINE_REBOOTING:
+            if (elapsed < LD2410_RESTART_MUTE_MS) {
+                return;
+            }
+            ingest_uart_();		// discard whatever is still pending from the reboot
+            rx_muted_.store(false, ld2410_release);
+            finish_command_();
+            break;
+        default:
+            command_state_ = LD2410_ENGINE_IDLE;
+            break;
+        }
+    }
+}
+
+// A command with a callback gives up its slot before the callback runs, so
+// the callback can queue a follow-up even when the queue was full. Without a
+// callback the result waits in the slot for commandStatus().
+void ld2410_base::finish_command_() {
+    command_job_ &job = command_jobs_[command_active_];
+    ld2410_command_status result = (ld2410_command_status)command_result_;
+    if (job.transaction != nullptr) {
+        // A refused enter-config never reached the first command
+        ld2410_transaction &transaction = *job.transaction;
+        for (uint8_t i = 0; i < transaction.count_; i++) {
+            if (transaction.results_[i] == LD2410_COMMAND_QUEUED) {
+                transaction.results_[i] = (i == 0) ? result : LD2410_COMMAND_SKIPPED;
+            }
+        }
+        if (result == LD2410_COMMAND_SUCCEEDED && command_index_ + 1 < transaction.count_) {
+            result = LD2410_COMMAND_SKIPPED;	// ended early by a restart
+        }
+    }
+    const ld2410_command_callback callback = job.callback;
+    void *context = job.context;
+    const ld2410_command_handle handle = job.handle.load(ld2410_relaxed);
+    command_state_ = LD2410_ENGINE_IDLE;
+    command_active_ = -1;
+    if (callback != nullptr) {
+        job.status.store(LD2410_COMMAND_UNKNOWN, ld2410_release);
+        callback(*this, handle, result, context);
+    } else {
+        job.status.store(result, ld2410_release);
+    }
+}
+
+// The blocking request*/set* methods. Without a task this thread drives
+// ingestion, parsing and the engine itself; with the task running it only
+// watches the slot while the task does the work.
+bool ld2410_base::run_command_(const ld2410_command &command) {
+    return wait_for_job_(queue_job_(command, nullptr, nullptr, nullptr, true));
+}
+
+bool ld2410_base::wait_for_job_(ld2410_command_handle handle) {
+    if (handle == 0) {
+        return false;
+    }
+    for (;;) {
+        if (!isAutoReadTaskRunning()) {
+            ingest_uart_();
+            while (read_frame_()) {
+            }
+            service_commands_();
+        }
+#if defined(ESP32)
+        else {
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+#else
+        else {
+            delay(1);		// an ld2410_reactor thread is parsing
+        }
+#endif
+        const ld2410_command_status status = commandStatus(handle);
+        if (status != LD2410_COMMAND_QUEUED && status != LD2410_COMMAND_RUNNING) {
+            return status == LD2410_COMMAND_SUCCEEDED;
+        }
+        yield();
+    }
+}
+
+// ACK dispatch table. Every ACK gets the same status, debug and timestamp
+// handling; only ACKs that carry a value have a decoder, and it only runs for
+// a successful ACK of the expected length. Supporting another command is a
+// matter of adding a row. The table, its labels and the opcode index below
+// live in flash.
+static const char LD2410_ACK_MAX_VALUES[] PROGMEM = "setting max values";
+static const char LD2410_ACK_CONFIGURATION[] PROGMEM = "current configuration";
+static const char LD2410_ACK_START_ENGINEERING[] PROGMEM = "starting engineering mode";
+static const char LD2410_ACK_END_ENGINEERING[] PROGMEM = "ending engineering mode";
+static const char LD2410_ACK_SENSITIVITY[] PROGMEM = "setting sensitivity values";
+static const char LD2410_ACK_FIRMWARE[] PROGMEM = "firmware version";
+static const char LD2410_ACK_BAUD_RATE[] PROGMEM = "setting baud rate";
+static const char LD2410_ACK_FACTORY_RESET[] PROGMEM = "factory reset";
+static const char LD2410_ACK_RESTART[] PROGMEM = "restart";
+static const char LD2410_ACK_MAC_ADDRESS[] PROGMEM = "MAC address";
+static const char LD2410_ACK_SET_RESOLUTION[] PROGMEM = "setting distance resolution";
+static const char LD2410_ACK_RESOLUTION[] PROGMEM = "distance resolution";
+static const char LD2410_ACK_LEAVE_CONFIG[] PROGMEM = "leaving configuration mode";
+static const char LD2410_ACK_ENTER_CONFIG[] PROGMEM = "entering configuration mode";
+
+constexpr ld2410_base::ack_handler_ ld2410_base::ack_handlers_[] PROGMEM = {
+	{0x60,  4, nullptr,                                                          LD2410_ACK_MAX_VALUES},
+	{0x61, 28, &ld2410_base::decode_<&ld2410_base::decode_configuration_>,       LD2410_ACK_CONFIGURATION},
+	{0x62,  4, &ld2410_base::decode_<&ld2410_base::decode_engineering_on_>,      LD2410_ACK_START_ENGINEERING},
+	{0x63,  4, &ld2410_base::decode_<&ld2410_base::decode_engineering_off_>,     LD2410_ACK_END_ENGINEERING},
+	{0x64,  4, nullptr,                                                          LD2410_ACK_SENSITIVITY},
+	{0xA0, 12, &ld2410_base::decode_<&ld2410_base::decode_firmware_version_>,    LD2410_ACK_FIRMWARE},
+	{0xA1,  4, nullptr,                                                          LD2410_ACK_BAUD_RATE},
+	{0xA2,  4, nullptr,                                                          LD2410_ACK_FACTORY_RESET},
+	{0xA3,  4, &ld2410_base::decode_<&ld2410_base::decode_engineering_off_>,     LD2410_ACK_RESTART},
+	{0xA5, 10, &ld2410_base::decode_<&ld2410_base::decode_mac_address_>,         LD2410_ACK_MAC_ADDRESS},
+	{0xAA,  4, nullptr,                                                          LD2410_ACK_SET_RESOLUTION},
+	{0xAB,  6, &ld2410_base::decode_<&ld2410_base::decode_distance_resolution_>, LD2410_ACK_RESOLUTION},
+	{0xFE,  4, nullptr,                                                          LD2410_ACK_LEAVE_CONFIG},
+	{0xFF,  8, nullptr,                                                          LD2410_ACK_ENTER_CONFIG},
+};
+constexpr uint8_t ld2410_base::ack_handler_count_ = sizeof(ack_handlers_) / sizeof(ack_handlers_[0]);
+
+// Command words fall in three blocks of sixteen, 0x60-0x6F, 0xA0-0xAF and
+// 0xF0-0xFF. The index maps each of those 48 opcodes to its table row (0xFF
+// for none), so finding the handler is one lookup whatever the opcode. It is
+// generated from the table at compile time.
+static int8_t ld2410_ack_block(uint8_t opcode) {
+	switch(opcode >> 4)
+	{
+		case 0x6: return 0;
+		case 0xA: return 16;
+		case 0xF: return 32;
+		default: return -1;
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0x60)
+}
+
+constexpr uint8_t ld2410_base::ack_handler_row_(uint8_t opcode, uint8_t row) {
+	return row >= ack_handler_count_ ? 0xFF :
+		ack_handlers_[row].opcode == opcode ? row : ack_handler_row_(opcode, row + 1);
+}
+
+#define LD2410_ACK_INDEX_BLOCK(b) \
+	ack_handler_row_(b + 0x0, 0), ack_handler_row_(b + 0x1, 0), ack_handler_row_(b + 0x2, 0), ack_handler_row_(b + 0x3, 0), \
+	ack_handler_row_(b + 0x4, 0), ack_handler_row_(b + 0x5, 0), ack_handler_row_(b + 0x6, 0), ack_handler_row_(b + 0x7, 0), \
+	ack_handler_row_(b + 0x8, 0), ack_handler_row_(b + 0x9, 0), ack_handler_row_(b + 0xA, 0), ack_handler_row_(b + 0xB, 0), \
+	ack_handler_row_(b + 0xC, 0), ack_handler_row_(b + 0xD, 0), ack_handler_row_(b + 0xE, 0), ack_handler_row_(b + 0xF, 0)
+constexpr uint8_t ld2410_base::ack_handler_index_[48] PROGMEM = {
+	LD2410_ACK_INDEX_BLOCK(0x60), LD2410_ACK_INDEX_BLOCK(0xA0), LD2410_ACK_INDEX_BLOCK(0xF0)
+};
+#undef LD2410_ACK_INDEX_BLOCK
+
+// Every row must be reachable through the index: its opcode in one of the
+// three blocks, and not shadowed by an earlier row with the same opcode.
+constexpr bool ld2410_base::ack_handlers_indexed_(uint8_t row) {
+	return row >= ack_handler_count_ ||
+		(((ack_handlers_[row].opcode >> 4) == 0x6 || (ack_handlers_[row].opcode >> 4) == 0xA || (ack_handlers_[row].opcode >> 4) == 0xF) &&
+		 ack_handler_row_(ack_handlers_[row].opcode, 0) == row && ack_handlers_indexed_(row + 1));
+}
+
+bool ld2410_base::parse_command_frame_()
+{
+	static_assert(ack_handlers_indexed_(0), "every ack_handlers_ row needs a unique opcode in 0x6_, 0xA_ or 0xF_");
+	uint16_t intra_frame_data_length_ = frame_.le16(4);
+	#ifdef LD2410_DEBUG_COMMANDS
+	if(debug_uart_ != nullptr)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for setting max values: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
-		}
+		print_frame_();
+		debug_uart_->print(F("\nACK frame payload: "));
+		debug_uart_->print(intra_frame_data_length_);
+		debug_uart_->print(F(" bytes"));
+	}
+	#endif
+	// command_acked_() reads (latest_ack_, latest_command_success_,
+	// cmd_ack_seq_) to decide if the current command's ACK has landed; both
+	// run in the parsing context. cmd_ack_seq_ mirrors cmd_seq_ only on opcode
+	// match, preventing false positives from stale ACKs of previously-timed-out
+	// commands.
+	latest_ack_ = frame_[6];
+	latest_command_success_ = (frame_[8] == 0x00 && frame_[9] == 0x00);
+	if (latest_ack_ == expected_ack_opcode_) {
+		cmd_ack_seq_ = cmd_seq_;
 	}
-	else if(intra_frame_data_length_ == 28 && latest_ack_ == 0x61)
+	const int8_t block = ld2410_ack_block(latest_ack_);
+	const uint8_t row = block < 0 ? 0xFF : pgm_read_byte(&ack_handler_index_[block + (latest_ack_ & 0x0F)]);
+	if(row != 0xFF && pgm_read_byte(&ack_handlers_[row].length) == intra_frame_data_length_)
 	{
+		ack_handler_ handler;
+		memcpy_P(&handler, &ack_handlers_[row], sizeof(handler));
 		#ifdef LD2410_DEBUG_COMMANDS
 		if(debug_uart_ != nullptr)
 		{
-			debug_uart_->print(F("\nACK for current configuration: "));
+			debug_uart_->print(F("\nACK for "));
+			debug_uart_->print(reinterpret_cast<const __FlashStringHelper *>(handler.label));
+			debug_uart_->print(F(": "));
 		}
 		#endif
 		if(latest_command_success_)
@@ -705,539 +1516,292 @@ bool ld2410::parse_command_frame_()
 				debug_uart_->print(F("OK"));
 			}
 			#endif
-			max_gate = radar_data_frame_[11];
-			max_moving_gate = radar_data_frame_[12];
-			max_stationary_gate = radar_data_frame_[13];
-			motion_sensitivity[0] = radar_data_frame_[14];
-			motion_sensitivity[1] = radar_data_frame_[15];
-			motion_sensitivity[2] = radar_data_frame_[16];
-			motion_sensitivity[3] = radar_data_frame_[17];
-			motion_sensitivity[4] = radar_data_frame_[18];
-			motion_sensitivity[5] = radar_data_frame_[19];
-			motion_sensitivity[6] = radar_data_frame_[20];
-			motion_sensitivity[7] = radar_data_frame_[21];
-			motion_sensitivity[8] = radar_data_frame_[22];
-			stationary_sensitivity[0] = radar_data_frame_[23];
-			stationary_sensitivity[1] = radar_data_frame_[24];
-			stationary_sensitivity[2] = radar_data_frame_[25];
-			stationary_sensitivity[3] = radar_data_frame_[26];
-			stationary_sensitivity[4] = radar_data_frame_[27];
-			stationary_sensitivity[5] = radar_data_frame_[28];
-			stationary_sensitivity[6] = radar_data_frame_[29];
-			stationary_sensitivity[7] = radar_data_frame_[30];
-			stationary_sensitivity[8] = radar_data_frame_[31];
-			sensor_idle_time = radar_data_frame_[32];
-			sensor_idle_time += (radar_data_frame_[33] << 8);
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
+			if(handler.decode != nullptr)
 			{
-				debug_uart_->print(F("\nMax gate distance: "));
-				debug_uart_->print(max_gate);
-				debug_uart_->print(F("\nMax motion detecting gate distance: "));
-				debug_uart_->print(max_moving_gate);
-				debug_uart_->print(F("\nMax stationary detecting gate distance: "));
-				debug_uart_->print(max_stationary_gate);
-				debug_uart_->print(F("\nSensitivity per gate"));
-				for(uint8_t i = 0; i < 9; i++)
-				{
-					debug_uart_->print(F("\nGate "));
-					debug_uart_->print(i);
-					debug_uart_->print(F(" ("));
-					debug_uart_->print(i * 0.75);
-					debug_uart_->print('-');
-					debug_uart_->print((i+1) * 0.75);
-					debug_uart_->print(F(" metres) Motion: "));
-					debug_uart_->print(motion_sensitivity[i]);
-					debug_uart_->print(F(" Stationary: "));
-					debug_uart_->print(stationary_sensitivity[i]);
-
-				}
-				debug_uart_->print(F("\nSensor idle timeout: "));
-				debug_uart_->print(sensor_idle_time);
-				debug_uart_->print('s');
+				handler.decode(*this);
 			}
-			#endif
 			return true;
 		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
-		}
-	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0x64)
-	{
-		#ifdef LD2410_DEBUG_COMMANDS
 		if(debug_uart_ != nullptr)
 		{
-			debug_uart_->print(F("\nACK for setting sensitivity values: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
+			debug_uart_->print(F("failed"));
 		}
+		return false;
 	}
-	else if(intra_frame_data_length_ == 12 && latest_ack_ == 0xA0)
+	#ifdef LD2410_DEBUG_COMMANDS
+	if(debug_uart_ != nullptr)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for firmware version: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			firmware_major_version = radar_data_frame_[13];
-			firmware_minor_version = radar_data_frame_[12];
-			firmware_bugfix_version = radar_data_frame_[14];
-			firmware_bugfix_version += radar_data_frame_[15]<<8;
-			firmware_bugfix_version += radar_data_frame_[16]<<16;
-			firmware_bugfix_version += radar_data_frame_[17]<<24;
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
-		}
+		debug_uart_->print(F("\nUnknown ACK"));
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0xA2)
+	#endif
+	count_(STAT_UNKNOWN_ACKS);
+    if (latest_command_success_) {
+        radar_uart_last_packet_ = millis();
+        return true;
+    }
+	return false;
+}
+
+void ld2410_base::decode_configuration_()
+{
+	max_gate = frame_[11];
+	max_moving_gate = frame_[12];
+	max_stationary_gate = frame_[13];
+	for(uint8_t i = 0; i < 9; i++)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for factory reset: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
-		}
+		motion_sensitivity[i] = frame_[14 + i];
+		stationary_sensitivity[i] = frame_[23 + i];
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0xA3)
+	sensor_idle_time = frame_.le16(32);
+	#ifdef LD2410_DEBUG_COMMANDS
+	if(debug_uart_ != nullptr)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
+		debug_uart_->print(F("\nMax gate distance: "));
+		debug_uart_->print(max_gate);
+		debug_uart_->print(F("\nMax motion detecting gate distance: "));
+		debug_uart_->print(max_moving_gate);
+		debug_uart_->print(F("\nMax stationary detecting gate distance: "));
+		debug_uart_->print(max_stationary_gate);
+		debug_uart_->print(F("\nSensitivity per gate"));
+		for(uint8_t i = 0; i < 9; i++)
 		{
-			debug_uart_->print(F("\nACK for restart: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
+			debug_uart_->print(F("\nGate "));
+			debug_uart_->print(i);
+			debug_uart_->print(F(" ("));
+			debug_uart_->print(i * 0.75);
+			debug_uart_->print('-');
+			debug_uart_->print((i+1) * 0.75);
+			debug_uart_->print(F(" metres) Motion: "));
+			debug_uart_->print(motion_sensitivity[i]);
+			debug_uart_->print(F(" Stationary: "));
+			debug_uart_->print(stationary_sensitivity[i]);
+
 		}
+		debug_uart_->print(F("\nSensor idle timeout: "));
+		debug_uart_->print(sensor_idle_time);
+		debug_uart_->print('s');
 	}
-	else
+	#endif
+}
+
+void ld2410_base::decode_firmware_version_()
+{
+	firmware_major_version = frame_[13];
+	firmware_minor_version = frame_[12];
+	firmware_bugfix_version = frame_[14];
+	firmware_bugfix_version += (uint32_t)frame_[15]<<8;
+	firmware_bugfix_version += (uint32_t)frame_[16]<<16;
+	firmware_bugfix_version += (uint32_t)frame_[17]<<24;
+}
+
+void ld2410_base::decode_engineering_on_()
+{
+	engineering_mode_.store(LD2410_ENGINEERING_ON, ld2410_release);
+}
+
+void ld2410_base::decode_engineering_off_()
+{
+	engineering_mode_.store(LD2410_ENGINEERING_OFF, ld2410_release);
+}
+
+void ld2410_base::decode_mac_address_()
+{
+	for(uint8_t i = 0; i < 6; i++)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nUnknown ACK"));
-		}
-		#endif
+		mac_address[i] = frame_[10 + i];
 	}
+}
 
-    if (latest_command_success_) {
-        last_valid_frame_length = radar_data_frame_position_;  // Aggiungi questa linea
-        radar_uart_last_packet_ = millis();
-        return true;
-    }
-	return false;
+void ld2410_base::decode_distance_resolution_()
+{
+	distance_resolution = (uint8_t)frame_.le16(10);
 }
 
 
 
-void ld2410::send_command_preamble_()
+// The whole frame is encoded on the stack and handed to the UART in one
+// write(), rather than one call per byte.
+void ld2410_base::send_command_(const ld2410_command &command)
 {
-	//Command preamble
-	radar_uart_->write((byte)0xFD);
-	radar_uart_->write((byte)0xFC);
-	radar_uart_->write((byte)0xFB);
-	radar_uart_->write((byte)0xFA);
+	begin_command_(command.opcode);
+	uint8_t frame[LD2410_MAX_COMMAND_FRAME_LENGTH];
+	radar_uart_->write(frame, command.encode(frame));
 }
 
-void ld2410::send_command_postamble_()
+// Per protocol §2.4.1, every config command must be issued inside an
+// enter/leave configuration window -- otherwise the radar silently rejects
+// it. The engine wraps every queued command in one.
+bool ld2410_base::requestStartEngineeringMode()
 {
-	//Command end
-	radar_uart_->write((byte)0x04);
-	radar_uart_->write((byte)0x03);
-	radar_uart_->write((byte)0x02);
-	radar_uart_->write((byte)0x01);
+	return run_command_(ld2410_command::requestStartEngineeringMode());
 }
 
-bool ld2410::enter_configuration_mode_()
+bool ld2410_base::requestEndEngineeringMode()
 {
-	begin_command_(0xFF);
-	send_command_preamble_();
-	radar_uart_->write((byte) 0x04);	//Command is four bytes long
-	radar_uart_->write((byte) 0x00);
-	radar_uart_->write((byte) 0xFF);	//Request enter command mode
-	radar_uart_->write((byte) 0x00);
-	radar_uart_->write((byte) 0x01);
-	radar_uart_->write((byte) 0x00);
-	send_command_postamble_();
-	return wait_for_ack_(0xFF, radar_uart_command_timeout_);
-}
-
-bool ld2410::leave_configuration_mode_()
+	return run_command_(ld2410_command::requestEndEngineeringMode());
+}
+
+bool ld2410_base::requestCurrentConfiguration()
 {
-	begin_command_(0xFE);
-	send_command_preamble_();
-	radar_uart_->write((byte) 0x02);	//Command is two bytes long
-	radar_uart_->write((byte) 0x00);
-	radar_uart_->write((byte) 0xFE);	//Request leave command mode
-	radar_uart_->write((byte) 0x00);
-	send_command_postamble_();
-	return wait_for_ack_(0xFE, radar_uart_command_timeout_);
+	return run_command_(ld2410_command::requestCurrentConfiguration());
 }
 
-bool ld2410::requestStartEngineeringMode()
+bool ld2410_base::requestFirmwareVersion()
 {
-	// Per protocol §2.4.1, every config command must be issued inside an
-	// enter/leave configuration window — otherwise the radar silently
-	// rejects it. The other request*/set* helpers all wrap; these two
-	// engineering-mode helpers were originally missing the wrap, which
-	// caused the command to time out without an ACK.
-	if(enter_configuration_mode_())
-	{
-		delay(50);
-		begin_command_(0x62);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x62);	//Request enter engineering mode
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		bool ok = wait_for_ack_(0x62, radar_uart_command_timeout_);
-		delay(50);
-		leave_configuration_mode_();
-		return ok;
-	}
-	delay(50);
-	leave_configuration_mode_();
-	return false;
+	return run_command_(ld2410_command::requestFirmwareVersion());
 }
 
-bool ld2410::requestEndEngineeringMode()
+bool ld2410_base::requestRestart()
 {
-	if(enter_configuration_mode_())
-	{
-		delay(50);
-		begin_command_(0x63);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x63);	//Request leave engineering mode
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		bool ok = wait_for_ack_(0x63, radar_uart_command_timeout_);
-		delay(50);
-		leave_configuration_mode_();
-		return ok;
-	}
-	delay(50);
-	leave_configuration_mode_();
-	return false;
+	return run_command_(ld2410_command::requestRestart());
 }
 
-bool ld2410::requestCurrentConfiguration()
+bool ld2410_base::requestFactoryReset()
 {
-	if(enter_configuration_mode_())
-	{
-		delay(50);
-		begin_command_(0x61);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x61);	//Request current configuration
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		bool ok = wait_for_ack_(0x61, radar_uart_command_timeout_);
-		delay(50);
-		leave_configuration_mode_();
-		return ok;
-	}
-	delay(50);
-	leave_configuration_mode_();
-	return false;
+	return run_command_(ld2410_command::requestFactoryReset());
 }
 
-bool ld2410::requestFirmwareVersion()
+bool ld2410_base::setMaxValues(uint16_t moving, uint16_t stationary, uint16_t inactivityTimer)
 {
-	if(enter_configuration_mode_())
-	{
-		delay(50);
-		begin_command_(0xA0);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xA0);	//Request firmware version
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		bool ok = wait_for_ack_(0xA0, radar_uart_command_timeout_);
-		delay(50);
-		leave_configuration_mode_();
-		return ok;
-	}
-	delay(50);
-	leave_configuration_mode_();
-	return false;
+	return run_command_(ld2410_command::setMaxValues(moving, stationary, inactivityTimer));
 }
 
+bool ld2410_base::setGateSensitivityThreshold(uint8_t gate, uint8_t moving, uint8_t stationary)
+{
+	return run_command_(ld2410_command::setGateSensitivityThreshold(gate, moving, stationary));
+}
 
+bool ld2410_base::requestMacAddress()
+{
+	return run_command_(ld2410_command::requestMacAddress());
+}
 
-bool ld2410::requestRestart()
+bool ld2410_base::requestDistanceResolution()
 {
-	if(enter_configuration_mode_())
+	return run_command_(ld2410_command::requestDistanceResolution());
+}
+
+bool ld2410_base::setDistanceResolution(uint8_t resolution)
+{
+	if(resolution > 1)
 	{
-		delay(50);
-		begin_command_(0xA3);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xA3);	//Request restart
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		bool ok = wait_for_ack_(0xA3, radar_uart_command_timeout_);
-		delay(50);
-		leave_configuration_mode_();
-		if (ok) {
-			// After ACK 0xA3 the radar reboots and emits ~500-800ms of garbage
-			// or silence on its UART. If autoReadTask is running it would
-			// happily feed those bytes to parse_data_frame_, occasionally
-			// matching a 0xF4/0xFD frame start and clobbering the field cache
-			// with synthetic data. Suspend the task across the reboot window,
-			// drain the UART RX FIFO and the circular buffer twice, then
-			// resume.
-#if defined(ESP32)
-			TaskHandle_t suspended = nullptr;
-			portENTER_CRITICAL(&data_mux_);
-			suspended = taskHandle_;
-			portEXIT_CRITICAL(&data_mux_);
-			if (suspended != nullptr) {
-				vTaskSuspend(suspended);
-			}
-#endif
-			while (radar_uart_->available()) radar_uart_->read();
-			delay(800);
-			while (radar_uart_->available()) radar_uart_->read();
-#if defined(ESP32)
-			portENTER_CRITICAL(&data_mux_);
-			buffer_tail = buffer_head;
-			radar_data_frame_position_ = 0;
-			portEXIT_CRITICAL(&data_mux_);
-			if (suspended != nullptr) {
-				vTaskResume(suspended);
-			}
-#else
-			buffer_tail = buffer_head;
-			radar_data_frame_position_ = 0;
-#endif
-		}
-		return ok;
+		return false;
 	}
-	delay(50);
-	leave_configuration_mode_();
-	return false;
+	return run_command_(ld2410_command::setDistanceResolution(resolution));
 }
 
-bool ld2410::requestFactoryReset()
+bool ld2410_base::setBaudRate(uint32_t baud)
 {
-	if(enter_configuration_mode_())
+	const uint8_t index = ld2410_command::baud_index(baud);
+	if(index == 0)
 	{
-		delay(50);
-		begin_command_(0xA2);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xA2);	//Request factory reset
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		bool ok = wait_for_ack_(0xA2, radar_uart_command_timeout_);
-		delay(50);
-		leave_configuration_mode_();
-		return ok;
+		return false;
 	}
-	delay(50);
-	leave_configuration_mode_();
-	return false;
+	return run_command_(ld2410_command::setBaudRate(index));
 }
 
-bool ld2410::setMaxValues(uint16_t moving, uint16_t stationary, uint16_t inactivityTimer)
+// Factory default first, then the rates a smaller MCU is most likely to
+// have been set to.
+static const uint32_t LD2410_BAUD_CANDIDATES[] = {256000, 115200, 57600, 38400, 19200, 9600, 230400, 460800};
+
+// Tries each candidate rate in turn through the reconfigure hook and returns
+// the first one at which a whole, valid data frame arrives. The radar sends
+// a frame about every 100ms, so a right rate is confirmed within one or two
+// of them; a wrong one turns the line into junk, which the parser discards,
+// and once two frames' worth has gone without a match the rate is given up
+// rather than waiting out timeoutMs. A silent line costs timeoutMs per rate.
+// If no rate works the UART is put back at the first candidate and 0 is
+// returned. Call it after begin() and before any autoReadTask, scheduler or
+// reactor takes over the sensor, as it reads the UART itself.
+uint32_t ld2410_base::detectBaudRate(ld2410_baud_hook reconfigure, void *context, uint32_t timeoutMs, const uint32_t *candidates, uint8_t count)
 {
-	if(enter_configuration_mode_())
+	if(radar_uart_ == nullptr || reconfigure == nullptr || isAutoReadTaskRunning())
 	{
-		delay(50);
-		begin_command_(0x60);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x14);	//Command is 20 bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x60);	//Request set max values
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);	//Moving gate command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(moving & 0x00FF));	//Moving gate value
-		radar_uart_->write(char((moving & 0xFF00)>>8));
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x01);	//Stationary gate command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(stationary & 0x00FF));	//Stationary gate value
-		radar_uart_->write(char((stationary & 0xFF00)>>8));
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x02);	//Inactivity timer command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(inactivityTimer & 0x00FF));	//Inactivity timer
-		radar_uart_->write(char((inactivityTimer & 0xFF00)>>8));
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		bool ok = wait_for_ack_(0x60, radar_uart_command_timeout_);
-		delay(50);
-		leave_configuration_mode_();
-		return ok;
+		return 0;
 	}
-	delay(50);
-	leave_configuration_mode_();
-	return false;
+	if(candidates == nullptr || count == 0)
+	{
+		candidates = LD2410_BAUD_CANDIDATES;
+		count = sizeof(LD2410_BAUD_CANDIDATES) / sizeof(LD2410_BAUD_CANDIDATES[0]);
+	}
+	for(uint8_t i = 0; i < count; i++)
+	{
+		if(!reconfigure(candidates[i], context))
+		{
+			continue;
+		}
+		// Bytes received at the previous rate are meaningless now.
+		drain_uart_();
+		if(listen_for_frame_(timeoutMs, 2u * max_frame_length_))
+		{
+			#ifdef LD2410_DEBUG_COMMANDS
+			if(debug_uart_ != nullptr)
+			{
+				debug_uart_->print(F("\nLD2410 found at "));
+				debug_uart_->print(candidates[i]);
+				debug_uart_->print(F(" baud"));
+			}
+			#endif
+			return candidates[i];
+		}
+	}
+	reconfigure(candidates[0], context);
+	return 0;
 }
 
-bool ld2410::setGateSensitivityThreshold(uint8_t gate, uint8_t moving, uint8_t stationary)
+bool ld2410_base::listen_for_frame_(uint32_t timeoutMs, uint32_t junkLimit)
 {
-	if(enter_configuration_mode_())
+	const uint32_t sequence = snapshot_.sequence;
+	const uint32_t discarded = stats_[STAT_BYTES_DISCARDED].load(ld2410_relaxed);
+	const uint32_t started = millis();
+	while(millis() - started < timeoutMs)
 	{
-		delay(50);
-		begin_command_(0x64);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x14);	//Command is 20 bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x64);	//Request set sensitivity values
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);	//Gate command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(gate));	//Gate value
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x01);	//Motion sensitivity command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(moving));	//Motion sensitivity value
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x02);	//Stationary sensitivity command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(stationary));	//Stationary sensitivity value
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		bool ok = wait_for_ack_(0x64, radar_uart_command_timeout_);
-		delay(50);
-		leave_configuration_mode_();
-		return ok;
+		ingest_uart_();
+		while(read_frame_())
+		{
+		}
+		if(snapshot_.sequence != sequence)
+		{
+			return true;
+		}
+		if(junkLimit > 0 && stats_[STAT_BYTES_DISCARDED].load(ld2410_relaxed) - discarded >= junkLimit)
+		{
+			return false;
+		}
+		yield();
 	}
-	delay(50);
-	leave_configuration_mode_();
 	return false;
 }
 
-FrameData ld2410::getFrameData() const {
-    // Usa last_valid_frame_length come lunghezza iniziale
-    uint16_t frame_length = last_valid_frame_length;
-
-    // Verifica dell'header
-    if (radar_data_frame_[0] != 0xF4 || 
-        radar_data_frame_[1] != 0xF3 || 
-        radar_data_frame_[2] != 0xF2 || 
-        radar_data_frame_[3] != 0xF1) {
-        // Header non valido
-        return {nullptr, 0};
-    }
-
-    // Verifica la lunghezza del frame dai byte 4 e 5
-    uint16_t reported_length = radar_data_frame_[4] | (radar_data_frame_[5] << 8);
-    reported_length += 10;  // Aggiungi 10 per header e footer
-
-    // Usa la lunghezza minore tra quella riportata e last_valid_frame_length
-    frame_length = (reported_length < frame_length) ? reported_length : frame_length;
+void ld2410_base::keepFrameData(bool keep) {
+    kept_frame_length_.store(0, ld2410_relaxed);
+    keep_frame_data_.store(keep, ld2410_release);
+}
 
-    // Verifica che la lunghezza del frame sia valida
-    if (frame_length > LD2410_MAX_FRAME_LENGTH || frame_length < 10) {
-        // Lunghezza del frame non valida
-        return {nullptr, 0};
+FrameData ld2410_base::getFrameData() {
+    // With keepFrameData() on, the parser has already copied the frame in
+    // its own context and this only hands that copy out.
+    if (keep_frame_data_.load(ld2410_acquire)) {
+        const uint16_t kept = kept_frame_length_.load(ld2410_acquire);
+        return {kept == 0 ? nullptr : radar_data_frame_, kept};
     }
-
-    // Verifica del footer
-    if (radar_data_frame_[frame_length - 4] != 0xF8 || 
-        radar_data_frame_[frame_length - 3] != 0xF7 || 
-        radar_data_frame_[frame_length - 2] != 0xF6 || 
-        radar_data_frame_[frame_length - 1] != 0xF5) {
-        // Footer non valido
+    // Otherwise the raw bytes of the last valid data frame are copied out
+    // of the ring here, on request, which is only safe where the parser
+    // runs. They are still in the ring unless more than its size in bytes
+    // have been ingested since the frame started, in which case it is gone.
+    const uint16_t frame_length = last_valid_frame_length;
+    if (isAutoReadTaskRunning() || frame_length < 10 || frame_length > max_frame_length_ ||
+        ring_.written() - raw_frame_position_ > ring_.size()) {
         return {nullptr, 0};
     }
-
-    // Se tutti i controlli sono passati, restituisci i dati validi
+    const uint16_t start = (uint16_t)(raw_frame_position_ & (ring_.size() - 1));
+    const uint16_t to_end = ring_.size() - start;
+    FrameView frame;
+    frame.first = &ring_.storage()[start];
+    frame.first_length = (frame_length < to_end) ? frame_length : to_end;
+    frame.second = ring_.storage();
+    frame.length = frame_length;
+    frame.copy_to(radar_data_frame_);
     return {radar_data_frame_, frame_length};
 }
 #endif
@@ -13,33 +13,193 @@
 #ifndef ld2410_h
 #define ld2410_h
 #include <Arduino.h>
+#include "ld2410_ring.h"
+#include "ld2410_wake.h"
+#include "ld2410_command.h"
 #if defined(ESP32)
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #endif
 
-#define LD2410_MAX_FRAME_LENGTH 64
+#ifndef LD2410_MAX_FRAME_LENGTH
+#define LD2410_MAX_FRAME_LENGTH 64										//Longest frame the default ld2410 accepts; engineering frames are 45
+#endif
+#define LD2410_MIN_FRAME_LENGTH 38										//Longest frame outside engineering mode, the 0x61 configuration ACK
 #ifndef LD2410_BUFFER_SIZE
-#define LD2410_BUFFER_SIZE 256
+#define LD2410_BUFFER_SIZE 256											//Ring size of the default ld2410
+#endif
+#define LD2410_BUFFER_MASK (LD2410_BUFFER_SIZE - 1)
+#if !defined(LD2410_BULK_READBYTES) && (defined(ESP32) || defined(ESP8266))
+#define LD2410_BULK_READBYTES											//Stream::readBytes() is virtual and HardwareSerial copies in bulk; define it for other such cores
+#endif
+#ifndef LD2410_POLL_INTERVAL_MS
+#define LD2410_POLL_INTERVAL_MS 10										//waitAndRead() sleep when no wake source is set
+#endif
+#ifndef LD2410_TASK_WAKE_TIMEOUT_MS
+#define LD2410_TASK_WAKE_TIMEOUT_MS 100									//Longest the autoReadTask blocks on its wake source
+#endif
+#ifndef LD2410_COMMAND_QUEUE_LENGTH
+#define LD2410_COMMAND_QUEUE_LENGTH 4									//Commands that can be queued or awaiting collection at once
+#endif
+#define LD2410_COMMAND_GAP_MS 50										//Pause after an ACK before the next frame of the same window
+#define LD2410_RESTART_MUTE_MS 800										//Reception is muted this long after a restart is ACKed
+#ifndef LD2410_CONNECTION_LOST_MS
+#define LD2410_CONNECTION_LOST_MS 1000									//Silence after which the connection lost callback fires
+#endif
+#ifndef LD2410_STARTUP_MS
+#define LD2410_STARTUP_MS 1000											//How long begin() waits for the radar
+#endif
+#ifndef LD2410_BAUD_DETECT_MS
+#define LD2410_BAUD_DETECT_MS 300										//How long detectBaudRate() listens at each rate for a data frame
 #endif
 //#define LD2410_DEBUG_DATA
 #define LD2410_DEBUG_COMMANDS
 //#define LD2410_DEBUG_PARSE
 
+class ld2410_history;
+class ld2410_gate_window;
+class ld2410_background;
+class ld2410_scheduler;
+class ld2410_reactor;
+
 struct FrameData {
     const uint8_t* data;
     uint16_t length;
 };
 
-class ld2410	{
+// A complete frame as it sits in the circular buffer. A frame that wraps past
+// the end of the array is described by two spans; indexing hides the seam so
+// the parsers can decode fields in place without copying the frame out.
+struct FrameView {
+    const uint8_t* first = nullptr;
+    uint16_t first_length = 0;
+    const uint8_t* second = nullptr;
+    uint16_t length = 0;											//Total frame length, both spans included
+
+    uint8_t operator[](uint16_t index) const {
+        return index < first_length ? first[index] : second[index - first_length];
+    }
+    uint16_t le16(uint16_t index) const {							//LD2410 fields are little-endian
+        return (uint16_t)((*this)[index] | ((*this)[index + 1] << 8));
+    }
+    void copy_to(uint8_t* destination) const {
+        memcpy(destination, first, first_length);
+        memcpy(destination + first_length, second, length - first_length);
+    }
+};
+
+// One data frame's worth of target data, copied out as a consistent whole by
+// ld2410::getSnapshot(). Distances are in cm; energies are as reported by the
+// radar (0-100). Per-gate energies hold the values of the most recent
+// engineering frame, so they persist across basic frames.
+struct RadarSnapshot {
+    uint32_t sequence = 0;											//Data frames parsed so far; 0 until the first one arrives
+    uint8_t target_type = 0;										//Table 12 target state: 0 none, 1 moving, 2 stationary, 3 both
+    uint16_t moving_target_distance = 0;
+    uint8_t moving_target_energy = 0;
+    uint16_t stationary_target_distance = 0;
+    uint8_t stationary_target_energy = 0;
+    uint16_t detection_distance = 0;
+    bool engineering = false;										//True if this frame was an engineering-mode frame
+    uint8_t moving_gate_energy[9] = {0,0,0,0,0,0,0,0,0};			//Table 14 per-gate motion energy
+    uint8_t stationary_gate_energy[9] = {0,0,0,0,0,0,0,0,0};		//Table 14 per-gate stationary energy
+    uint16_t changed = 0;											//LD2410_CHANGED_* bits for what this frame changed
+};
+
+// Parser and buffer health, from ld2410::getStats(). Every counter only goes
+// up; resetStats() starts them all from zero again. The parser resynchronises
+// by dropping one byte at a time after a bad header, length or footer, so
+// bytes_discarded over the frames parsed is a fair measure of line quality.
+struct RadarStats {
+	uint32_t data_frames = 0;										//Basic data frames parsed
+	uint32_t engineering_frames = 0;								//Engineering mode data frames parsed
+	uint32_t ack_frames = 0;										//ACK frames parsed, successful or not
+	uint32_t unknown_acks = 0;										//ACKs for a command word the library does not know, or of an unexpected length
+	uint32_t invalid_frames = 0;									//Data frames with a good header, length and footer but bad contents
+	uint32_t header_resyncs = 0;									//Times bytes were skipped looking for a frame header
+	uint32_t bad_lengths = 0;										//Headers followed by an impossible length
+	uint32_t footer_mismatches = 0;									//Frames whose footer was not where the length said
+	uint32_t bytes_discarded = 0;									//Bytes dropped by the parser while resynchronising
+	uint32_t buffer_overruns = 0;									//Times bytes arrived with the ring too full to take them all
+	uint32_t bytes_dropped = 0;										//Bytes lost that way, by the overflow policy in force
+	uint32_t buffer_high_water = 0;									//Most bytes waiting at once, ring and UART together; over LD2410_BUFFER_SIZE means overruns
+};
+
+// What ingestion gives up when more bytes are waiting than the ring has room
+// for, see ld2410::setOverflowPolicy().
+enum ld2410_overflow_policy : uint8_t {
+	LD2410_OVERFLOW_DROP_OLDEST = 0,								//Overwrite the oldest unparsed bytes (the default)
+	LD2410_OVERFLOW_DROP_NEWEST,									//Keep the ring as it is and throw the new bytes away
+	LD2410_OVERFLOW_DROP_FRAME										//Drop the oldest whole frames, so the ring still starts at a header
+};
+
+// How begin() makes sure the radar is there.
+enum ld2410_startup : uint8_t {
+	LD2410_STARTUP_NO_WAIT = 0,										//Return at once, as begin(stream, false)
+	LD2410_STARTUP_PASSIVE,											//Wait for the first valid data frame; the firmware version follows in the background
+	LD2410_STARTUP_FIRMWARE											//Query the firmware version, as begin(stream, true)
+};
+
+// Whether the radar is sending engineering frames, see ld2410::engineeringMode().
+enum ld2410_engineering_mode : uint8_t {
+	LD2410_ENGINEERING_UNKNOWN = 0,									//No data frame or start/end engineering mode ACK seen yet
+	LD2410_ENGINEERING_OFF,
+	LD2410_ENGINEERING_ON
+};
+
+// RadarSnapshot::changed bits, see ld2410::setChangeThresholds(); always 0
+// until change detection is turned on. Every bit is set for the first frame.
+enum : uint16_t {
+	LD2410_CHANGED_PRESENCE = 0x0001,									//Table 12 target state went from none to some, or back
+	LD2410_CHANGED_MOVING_TARGET = 0x0002,								//Moving target appeared or went
+	LD2410_CHANGED_STATIONARY_TARGET = 0x0004,							//Stationary target appeared or went
+	LD2410_CHANGED_MOVING_DISTANCE = 0x0008,							//Past its deadband from the value last reported
+	LD2410_CHANGED_MOVING_ENERGY = 0x0010,								//Past its deadband from the value last reported
+	LD2410_CHANGED_STATIONARY_DISTANCE = 0x0020,						//Past its deadband from the value last reported
+	LD2410_CHANGED_STATIONARY_ENERGY = 0x0040,							//Past its deadband from the value last reported
+	LD2410_CHANGED_DETECTION_DISTANCE = 0x0080,							//Past its deadband from the value last reported
+	LD2410_CHANGED_GATE_ENERGY = 0x0100,								//Any per-gate energy, engineering frames only
+	LD2410_CHANGED_ENGINEERING = 0x0200,								//Switched between basic and engineering frames
+	LD2410_CHANGED_ALL = 0x03FF
+};
+
+// Frame callbacks, registered with ld2410::onDataFrame() and friends. They
+// are called from whichever context parses frames: read() or waitAndRead() in
+// loop(), or the autoReadTask on ESP32, right after the frame has been
+// decoded, so getters and getSnapshot() already return its values. Keep them
+// short, as the next frame is not parsed until they return, and do not call
+// read() or the blocking request/set methods from them. To do the work in
+// another ESP32 task, copy what is needed into a FreeRTOS queue, eg.
+// xQueueSend(queue, &snapshot, 0), and receive it there.
+typedef void (*ld2410_frame_callback)(ld2410_base &sensor, const RadarSnapshot &snapshot, void *context);
+typedef void (*ld2410_ack_callback)(ld2410_base &sensor, uint8_t opcode, bool success, void *context);
+typedef void (*ld2410_event_callback)(ld2410_base &sensor, void *context);
+
+// Switches the radar's UART to baud for detectBaudRate(), eg. with
+// Serial1.updateBaudRate(baud) on ESP32, or end() then begin(baud). Return
+// false if the UART cannot run at that rate and it is skipped.
+typedef bool (*ld2410_baud_hook)(uint32_t baud, void *context);
+
+// The sensor itself, apart from its buffers. Declare an ld2410, or an
+// ld2410_t<RingSize, FrameSize> for a different footprint; take an
+// ld2410_base & to work with either.
+class ld2410_base	{
 
 	public:
-		ld2410();														//Constructor function
-		~ld2410();														//Destructor function
+		~ld2410_base();													//Destructor function
 		bool begin(Stream &, bool waitForRadar = true);					//Start the ld2410
+		bool begin(Stream &, ld2410_startup startup, uint32_t timeoutMs = LD2410_STARTUP_MS);	//Start the ld2410, checking for the radar as chosen
 		void debug(Stream &);											//Start debugging on a stream
 		bool isConnected();
 		bool read();
+		bool waitAndRead(uint32_t timeoutMs);							//Block until the wake source fires (or poll), then parse every complete frame
+		void setWakeSource(ld2410_wake_source &source);					//Event-driven waitAndRead()/autoReadTask instead of fixed-interval polling
+		void notifyDataAvailable();										//Call from the UART receive callback when a wake source is set
+		ld2410_command_handle queueCommand(const ld2410_command &command, ld2410_command_callback callback = nullptr, void *context = nullptr);	//Non-blocking; 0 if the queue is full
+		ld2410_command_status commandStatus(ld2410_command_handle handle);	//A finished status is returned once, then the handle is forgotten
+		bool commandsPending();											//True while any queued command has not finished
+		ld2410_command_handle queueTransaction(ld2410_transaction &transaction, ld2410_command_callback callback = nullptr, void *context = nullptr);	//Every command in one config window; 0 if empty or the queue is full
+		bool commitTransaction(ld2410_transaction &transaction);		//Blocking queueTransaction(); true if every command succeeded
 		bool presenceDetected();
 		bool stationaryTargetDetected();
 		uint16_t stationaryTargetDistance();
@@ -51,6 +211,23 @@ class ld2410	{
 		uint8_t movingEnergyAtGate(uint8_t gate);						//Per-gate motion energy from engineering frames (Table 14)
 		uint8_t stationaryEnergyAtGate(uint8_t gate);				//Per-gate stationary energy from engineering frames (Table 14)
 		bool engineeringRetrieved();								//True once at least one engineering-mode data frame has been parsed
+		ld2410_engineering_mode engineeringMode();						//From the last data frame or start/end engineering mode ACK; safe against autoReadTask
+		RadarSnapshot getSnapshot();									//All target fields from one frame, never a mix of two; safe against autoReadTask
+		RadarStats getStats();											//Parser and buffer health counters since begin() or resetStats()
+		void resetStats();
+		void setOverflowPolicy(ld2410_overflow_policy policy);			//What to lose when the ring is full, LD2410_OVERFLOW_DROP_OLDEST by default
+		void setHistory(ld2410_history &history);						//Record every data frame from now on (ld2410_history.h)
+		void setGateWindow(ld2410_gate_window &window);					//Keep per-gate energy statistics over recent engineering frames (ld2410_gates.h)
+		void setBackground(ld2410_background &background);				//Learn each gate's background energy from engineering frames (ld2410_background.h)
+		void startCapture(Print &sink);									//Log every byte read from the radar, with its timing, to sink (ld2410_capture.h)
+		void stopCapture();
+		void onDataFrame(ld2410_frame_callback callback, void *context = nullptr);		//Every data frame, basic or engineering; nullptr to remove
+		void onEngineeringFrame(ld2410_frame_callback callback, void *context = nullptr);	//Engineering frames only
+		void onAck(ld2410_ack_callback callback, void *context = nullptr);				//Every ACK frame, with the command word it answers
+		void onConnectionLost(ld2410_event_callback callback, void *context = nullptr);	//Once, after LD2410_CONNECTION_LOST_MS without a valid frame
+		void setChangeThresholds(uint16_t distance, uint8_t energy, uint8_t stateFrames = 1);	//Turn on change detection: deadbands in cm and energy points, frames a new target state must last
+		void onChange(ld2410_frame_callback callback, void *context = nullptr);			//Data frames whose snapshot.changed is not 0
+		uint16_t takeChanges();											//LD2410_CHANGED_* bits gathered since the last call, then cleared
 		bool requestFirmwareVersion();									//Request the firmware version
 		uint8_t firmware_major_version = 0;								//Reported major version
 		uint8_t firmware_minor_version = 0;								//Reported minor version
@@ -68,64 +245,186 @@ class ld2410	{
 		bool requestEndEngineeringMode();
 		bool setMaxValues(uint16_t moving, uint16_t stationary, uint16_t inactivityTimer);	//Realistically gate values are 0-8 but sent as uint16_t
 		bool setGateSensitivityThreshold(uint8_t gate, uint8_t moving, uint8_t stationary);
-    	FrameData getFrameData() const;
-		bool isAutoReadTaskRunning();									//True iff autoReadTask() succeeded and the task hasn't been stopped (always false on non-ESP32)
+		bool requestMacAddress();										//Request the Bluetooth MAC address
+		uint8_t mac_address[6] = {0,0,0,0,0,0};							//Reported MAC address, most significant byte first
+		bool requestDistanceResolution();								//Request the distance covered by each gate
+		bool setDistanceResolution(uint8_t resolution);					//0 for 0.75m per gate, 1 for 0.2m; applied after a restart. False for other values
+		uint8_t distance_resolution = 0;								//Reported resolution index (Table 8): 0 = 0.75m per gate, 1 = 0.2m
+		bool setBaudRate(uint32_t baud);								//9600 to 460800 (§2.2.9); applied after a restart. False for other rates
+		uint32_t detectBaudRate(ld2410_baud_hook reconfigure, void *context = nullptr, uint32_t timeoutMs = LD2410_BAUD_DETECT_MS, const uint32_t *candidates = nullptr, uint8_t count = 0);	//The rate data frames arrive at, or 0
+    	FrameData getFrameData();										//The last data frame parsed; {nullptr, 0} while a task parses unless keepFrameData() is on
+		void keepFrameData(bool keep = true);							//Copy every data frame as it is parsed, so getFrameData() works beside autoReadTask
+		bool isAutoReadTaskRunning();									//True while an autoReadTask, this sensor's or its scheduler's, or a running ld2410_reactor is parsing it
 #if defined(ESP32)
 		bool autoReadTask(uint32_t stack = 4096, UBaseType_t priority = 1, BaseType_t core = tskNO_AFFINITY);
 		void stopAutoReadTask();
 #endif
 
 	protected:
+		ld2410_base(uint8_t *ring, uint16_t ringSize, uint8_t *frame, uint16_t frameSize);	//Storage from ld2410_t
+
 	private:
+		ld2410_base(const ld2410_base &);
+		ld2410_base &operator=(const ld2410_base &);
+		friend class ld2410_scheduler;
+		friend class ld2410_reactor;
 		Stream *radar_uart_ = nullptr;
 		Stream *debug_uart_ = nullptr;									//The stream used for the debugging
 		uint32_t radar_uart_timeout = 100;								//How long to give up on receiving some useful data from the LD2410
 		uint32_t radar_uart_last_packet_ = 0;							//Time of the last packet from the radar
 		uint32_t radar_uart_command_timeout_ = 100;						//Timeout for sending commands
+		ld2410_wake_source *wake_source_ = nullptr;						//nullptr: waitAndRead() polls every LD2410_POLL_INTERVAL_MS
 		uint8_t latest_ack_ = 0;
 		bool latest_command_success_ = false;
-		uint8_t radar_data_frame_[LD2410_MAX_FRAME_LENGTH];				//Store the incoming data from the radar, to check it's in a valid format
-		uint8_t radar_data_frame_position_ = 0;							//Where in the frame we are currently writing; 0 means no frame in progress
-		bool ack_frame_ = false;										//Whether the incoming frame is LIKELY an ACK frame
-		bool waiting_for_ack_ = false;									//Whether a command has just been sent
-		uint8_t target_type_ = 0;
-		uint16_t moving_target_distance_ = 0;
-		uint8_t moving_target_energy_ = 0;
-		uint16_t stationary_target_distance_ = 0;
-		uint8_t stationary_target_energy_ = 0;
+		uint8_t *radar_data_frame_;										//Copy of the last data frame, filled when getFrameData() asks or keepFrameData() is on
+		const uint16_t max_frame_length_;								//Size of radar_data_frame_; longer frames are rejected
+		FrameView frame_;												//The frame being parsed, still in the ring
+		bool ack_frame_ = false;										//Whether the frame being parsed is an ACK frame
+		uint32_t raw_frame_position_ = 0;								//Ring read position (ring_.read_position()) of the last valid data frame
+		ld2410_atomic<bool> keep_frame_data_{false};					//Set by keepFrameData(); the parser copies each data frame
+		ld2410_atomic<uint16_t> kept_frame_length_{0};					//Length of the frame the parser last copied, 0 for none
+		RadarSnapshot snapshot_;										//Latest target data, written only inside a snapshot_seq_ write section
+		ld2410_seqlock snapshot_seq_;									//Odd while parse_data_frame_() is writing snapshot_
+		enum stat_ : uint8_t {											//Index into stats_, in RadarStats order
+			STAT_DATA_FRAMES, STAT_ENGINEERING_FRAMES, STAT_ACK_FRAMES, STAT_UNKNOWN_ACKS, STAT_INVALID_FRAMES,
+			STAT_HEADER_RESYNCS, STAT_BAD_LENGTHS, STAT_FOOTER_MISMATCHES, STAT_BYTES_DISCARDED,
+			STAT_BUFFER_OVERRUNS, STAT_BYTES_DROPPED, STAT_COUNT
+		};
+		ld2410_atomic<uint32_t> stats_[STAT_COUNT] = {};				//Free-running; each one has a single writer, ingestion or the parser
+		uint32_t stats_base_[STAT_COUNT] = {};							//stats_ at the last resetStats()
+		void count_(stat_ stat, uint32_t n = 1) {						//Single writer, so a relaxed load and store rather than a locked add
+			stats_[stat].store(stats_[stat].load(ld2410_relaxed) + n, ld2410_relaxed);
+		}
+		ld2410_atomic<uint32_t> high_water_{0};						//Written by ingestion only, like the counters
+		ld2410_atomic<uint8_t> high_water_epoch_{0};					//Bumped by resetStats(); ingestion restarts high_water_ when it sees a new one
+		ld2410_atomic<uint8_t> high_water_seen_{0};					//The epoch high_water_ belongs to
+		void note_high_water_(uint32_t waiting);
+		ld2410_overflow_policy overflow_policy_ = LD2410_OVERFLOW_DROP_OLDEST;
+		uint16_t whole_frames_to_drop_(uint32_t needed) const;
+		void capture_chunk_(const uint8_t *data, uint16_t length);
+		ld2410_history *history_ = nullptr;								//Optional record of past frames
+		ld2410_gate_window *gate_window_ = nullptr;						//Optional per-gate energy statistics
+		ld2410_background *background_ = nullptr;						//Optional per-gate background model
+		Print *capture_ = nullptr;										//Optional raw UART log
+		uint32_t capture_last_us_ = 0;									//micros() of the last chunk logged
+		ld2410_scheduler *scheduler_ = nullptr;							//Set while an ld2410_scheduler services this sensor
+		ld2410_reactor *reactor_ = nullptr;								//Set while an ld2410_reactor services this sensor (Linux)
+		ld2410_frame_callback data_frame_callback_ = nullptr;
+		void *data_frame_context_ = nullptr;
+		ld2410_frame_callback engineering_frame_callback_ = nullptr;
+		void *engineering_frame_context_ = nullptr;
+		ld2410_ack_callback ack_callback_ = nullptr;
+		void *ack_context_ = nullptr;
+		ld2410_event_callback connection_lost_callback_ = nullptr;
+		void *connection_lost_context_ = nullptr;
+		bool connection_up_ = false;									//A valid frame has arrived since the connection lost callback last fired
+		ld2410_frame_callback change_callback_ = nullptr;
+		void *change_context_ = nullptr;
+		bool change_detection_ = false;									//Set by setChangeThresholds() or onChange()
+		RadarSnapshot reported_;										//Values as of the last change reported for each field
+		uint16_t change_distance_ = 10;									//Deadband for distances, cm
+		uint8_t change_energy_ = 5;										//Deadband for energies
+		uint8_t change_state_frames_ = 1;								//Frames a new target state has to last before it is reported
+		uint8_t pending_state_ = 0;										//Target state waiting out change_state_frames_
+		uint8_t pending_state_frames_ = 0;
+		ld2410_atomic<uint16_t> changes_{0};							//Bits for takeChanges()
     	uint16_t last_valid_frame_length = 0;
-		uint16_t detection_distance_ = 0;
-		uint8_t engineering_motion_energy_[9] = {0,0,0,0,0,0,0,0,0};
-		uint8_t engineering_stationary_energy_[9] = {0,0,0,0,0,0,0,0,0};
 		bool engineering_data_received_ = false;
+		ld2410_atomic<uint8_t> engineering_mode_{LD2410_ENGINEERING_UNKNOWN};	//ld2410_engineering_mode, written by the parser
 		uint8_t cmd_seq_ = 0;											//Monotonic counter; bumped before each command issue
 		uint8_t cmd_ack_seq_ = 0;										//Mirrored by parser when an ACK matches expected_ack_opcode_
 		uint8_t expected_ack_opcode_ = 0;								//Set by command issuer; checked by parse_command_frame_
+		struct command_job_ {
+			ld2410_atomic<uint8_t> status{LD2410_COMMAND_UNKNOWN};		//ld2410_command_status, or free/claimed while the slot is not in use
+			ld2410_atomic<uint16_t> handle{0};
+			ld2410_command command;
+			ld2410_transaction *transaction = nullptr;					//Runs these commands instead of command when set
+			ld2410_command_callback callback = nullptr;
+			void *context = nullptr;
+			ld2410_atomic<bool> waited{false};							//A blocking call is polling the handle, so the result is not recycled
+		};
+		command_job_ command_jobs_[LD2410_COMMAND_QUEUE_LENGTH];		//Filled by any thread, run by whichever context parses frames
+		ld2410_atomic<uint16_t> next_command_handle_{1};
+		uint16_t last_started_handle_ = 0;								//Queue order is handle order, counted from here
+		uint8_t command_state_ = 0;										//Engine state, see service_commands_()
+		int8_t command_active_ = -1;									//Slot of the running command
+		uint8_t command_index_ = 0;										//Position within the running transaction
+		uint8_t command_result_ = LD2410_COMMAND_UNKNOWN;				//Outcome of the running command so far
+		uint32_t command_since_ = 0;									//millis() when the engine entered command_state_
 #if defined(ESP32)
 		TaskHandle_t taskHandle_ = nullptr;
-		portMUX_TYPE data_mux_ = portMUX_INITIALIZER_UNLOCKED;
 #endif
 
-		uint8_t circular_buffer[LD2410_BUFFER_SIZE];
-        uint16_t buffer_head = 0;
-        uint16_t buffer_tail = 0;
+		ld2410_ring ring_;												//SPSC ring over ld2410_t's storage: ingestion produces, read_frame_() consumes
+		ld2410_atomic<bool> rx_muted_{false};							//Set across the reboot window after a restart; ingestion discards UART bytes while it is set
 
-		void add_to_buffer(uint8_t byte);
-		bool read_from_buffer(uint8_t &byte);
+		uint16_t ingest_uart_(uint16_t limit = 0xFFFF);					//Bulk-copy what the UART has ready, up to limit bytes, into the ring
+		uint16_t uart_read_(uint8_t *buffer, uint16_t length);			//readBytes() where it is a bulk copy, read() per byte elsewhere
+		void drain_uart_();												//Empty the ring and discard what the UART has ready, capture still sees it
 		bool check_frame_end_();
 		
 		bool read_frame_();		
+		void frame_parsed_(bool ok);									//Run the callbacks for the frame just parsed
+		void check_connection_();										//Fire the connection lost callback once the line has gone quiet
 		bool parse_data_frame_();										//Is the current data frame valid?
+		uint16_t detect_changes_();										//Compare snapshot_ with reported_, return LD2410_CHANGED_* bits
 		bool parse_command_frame_();									//Is the current command frame valid?
+		struct ack_handler_ {
+			uint8_t opcode;												//Command word the ACK answers
+			uint8_t length;												//Expected intra-frame data length
+			void (*decode)(ld2410_base &sensor);								//Decodes the returned value, nullptr for status-only ACKs
+			const char *label;											//PROGMEM, for debug output
+		};
+		static const ack_handler_ ack_handlers_[];						//In PROGMEM
+		static const uint8_t ack_handler_count_;
+		static const uint8_t ack_handler_index_[48];					//Opcode -> ack_handlers_ row, in PROGMEM
+		static constexpr uint8_t ack_handler_row_(uint8_t opcode, uint8_t row);
+		static constexpr bool ack_handlers_indexed_(uint8_t row);
+		template <void (ld2410_base::*Decoder)()>
+		static void decode_(ld2410_base &sensor) { (sensor.*Decoder)(); }	//Plain function pointer for the table, a member pointer would double the row size
+		void decode_configuration_();									//0x61
+		void decode_firmware_version_();								//0xA0
+		void decode_mac_address_();										//0xA5
+		void decode_distance_resolution_();								//0xAB
+		void decode_engineering_on_();									//0x62
+		void decode_engineering_off_();									//0x63, and 0xA3 as the radar restarts with it off
 		void begin_command_(uint8_t expected_op);						//Bump cmd_seq_, reset stale state, set expected ACK opcode
-		bool wait_for_ack_(uint8_t expected_op, uint32_t timeout_ms);	//Block until matching ACK arrives or timeout
+		bool command_acked_(bool &success);								//Has the ACK for the last command sent arrived?
+		void send_command_(const ld2410_command &command);				//Encode one command frame and write it in one go
+		void service_commands_();										//Step the command engine as far as it can go without blocking
+		void finish_command_();											//Publish the running command's result and free the engine
+		int8_t next_queued_command_();									//Oldest queued slot, or -1
+		const ld2410_command &active_command_() const;					//The command of the running job currently in its window
+		static void firmware_queried_(ld2410_base &sensor, ld2410_command_handle, ld2410_command_status status, void *);	//Callback of passive startup's firmware query
+		ld2410_command_handle queue_job_(const ld2410_command &command, ld2410_transaction *transaction, ld2410_command_callback callback, void *context, bool waited = false);
+		bool wait_for_job_(ld2410_command_handle handle);				//Block until a queued job has finished; true if it succeeded
+		bool run_command_(const ld2410_command &command);				//Queue a command and block until it has finished
+		bool listen_for_frame_(uint32_t timeoutMs, uint32_t junkLimit);	//Does a valid data frame arrive within timeoutMs, before junkLimit bytes (0 for no limit) are discarded?
 		void print_frame_();											//Print the frame for debugging
-		void send_command_preamble_();									//Commands have the same preamble
-		void send_command_postamble_();									//Commands have the same postamble
-		bool enter_configuration_mode_();								//Necessary before sending any command
-		bool leave_configuration_mode_();								//Will not read values without leaving command mode
 #if defined(ESP32)
 		static void taskFunction(void* param);
 #endif
 };
+
+// A sensor with RingSize bytes of receive buffer that accepts frames of up to
+// FrameSize bytes. LD2410_MIN_FRAME_LENGTH is enough for basic mode; take
+// LD2410_MAX_FRAME_LENGTH or at least 45 for engineering mode, whose frames
+// are otherwise dropped as bad lengths. The ring wraps with a mask, so its
+// size is a power of two, and it must hold a whole frame.
+template <uint16_t RingSize, uint16_t FrameSize>
+class ld2410_t : public ld2410_base	{
+
+	public:
+		ld2410_t() : ld2410_base(ring_storage_, RingSize, frame_storage_, FrameSize) {}
+
+	private:
+		static_assert(RingSize > 0 && (RingSize & (RingSize - 1)) == 0, "the ld2410_t ring size must be a power of two");
+		static_assert(RingSize <= 32768, "the ld2410_t ring size must fit the uint16_t ring indices");
+		static_assert(FrameSize >= LD2410_MIN_FRAME_LENGTH, "the ld2410_t frame size must be at least LD2410_MIN_FRAME_LENGTH");
+		static_assert(FrameSize <= RingSize, "the ld2410_t ring must hold a whole frame");
+		uint8_t ring_storage_[RingSize];
+		uint8_t frame_storage_[FrameSize];
+};
+
+typedef ld2410_t<LD2410_BUFFER_SIZE, LD2410_MAX_FRAME_LENGTH> ld2410;	//The default sensor
 #endif
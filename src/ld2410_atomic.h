@@ -0,0 +1,97 @@
+/*
+ *	Minimal atomics shim for the ld2410 library.
+ *
+ *	Everywhere except AVR this is std::atomic. avr-libc has no <atomic>, but AVR
+ *	sketches run the library from a single thread of execution and never from
+ *	an ISR, so a volatile value behind the same load()/store() interface gives
+ *	the same guarantees there. ld2410_seqlock builds the library's one
+ *	single-writer sequence lock on top of it.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_atomic_h
+#define ld2410_atomic_h
+#include <Arduino.h>
+#include <stdint.h>
+
+#if defined(__AVR__)
+typedef uint8_t ld2410_memory_order;
+static const ld2410_memory_order ld2410_relaxed = 0;
+static const ld2410_memory_order ld2410_acquire = 1;
+static const ld2410_memory_order ld2410_release = 2;
+static const ld2410_memory_order ld2410_acq_rel = 3;
+
+template <typename T>
+class ld2410_atomic {
+	public:
+		ld2410_atomic(T value = T()) : value_(value) {}
+		T load(ld2410_memory_order = ld2410_relaxed) const { return value_; }
+		void store(T value, ld2410_memory_order = ld2410_relaxed) { value_ = value; }
+		T exchange(T value, ld2410_memory_order = ld2410_relaxed) { T previous = value_; value_ = value; return previous; }
+		T fetch_add(T value, ld2410_memory_order = ld2410_relaxed) { T previous = value_; value_ = previous + value; return previous; }
+		T fetch_or(T value, ld2410_memory_order = ld2410_relaxed) { T previous = value_; value_ = previous | value; return previous; }
+		bool compare_exchange_strong(T &expected, T desired, ld2410_memory_order = ld2410_relaxed) {
+			if (value_ != expected) { expected = value_; return false; }
+			value_ = desired;
+			return true;
+		}
+	private:
+		ld2410_atomic(const ld2410_atomic &);
+		ld2410_atomic &operator=(const ld2410_atomic &);
+		volatile T value_;
+};
+
+inline void ld2410_fence(ld2410_memory_order) { asm volatile("" ::: "memory"); }
+#else
+#include <atomic>
+typedef std::memory_order ld2410_memory_order;
+static const ld2410_memory_order ld2410_relaxed = std::memory_order_relaxed;
+static const ld2410_memory_order ld2410_acquire = std::memory_order_acquire;
+static const ld2410_memory_order ld2410_release = std::memory_order_release;
+static const ld2410_memory_order ld2410_acq_rel = std::memory_order_acq_rel;
+
+template <typename T>
+using ld2410_atomic = std::atomic<T>;
+
+inline void ld2410_fence(ld2410_memory_order order) { std::atomic_thread_fence(order); }
+#endif
+
+// Single-writer sequence lock. The counter is odd while the writer updates
+// the data it guards, so a reader that copied the data across an update can
+// tell the copy may be torn and go again; the writer never waits for a
+// reader. A reader only retries while a write is actually in progress, and
+// read_begin() yields meanwhile so an equal-priority writer sharing the
+// reader's core can finish.
+//
+//	lock.begin_write(); ...update... lock.end_write();
+//	uint32_t seq; do { seq = lock.read_begin(); ...copy... } while (lock.read_retry(seq));
+class ld2410_seqlock {
+	public:
+		void begin_write() {
+			seq_.store(seq_.load(ld2410_relaxed) + 1, ld2410_relaxed);
+			ld2410_fence(ld2410_release);								//Counter odd before any data changes
+		}
+		void end_write() {
+			seq_.store(seq_.load(ld2410_relaxed) + 1, ld2410_release);	//Data changes visible before the counter is even again
+		}
+		uint32_t read_begin() const {									//Waits out a write in progress
+			for (;;) {
+				const uint32_t seq = seq_.load(ld2410_acquire);
+				if ((seq & 1) == 0) {
+					return seq;
+				}
+				yield();
+			}
+		}
+		bool read_retry(uint32_t seq) const {							//True if a write overlapped the copy since read_begin()
+			ld2410_fence(ld2410_acquire);								//The copy is complete before the counter is checked
+			return seq_.load(ld2410_relaxed) != seq;
+		}
+
+	private:
+		ld2410_atomic<uint32_t> seq_{0};
+};
+#endif
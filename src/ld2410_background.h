@@ -0,0 +1,154 @@
+/*
+ *	Adaptive per-gate background model for the ld2410 library.
+ *
+ *	Fans, curtains and radiators show up as a steady energy in a few gates.
+ *	Rather than raising those gates' sensitivity thresholds on the radar, an
+ *	ld2410_background learns each gate's background level from the
+ *	engineering frames and reports only the energy above it:
+ *
+ *		ld2410_background background;
+ *		radar.setBackground(background);
+ *		radar.requestStartEngineeringMode();
+ *		...
+ *		if (background.presenceDetected()) ...
+ *
+ *	The background of each gate is an exponentially weighted moving average
+ *	kept in fixed point, energy * 128 in a uint16_t, so an update is a
+ *	subtraction, a shift and an addition in 16 bits, cheap enough for AVR.
+ *	A gate whose energy falls follows it down with a weight of 1/2^fall; one
+ *	whose energy rises follows it up with the much smaller 1/2^rise, so clutter
+ *	that appears is absorbed over minutes while a person standing still is
+ *	not. The first engineering frame after setBackground() or reset() is
+ *	taken as the background outright.
+ *
+ *	It is updated by the parser, in the same pass as the frame is decoded;
+ *	basic frames carry no per-gate energies and are skipped. state() may be
+ *	called from any thread and, like getSnapshot(), never returns a mix of
+ *	two frames.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_background_h
+#define ld2410_background_h
+#include "ld2410.h"
+
+#define LD2410_BACKGROUND_FRACTION_BITS 7								//Background levels are energy << 7: 255 << 7 still fits an int16_t
+#ifndef LD2410_BACKGROUND_THRESHOLD
+#define LD2410_BACKGROUND_THRESHOLD 15									//Energy above background that counts as presence
+#endif
+#ifndef LD2410_BACKGROUND_FALL_SHIFT
+#define LD2410_BACKGROUND_FALL_SHIFT 3									//Weight 1/8 for a falling energy, about 8 frames to follow
+#endif
+#ifndef LD2410_BACKGROUND_RISE_SHIFT
+#define LD2410_BACKGROUND_RISE_SHIFT 10									//Weight 1/1024 for a rising one, about 1024 frames
+#endif
+
+struct ld2410_background_state {
+	uint32_t frames = 0;											//Engineering frames learned from since setBackground() or reset()
+	bool presence = false;											//Some gate is more than the threshold above its background
+	uint8_t moving_background[9] = {0,0,0,0,0,0,0,0,0};			//Learned level of each gate's motion energy
+	uint8_t stationary_background[9] = {0,0,0,0,0,0,0,0,0};
+	uint8_t moving_excess[9] = {0,0,0,0,0,0,0,0,0};				//Latest motion energy above background, 0 if below
+	uint8_t stationary_excess[9] = {0,0,0,0,0,0,0,0,0};
+};
+
+class ld2410_background	{
+
+	public:
+		ld2410_background() {}
+		// Presence is any gate's energy more than threshold above its
+		// background. A smaller fall or rise adapts faster; both are
+		// shifts, 0-14.
+		void configure(uint8_t threshold, uint8_t fall = LD2410_BACKGROUND_FALL_SHIFT, uint8_t rise = LD2410_BACKGROUND_RISE_SHIFT) {
+			threshold_ = threshold;
+			fall_ = fall > 14 ? 14 : fall;
+			rise_ = rise > 14 ? 14 : rise;
+		}
+		void reset() {													//Learn the background afresh from the next frame
+			reset_.store(true, ld2410_release);
+		}
+		bool presenceDetected() const {
+			return presence_.load(ld2410_relaxed);
+		}
+		// Copies out the model as of the latest engineering frame. False,
+		// with state left alone, until one has been learned from.
+		bool state(ld2410_background_state &state) const {
+			ld2410_background_state copy;
+			uint32_t seq;
+			do {
+				seq = seq_.read_begin();
+				copy.frames = frames_;
+				if (copy.frames == 0) {
+					return false;
+				}
+				copy.presence = presence_.load(ld2410_relaxed);
+				for (uint8_t gate = 0; gate < 9; gate++) {
+					copy.moving_background[gate] = level_(background_[gate]);
+					copy.stationary_background[gate] = level_(background_[9 + gate]);
+					copy.moving_excess[gate] = excess_[gate];
+					copy.stationary_excess[gate] = excess_[9 + gate];
+				}
+			} while (seq_.read_retry(seq));
+			state = copy;
+			return true;
+		}
+
+	private:
+		friend class ld2410_base;
+		ld2410_background(const ld2410_background &);
+		ld2410_background &operator=(const ld2410_background &);
+
+		static uint8_t level_(uint16_t background) {					//Rounded to the nearest energy
+			return (uint8_t)((background + (1 << (LD2410_BACKGROUND_FRACTION_BITS - 1))) >> LD2410_BACKGROUND_FRACTION_BITS);
+		}
+		void update_(const RadarSnapshot &snapshot) {					//Parser only, engineering frames, same write section as snapshot_
+			seq_.begin_write();
+			if (reset_.exchange(false, ld2410_acquire)) {
+				frames_ = 0;
+			}
+			bool presence = false;
+			for (uint8_t i = 0; i < 18; i++) {
+				const uint8_t energy = i < 9 ? snapshot.moving_gate_energy[i] : snapshot.stationary_gate_energy[i - 9];
+				const int16_t sample = (int16_t)((uint16_t)energy << LD2410_BACKGROUND_FRACTION_BITS);
+				if (frames_ == 0) {
+					background_[i] = (uint16_t)sample;
+				} else {
+					// A rise too small to survive the shift still moves the
+					// background up a step (a fall always does, the shift
+					// rounding down), so it never stalls short of the sample.
+					const int16_t difference = sample - (int16_t)background_[i];
+					background_[i] = (uint16_t)((int16_t)background_[i] + (difference >> (difference < 0 ? fall_ : rise_)));
+					if (difference > 0 && (difference >> rise_) == 0) {
+						background_[i]++;
+					}
+				}
+				const uint8_t level = level_(background_[i]);
+				excess_[i] = energy > level ? energy - level : 0;
+				presence = presence || excess_[i] > threshold_;
+			}
+			frames_++;
+			presence_.store(presence, ld2410_relaxed);
+			seq_.end_write();
+		}
+		void clear_() {
+			seq_.begin_write();
+			frames_ = 0;
+			reset_.store(false, ld2410_relaxed);
+			presence_.store(false, ld2410_relaxed);
+			seq_.end_write();
+		}
+
+		uint16_t background_[18] = {};									//Motion gates 0-8 then stationary, energy << LD2410_BACKGROUND_FRACTION_BITS
+		uint8_t excess_[18] = {};
+		uint32_t frames_ = 0;
+		uint8_t threshold_ = LD2410_BACKGROUND_THRESHOLD;
+		uint8_t fall_ = LD2410_BACKGROUND_FALL_SHIFT;
+		uint8_t rise_ = LD2410_BACKGROUND_RISE_SHIFT;
+		ld2410_atomic<bool> presence_{false};
+		ld2410_atomic<bool> reset_{false};								//Set by reset(), taken by the parser
+		ld2410_seqlock seq_;											//Odd while update_() or clear_() is writing
+};
+#endif
@@ -0,0 +1,252 @@
+/*
+ *	Automatic gate sensitivity calibration for the ld2410 library.
+ *
+ *	Measures an empty room and sets every gate's motion and stationary
+ *	threshold just above what the room shows on its own:
+ *
+ *		ld2410_calibration calibration;
+ *		calibration.start(radar, 30000);				//30s, with the room empty
+ *		while (!calibration.finished()) {
+ *			calibration.step();
+ *		}
+ *		const ld2410_calibration_report &report = calibration.report();
+ *
+ *	It reads the current thresholds and turns engineering mode on in one
+ *	configuration window, records every gate's energy for the duration, then
+ *	writes all nine gates and reads the configuration back in a second
+ *	window. Engineering mode is turned off again unless it was already on,
+ *	which the sensor's engineeringMode() knows from the last data frame or
+ *	start/end engineering mode ACK; start() fails until it knows.
+ *	Nothing blocks: step() advances through the phases using queued commands,
+ *	so loop() keeps running, or call run() to wait for the whole thing.
+ *
+ *	Each gate's new threshold is the highest energy recorded or the mean
+ *	plus three standard deviations, whichever is higher, plus the margin,
+ *	capped at 100. Gates 0 and 1 have no stationary threshold the protocol
+ *	lets you set, so theirs is written back unchanged. The report has the
+ *	statistics, the old and new thresholds and which gates changed; once
+ *	applied, the new thresholds are the ones read back from the radar. With
+ *	apply set to false the thresholds are only computed, for a dry run.
+ *
+ *	Without an autoReadTask, step() calls read() itself and looks at every
+ *	frame. With one it samples getSnapshot() instead, so step() should be
+ *	called at least as often as frames arrive for every frame to count.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_calibration_h
+#define ld2410_calibration_h
+#include "ld2410.h"
+#include "ld2410_gates.h"
+#include <math.h>
+
+#ifndef LD2410_CALIBRATION_MS
+#define LD2410_CALIBRATION_MS 30000										//Default recording time
+#endif
+#ifndef LD2410_CALIBRATION_MARGIN
+#define LD2410_CALIBRATION_MARGIN 10									//Default energy added above what the empty room showed
+#endif
+#define LD2410_CALIBRATION_MAX_FRAMES 65535								//Recording stops early here, so the sums of squares cannot overflow
+
+enum ld2410_calibration_status : uint8_t {
+	LD2410_CALIBRATION_IDLE = 0,									//Not started
+	LD2410_CALIBRATION_PREPARING,									//Reading the thresholds and starting engineering mode
+	LD2410_CALIBRATION_RECORDING,									//Measuring the room
+	LD2410_CALIBRATION_WRITING,										//Writing the new thresholds, or just ending engineering mode
+	LD2410_CALIBRATION_SUCCEEDED,
+	LD2410_CALIBRATION_FAILED,										//A configuration window failed; see report().failed_command
+	LD2410_CALIBRATION_NO_FRAMES									//No engineering frames arrived while recording
+};
+
+struct ld2410_calibration_report {
+	uint32_t frames = 0;											//Engineering frames recorded
+	ld2410_gate_stats moving;										//The empty room's per-gate motion energy
+	ld2410_gate_stats stationary;
+	uint8_t old_moving[9] = {0,0,0,0,0,0,0,0,0};					//Thresholds before calibration
+	uint8_t old_stationary[9] = {0,0,0,0,0,0,0,0,0};
+	uint8_t new_moving[9] = {0,0,0,0,0,0,0,0,0};					//Thresholds computed, or as read back if applied
+	uint8_t new_stationary[9] = {0,0,0,0,0,0,0,0,0};
+	uint16_t changed_gates = 0;										//Bit n set if gate n's motion or stationary threshold changed
+	bool applied = false;											//The new thresholds were written and read back
+	int8_t failed_command = -1;										//Transaction index of the command that failed, or -1
+};
+
+class ld2410_calibration	{
+
+	public:
+		ld2410_calibration() {}
+		// Start calibrating, after the sensor's begin(). False if a
+		// calibration is already running, the commands cannot be queued or
+		// it is not yet known whether engineering mode is on, which takes a
+		// data frame or a start/end engineering mode ACK.
+		bool start(ld2410_base &sensor, uint32_t durationMs = LD2410_CALIBRATION_MS, uint8_t margin = LD2410_CALIBRATION_MARGIN, bool apply = true) {
+			if (!finished() || sensor.engineeringMode() == LD2410_ENGINEERING_UNKNOWN) {
+				return false;
+			}
+			sensor_ = &sensor;
+			duration_ = durationMs;
+			margin_ = margin;
+			apply_ = apply;
+			report_ = ld2410_calibration_report();
+			totals_.clear();
+			was_engineering_ = sensor.engineeringMode() == LD2410_ENGINEERING_ON;
+			transaction_.begin();
+			transaction_.append(ld2410_command::requestCurrentConfiguration());
+			if (!was_engineering_) {
+				transaction_.append(ld2410_command::requestStartEngineeringMode());
+			}
+			return queue_(LD2410_CALIBRATION_PREPARING);
+		}
+		// Advance as far as possible without blocking. Returns true once
+		// the calibration has finished, successfully or not.
+		bool step() {
+			switch (status_) {
+				case LD2410_CALIBRATION_PREPARING:
+				case LD2410_CALIBRATION_WRITING:
+					read_();
+					window_done_();
+					break;
+				case LD2410_CALIBRATION_RECORDING:
+					read_();
+					if (millis() - since_ >= duration_ || report_.frames >= LD2410_CALIBRATION_MAX_FRAMES) {
+						finish_recording_();
+					}
+					break;
+				default:
+					break;
+			}
+			return finished();
+		}
+		// step() until finished; true if it succeeded. Blocks for the whole
+		// recording time.
+		bool run() {
+			while (!step()) {
+				yield();
+			}
+			return status_ == LD2410_CALIBRATION_SUCCEEDED;
+		}
+		bool finished() const {
+			return status_ == LD2410_CALIBRATION_IDLE || status_ >= LD2410_CALIBRATION_SUCCEEDED;
+		}
+		ld2410_calibration_status status() const { return status_; }
+		const ld2410_calibration_report &report() const { return report_; }
+
+	private:
+		ld2410_calibration(const ld2410_calibration &);
+		ld2410_calibration &operator=(const ld2410_calibration &);
+
+		bool queue_(ld2410_calibration_status next) {
+			handle_ = sensor_->queueTransaction(transaction_);
+			status_ = handle_ != 0 ? next : LD2410_CALIBRATION_FAILED;
+			return handle_ != 0;
+		}
+		// Parse what has arrived, or with a reader task running look at the
+		// latest frame, and record any new engineering frame.
+		void read_() {
+			if (sensor_->isAutoReadTaskRunning()) {
+				sample_();
+				return;
+			}
+			while (sensor_->read()) {
+				sample_();
+			}
+		}
+		void sample_() {
+			if (status_ != LD2410_CALIBRATION_RECORDING) {
+				return;
+			}
+			const RadarSnapshot snapshot = sensor_->getSnapshot();
+			if (snapshot.sequence == last_sequence_ || !snapshot.engineering || report_.frames >= LD2410_CALIBRATION_MAX_FRAMES) {
+				return;
+			}
+			last_sequence_ = snapshot.sequence;
+			totals_.add(snapshot);
+			report_.frames++;
+		}
+		void window_done_() {
+			const ld2410_command_status result = sensor_->commandStatus(handle_);
+			if (result == LD2410_COMMAND_QUEUED || result == LD2410_COMMAND_RUNNING) {
+				return;
+			}
+			report_.failed_command = transaction_.firstFailure();
+			if (result != LD2410_COMMAND_SUCCEEDED) {
+				status_ = LD2410_CALIBRATION_FAILED;
+				return;
+			}
+			if (status_ == LD2410_CALIBRATION_PREPARING) {
+				memcpy(report_.old_moving, sensor_->motion_sensitivity, 9);
+				memcpy(report_.old_stationary, sensor_->stationary_sensitivity, 9);
+				last_sequence_ = sensor_->getSnapshot().sequence;		//Only frames from now on
+				since_ = millis();
+				status_ = LD2410_CALIBRATION_RECORDING;
+			} else {
+				report_.applied = report_.frames > 0 && apply_;
+				if (report_.applied) {
+					set_new_(sensor_->motion_sensitivity, sensor_->stationary_sensitivity);
+				}
+				status_ = report_.frames > 0 ? LD2410_CALIBRATION_SUCCEEDED : LD2410_CALIBRATION_NO_FRAMES;
+			}
+		}
+		void finish_recording_() {
+			if (report_.frames > 0) {
+				totals_.fill(report_.moving, report_.stationary);
+				uint8_t moving[9], stationary[9];
+				for (uint8_t gate = 0; gate < 9; gate++) {
+					moving[gate] = threshold_(report_.moving, gate);
+					stationary[gate] = gate < 2 ? report_.old_stationary[gate] : threshold_(report_.stationary, gate);
+				}
+				set_new_(moving, stationary);
+			}
+			transaction_.begin();
+			if (report_.frames > 0 && apply_) {
+				for (uint8_t gate = 0; gate < 9; gate++) {
+					transaction_.append(ld2410_command::setGateSensitivityThreshold(gate, report_.new_moving[gate], report_.new_stationary[gate]));
+				}
+				transaction_.append(ld2410_command::requestCurrentConfiguration());
+			}
+			if (!was_engineering_) {
+				transaction_.append(ld2410_command::requestEndEngineeringMode());
+			}
+			if (transaction_.size() > 0) {
+				queue_(LD2410_CALIBRATION_WRITING);
+			} else {
+				status_ = report_.frames > 0 ? LD2410_CALIBRATION_SUCCEEDED : LD2410_CALIBRATION_NO_FRAMES;
+			}
+		}
+		void set_new_(const uint8_t *moving, const uint8_t *stationary) {
+			memcpy(report_.new_moving, moving, 9);
+			memcpy(report_.new_stationary, stationary, 9);
+			report_.changed_gates = 0;
+			for (uint8_t gate = 0; gate < 9; gate++) {
+				if (moving[gate] != report_.old_moving[gate] || stationary[gate] != report_.old_stationary[gate]) {
+					report_.changed_gates |= (uint16_t)(1 << gate);
+				}
+			}
+		}
+		uint8_t threshold_(const ld2410_gate_stats &stats, uint8_t gate) const {
+			const float spread_limit = stats.mean[gate] + 3.0f * sqrtf(stats.variance[gate]);
+			uint16_t level = stats.max[gate];
+			if (spread_limit > level) {
+				level = (uint16_t)ceilf(spread_limit);
+			}
+			level += margin_;
+			return level > 100 ? 100 : (uint8_t)level;
+		}
+
+		ld2410_base *sensor_ = nullptr;
+		ld2410_calibration_status status_ = LD2410_CALIBRATION_IDLE;
+		ld2410_calibration_report report_;
+		ld2410_transaction transaction_;								//The configuration window in progress; must outlive it
+		ld2410_command_handle handle_ = 0;
+		uint32_t duration_ = 0;
+		uint32_t since_ = 0;											//millis() when recording started
+		uint32_t last_sequence_ = 0;									//RadarSnapshot::sequence of the last frame looked at
+		ld2410_gate_totals totals_;										//Of the frames recorded
+		uint8_t margin_ = LD2410_CALIBRATION_MARGIN;
+		bool apply_ = true;
+		bool was_engineering_ = false;									//Leave engineering mode on afterwards
+};
+#endif
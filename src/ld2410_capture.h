@@ -0,0 +1,70 @@
+/*
+ *	Raw UART capture for the ld2410 library.
+ *
+ *	startCapture() tees every byte the library ingests from the radar into a
+ *	compact binary log on any Print, such as an SD card File, and
+ *	ld2410_replay_stream (ld2410_replay.h) plays a log back as a Stream, so a
+ *	field problem can be reproduced, or a parser benchmarked, on exactly the
+ *	same bytes and timing:
+ *
+ *		radar.startCapture(logFile);		//In the field
+ *
+ *		ld2410_replay_stream replay;		//At the bench
+ *		replay.begin(log, logLength, 10);	//Ten times the original speed
+ *		radar.begin(replay, false);
+ *		while (!replay.done()) radar.waitAndRead(0);
+ *
+ *	The log starts with a 12 byte header:
+ *
+ *		0	"LDCP"								magic
+ *		4	LD2410_CAPTURE_FORMAT				format version
+ *		5	firmware_major_version				as known when the capture started,
+ *		6	firmware_minor_version				zero if it had not been asked for
+ *		7	0									reserved
+ *		8	firmware_bugfix_version				uint32_t, little endian
+ *
+ *	followed by one chunk per UART read: the microseconds since the previous
+ *	chunk (since the start of the capture for the first), the number of bytes,
+ *	both as LEB128 varints, then the bytes themselves. A chunk of one 23 byte
+ *	frame costs 2 to 4 bytes of overhead.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_capture_h
+#define ld2410_capture_h
+#include <Arduino.h>
+
+#define LD2410_CAPTURE_FORMAT 1
+#define LD2410_CAPTURE_HEADER_LENGTH 12
+#define LD2410_CAPTURE_MAX_CHUNK_HEADER 8								//5 bytes of uint32_t delta and 3 of uint16_t length
+
+// Writes a LEB128 varint into out, returning its length.
+inline uint8_t ld2410_capture_varint(uint32_t value, uint8_t *out) {
+	uint8_t length = 0;
+	while (value >= 0x80) {
+		out[length++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	out[length++] = (uint8_t)value;
+	return length;
+}
+
+inline void ld2410_capture_header(Print &sink, uint8_t major, uint8_t minor, uint32_t bugfix) {
+	const uint8_t header[LD2410_CAPTURE_HEADER_LENGTH] = {
+		'L', 'D', 'C', 'P', LD2410_CAPTURE_FORMAT, major, minor, 0,
+		(uint8_t)bugfix, (uint8_t)(bugfix >> 8), (uint8_t)(bugfix >> 16), (uint8_t)(bugfix >> 24)
+	};
+	sink.write(header, sizeof(header));
+}
+
+inline void ld2410_capture_chunk(Print &sink, uint32_t delta_us, const uint8_t *data, uint16_t length) {
+	uint8_t header[LD2410_CAPTURE_MAX_CHUNK_HEADER];
+	uint8_t used = ld2410_capture_varint(delta_us, header);
+	used += ld2410_capture_varint(length, header + used);
+	sink.write(header, used);
+	sink.write(data, length);
+}
+#endif
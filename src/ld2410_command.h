@@ -0,0 +1,158 @@
+/*
+ *	Command descriptors and completion types for the ld2410 asynchronous
+ *	command engine.
+ *
+ *	A command is described by its opcode and up to three 16-bit arguments; the
+ *	frame bytes are only produced when the engine sends it, so a queued command
+ *	costs eight bytes. The factories are constexpr, so fixed commands such as
+ *	enterConfigurationMode() fold to constants and their frames are encoded
+ *	from immediates. The static factories mirror the blocking request and set
+ *	methods of the ld2410 class.
+ *
+ *	An ld2410_transaction batches several commands so they are sent inside a
+ *	single enter/leave configuration window.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_command_h
+#define ld2410_command_h
+#include <stdint.h>
+
+#ifndef LD2410_MAX_TRANSACTION_COMMANDS
+#define LD2410_MAX_TRANSACTION_COMMANDS 12								//Nine gates, max values, a read-back and one spare
+#endif
+
+#define LD2410_MAX_COMMAND_FRAME_LENGTH 30									//Header, length, command word, three parameter/value pairs, footer
+
+class ld2410_base;
+
+typedef uint16_t ld2410_command_handle;								//0 is never issued: queueCommand() returns it on failure
+
+enum ld2410_command_status : uint8_t {
+	LD2410_COMMAND_UNKNOWN = 0,										//No such handle: never issued, already collected or recycled
+	LD2410_COMMAND_QUEUED,											//Waiting for the engine
+	LD2410_COMMAND_RUNNING,											//In its configuration mode window
+	LD2410_COMMAND_SUCCEEDED,										//The radar ACKed the command
+	LD2410_COMMAND_FAILED,											//The radar refused configuration mode or NAKed the command
+	LD2410_COMMAND_TIMED_OUT,										//No ACK within the command timeout
+	LD2410_COMMAND_SKIPPED,											//Not sent: an earlier command of its transaction failed or restarted the radar
+};
+
+// Called from whichever context drives the engine (read(), waitAndRead() or
+// the autoReadTask) once the command has left configuration mode again.
+// Fields decoded from the ACK, such as firmware_major_version, are already
+// updated. Keep it short, and do not call the blocking request/set methods
+// from it.
+typedef void (*ld2410_command_callback)(ld2410_base &sensor, ld2410_command_handle handle, ld2410_command_status status, void *context);
+
+struct ld2410_command {
+	uint8_t opcode;													//Command word, low byte (the high byte is always 0x00)
+	uint8_t argc;													//Number of arguments in use
+	uint16_t args[3];
+
+	constexpr ld2410_command(uint8_t op = 0, uint8_t count = 0, uint16_t a0 = 0, uint16_t a1 = 0, uint16_t a2 = 0)
+		: opcode(op), argc(count), args{a0, a1, a2} {}
+	static constexpr ld2410_command make(uint8_t opcode, uint8_t argc = 0, uint16_t a0 = 0, uint16_t a1 = 0, uint16_t a2 = 0) {
+		return ld2410_command(opcode, argc, a0, a1, a2);
+	}
+	static constexpr ld2410_command enterConfigurationMode() { return make(0xFF, 1, 0x0001); }
+	static constexpr ld2410_command leaveConfigurationMode() { return make(0xFE); }
+	static constexpr ld2410_command setMaxValues(uint16_t moving, uint16_t stationary, uint16_t inactivityTimer) { return make(0x60, 3, moving, stationary, inactivityTimer); }
+	static constexpr ld2410_command requestCurrentConfiguration() { return make(0x61); }
+	static constexpr ld2410_command requestStartEngineeringMode() { return make(0x62); }
+	static constexpr ld2410_command requestEndEngineeringMode() { return make(0x63); }
+	static constexpr ld2410_command setGateSensitivityThreshold(uint8_t gate, uint8_t moving, uint8_t stationary) { return make(0x64, 3, gate, moving, stationary); }
+	static constexpr ld2410_command requestFirmwareVersion() { return make(0xA0); }
+	static constexpr ld2410_command requestFactoryReset() { return make(0xA2); }
+	static constexpr ld2410_command requestRestart() { return make(0xA3); }
+	static constexpr ld2410_command requestMacAddress() { return make(0xA5, 1, 0x0001); }
+	static constexpr ld2410_command setDistanceResolution(uint8_t resolution) { return make(0xAA, 1, resolution); }	//0 or 1, which ld2410::setDistanceResolution() checks
+	static constexpr ld2410_command requestDistanceResolution() { return make(0xAB); }
+	static constexpr ld2410_command setBaudRate(uint8_t index) { return make(0xA1, 1, index); }	//Index from baud_index(); applied after a restart
+	static constexpr uint8_t baud_index(uint32_t baud) {				//§2.2.9 index of a baud rate, 0 if the radar does not support it
+		return baud == 9600 ? 1 : baud == 19200 ? 2 : baud == 38400 ? 3 : baud == 57600 ? 4 :
+			baud == 115200 ? 5 : baud == 230400 ? 6 : baud == 256000 ? 7 : baud == 460800 ? 8 : 0;
+	}
+
+	constexpr bool parameter_words() const {						//0x60 and 0x64 send each argument as a word + 32-bit value pair
+		return opcode == 0x60 || opcode == 0x64;
+	}
+	constexpr uint16_t payload_length() const {						//Intra-frame length: command word plus arguments
+		return (uint16_t)(2 + argc * (parameter_words() ? 6 : 2));
+	}
+	constexpr uint8_t frame_length() const {						//Header, length, payload and footer
+		return (uint8_t)(4 + 2 + payload_length() + 4);
+	}
+	// Writes the complete frame into frame[], which must hold
+	// LD2410_MAX_COMMAND_FRAME_LENGTH bytes, and returns its length, so the
+	// whole command can go to the UART in a single write().
+	uint8_t encode(uint8_t *frame) const {
+		uint8_t *out = frame;
+		*out++ = 0xFD; *out++ = 0xFC; *out++ = 0xFB; *out++ = 0xFA;		//Header
+		const uint16_t length = payload_length();
+		*out++ = (uint8_t)(length & 0x00FF);							//Intra-frame length
+		*out++ = (uint8_t)(length >> 8);
+		*out++ = opcode;												//Command word
+		*out++ = 0x00;
+		for (uint8_t i = 0; i < argc; i++) {
+			if (parameter_words()) {
+				*out++ = i;												//Parameter word
+				*out++ = 0x00;
+			}
+			*out++ = (uint8_t)(args[i] & 0x00FF);						//Value
+			*out++ = (uint8_t)(args[i] >> 8);
+			if (parameter_words()) {
+				*out++ = 0x00;											//Spacer
+				*out++ = 0x00;
+			}
+		}
+		*out++ = 0x04; *out++ = 0x03; *out++ = 0x02; *out++ = 0x01;		//Footer
+		return (uint8_t)(out - frame);
+	}
+};
+
+static_assert(ld2410_command::setMaxValues(0, 0, 0).frame_length() == LD2410_MAX_COMMAND_FRAME_LENGTH, "the longest command frame must fit LD2410_MAX_COMMAND_FRAME_LENGTH");
+static_assert(ld2410_command::baud_index(256000) == 7 && ld2410_command::baud_index(250000) == 0, "256000 is index 7, the factory default");
+static_assert(ld2410_command::enterConfigurationMode().frame_length() == 14, "enter configuration mode is FD FC FB FA 04 00 FF 00 01 00 04 03 02 01");
+
+// A batch of commands for ld2410::commitTransaction()/queueTransaction().
+// They are sent in order inside one configuration window; the first one that
+// fails or times out ends the window and the rest are reported as
+// LD2410_COMMAND_SKIPPED. A queued transaction is read and updated in place,
+// so it must stay alive, and unchanged, until it has finished.
+class ld2410_transaction {
+	public:
+		void begin() { count_ = 0; }									//Start a new, empty batch
+		bool append(const ld2410_command &command) {					//False if the batch is full
+			if (count_ >= LD2410_MAX_TRANSACTION_COMMANDS) {
+				return false;
+			}
+			commands_[count_] = command;
+			results_[count_] = LD2410_COMMAND_QUEUED;
+			count_++;
+			return true;
+		}
+		uint8_t size() const { return count_; }
+		const ld2410_command &command(uint8_t index) const { return commands_[index]; }
+		ld2410_command_status result(uint8_t index) const {			//Per-command outcome once the transaction has finished
+			return index < count_ ? results_[index] : LD2410_COMMAND_UNKNOWN;
+		}
+		int8_t firstFailure() const {									//Index of the command that ended the window early, or -1
+			for (uint8_t i = 0; i < count_; i++) {
+				if (results_[i] != LD2410_COMMAND_SUCCEEDED) {
+					return (int8_t)i;
+				}
+			}
+			return -1;
+		}
+
+	private:
+		friend class ld2410_base;
+		ld2410_command commands_[LD2410_MAX_TRANSACTION_COMMANDS];
+		ld2410_command_status results_[LD2410_MAX_TRANSACTION_COMMANDS];
+		uint8_t count_ = 0;
+};
+#endif
@@ -0,0 +1,213 @@
+/*
+ *	Windowed per-gate energy statistics for the ld2410 library.
+ *
+ *	An opt-in rolling window over the per-gate energies of the last N
+ *	engineering frames. Like ld2410_history the storage is a fixed array sized
+ *	by a template argument:
+ *
+ *		ld2410_gate_window_buffer<32> gates;
+ *		radar.setGateWindow(gates);
+ *		...
+ *		ld2410_gate_window_stats stats;
+ *		if (gates.stats(stats)) { stats.moving.mean[3] ... }
+ *
+ *	Each frame costs the parser the same whatever N is: the frame's energies
+ *	are stored over the oldest row and the per-gate sums and sums of squares
+ *	are adjusted by the difference, so mean and variance are exact integer
+ *	arithmetic with no drift. stats() finds the minimum and maximum by
+ *	scanning the window. Rows are LD2410_GATE_LANES bytes, motion energies
+ *	in lanes 0-8 and stationary in 16-24, and every kernel is a branch-free
+ *	loop over whole rows, so the compiler turns it into 16-byte vector
+ *	operations wherever the target has them (SSE2, NEON, ESP32-S3 PIE) and
+ *	the unused lanes, always 0, cost nothing extra.
+ *
+ *	Basic frames carry no per-gate energies and are not counted. stats() may
+ *	be called from any thread; like getSnapshot() it retries if a frame is
+ *	recorded while it reads.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_gates_h
+#define ld2410_gates_h
+#include "ld2410.h"
+
+#define LD2410_GATE_LANES 32											//Bytes per window row: two 16-byte vectors
+#define LD2410_GATE_STATIONARY_LANE 16									//Lane of stationary gate 0
+
+struct ld2410_gate_stats {
+	uint8_t min[9] = {0,0,0,0,0,0,0,0,0};
+	uint8_t max[9] = {0,0,0,0,0,0,0,0,0};
+	float mean[9] = {0,0,0,0,0,0,0,0,0};
+	float variance[9] = {0,0,0,0,0,0,0,0,0};						//Population variance over the window
+};
+
+struct ld2410_gate_window_stats {
+	uint16_t frames = 0;											//Engineering frames covered, up to capacity()
+	uint32_t newest = 0;											//RadarSnapshot::sequence of the latest of them
+	ld2410_gate_stats moving;										//Table 14 per-gate motion energy
+	ld2410_gate_stats stationary;									//Table 14 per-gate stationary energy
+};
+
+// Lane-wise minimum, maximum, sum and sum of squares of up to 65535 rows,
+// and the per-gate statistics they give. ld2410_gate_window keeps its sums
+// over a sliding window and finds the extremes when asked;
+// ld2410_calibration adds every frame of a recording with add().
+struct ld2410_gate_totals {
+	uint16_t frames = 0;
+	uint8_t low[LD2410_GATE_LANES];
+	uint8_t high[LD2410_GATE_LANES];
+	uint32_t sum[LD2410_GATE_LANES];
+	uint32_t sum_sq[LD2410_GATE_LANES];								//Fits: 255 * 255 * 65535 < 2^32
+
+	void clear() {
+		frames = 0;
+		memset(sum, 0, sizeof(sum));
+		memset(sum_sq, 0, sizeof(sum_sq));
+	}
+	// A snapshot's energies as a row: motion in lanes 0-8, stationary from
+	// LD2410_GATE_STATIONARY_LANE, the rest 0.
+	static void row(const RadarSnapshot &snapshot, uint8_t *row) {
+		memset(row, 0, LD2410_GATE_LANES);
+		memcpy(row, snapshot.moving_gate_energy, 9);
+		memcpy(row + LD2410_GATE_STATIONARY_LANE, snapshot.stationary_gate_energy, 9);
+	}
+	void add(const RadarSnapshot &snapshot) {						//At most 65535 of them, which the caller checks
+		uint8_t in[LD2410_GATE_LANES];
+		row(snapshot, in);
+		if (frames == 0) {
+			memcpy(low, in, LD2410_GATE_LANES);
+			memcpy(high, in, LD2410_GATE_LANES);
+		}
+		for (uint8_t lane = 0; lane < LD2410_GATE_LANES; lane++) {
+			low[lane] = in[lane] < low[lane] ? in[lane] : low[lane];
+			high[lane] = in[lane] > high[lane] ? in[lane] : high[lane];
+			sum[lane] += in[lane];
+			sum_sq[lane] += (uint32_t)in[lane] * in[lane];
+		}
+		frames++;
+	}
+	// Statistics for frames > 0.
+	void fill(ld2410_gate_stats &moving, ld2410_gate_stats &stationary) const {
+		fill_(moving, 0);
+		fill_(stationary, LD2410_GATE_STATIONARY_LANE);
+	}
+
+	private:
+		void fill_(ld2410_gate_stats &gates, uint8_t lane) const {
+			for (uint8_t gate = 0; gate < 9; gate++, lane++) {
+				gates.min[gate] = low[lane];
+				gates.max[gate] = high[lane];
+				gates.mean[gate] = (float)sum[lane] / frames;
+				// n*sum(x^2) - sum(x)^2 is exact in 64 bits, so the variance
+				// does not suffer the cancellation of E[x^2] - E[x]^2 in float.
+				const uint64_t spread = (uint64_t)frames * sum_sq[lane] - (uint64_t)sum[lane] * sum[lane];
+				gates.variance[gate] = (float)spread / ((float)frames * frames);
+			}
+		}
+};
+
+class ld2410_gate_window	{
+
+	public:
+		uint16_t capacity() const { return capacity_; }
+		// Statistics over the engineering frames in the window, the last
+		// capacity() of them or as many as have arrived since
+		// setGateWindow(). False, with stats left alone, if there are none.
+		bool stats(ld2410_gate_window_stats &stats) const {
+			ld2410_gate_totals totals;
+			uint32_t newest;
+			uint32_t seq;
+			do {
+				seq = seq_.read_begin();
+				totals.frames = frames_;
+				newest = newest_;
+				memcpy(totals.sum, sum_, sizeof(totals.sum));
+				memcpy(totals.sum_sq, sum_sq_, sizeof(totals.sum_sq));
+				if (totals.frames > 0) {
+					min_max_(rows_, totals.frames, totals.low, totals.high);
+				}
+			} while (seq_.read_retry(seq));
+			if (totals.frames == 0) {
+				return false;
+			}
+			stats.frames = totals.frames;
+			stats.newest = newest;
+			totals.fill(stats.moving, stats.stationary);
+			return true;
+		}
+
+	protected:
+		ld2410_gate_window(uint8_t (*rows)[LD2410_GATE_LANES], uint16_t capacity) : rows_(rows), capacity_(capacity) {}
+
+	private:
+		friend class ld2410_base;
+		ld2410_gate_window(const ld2410_gate_window &);
+		ld2410_gate_window &operator=(const ld2410_gate_window &);
+
+		// Lane-wise minimum and maximum of the first rows rows; which rows
+		// they are does not matter, so the ring order is ignored.
+		static void min_max_(const uint8_t (*rows)[LD2410_GATE_LANES], uint16_t count, uint8_t *low, uint8_t *high) {
+			memcpy(low, rows[0], LD2410_GATE_LANES);
+			memcpy(high, rows[0], LD2410_GATE_LANES);
+			for (uint16_t r = 1; r < count; r++) {
+				const uint8_t *row = rows[r];
+				for (uint8_t lane = 0; lane < LD2410_GATE_LANES; lane++) {
+					low[lane] = row[lane] < low[lane] ? row[lane] : low[lane];
+					high[lane] = row[lane] > high[lane] ? row[lane] : high[lane];
+				}
+			}
+		}
+		void clear_() {
+			seq_.begin_write();
+			frames_ = 0;
+			next_ = 0;
+			newest_ = 0;
+			memset(sum_, 0, sizeof(sum_));
+			memset(sum_sq_, 0, sizeof(sum_sq_));
+			seq_.end_write();
+		}
+		void record_(const RadarSnapshot &snapshot) {					//Parser only, engineering frames, same write section as snapshot_
+			seq_.begin_write();
+			uint8_t row[LD2410_GATE_LANES];
+			ld2410_gate_totals::row(snapshot, row);
+			uint8_t *slot = rows_[next_];
+			if (frames_ < capacity_) {
+				memset(slot, 0, LD2410_GATE_LANES);						//Nothing to take out yet
+				frames_++;
+			}
+			for (uint8_t lane = 0; lane < LD2410_GATE_LANES; lane++) {
+				const uint32_t in = row[lane];
+				const uint32_t out = slot[lane];
+				sum_[lane] += in - out;									//Wraps back into range, as the old value is part of the sum
+				sum_sq_[lane] += in * in - out * out;
+				slot[lane] = row[lane];
+			}
+			next_ = next_ + 1 == capacity_ ? 0 : next_ + 1;
+			newest_ = snapshot.sequence;
+			seq_.end_write();
+		}
+
+		uint8_t (*rows_)[LD2410_GATE_LANES];
+		uint16_t capacity_;
+		uint16_t frames_ = 0;											//Rows in use, up to capacity_
+		uint16_t next_ = 0;												//Row the next frame replaces
+		uint32_t newest_ = 0;
+		uint32_t sum_[LD2410_GATE_LANES] = {};							//Per lane over the rows in use
+		uint32_t sum_sq_[LD2410_GATE_LANES] = {};						//Fits: 255 * 255 * 65535 < 2^32
+		ld2410_seqlock seq_;											//Odd while record_() or clear_() is writing
+};
+
+template <uint16_t N>
+class ld2410_gate_window_buffer : public ld2410_gate_window	{
+
+	public:
+		ld2410_gate_window_buffer() : ld2410_gate_window(storage_, N) {}
+
+	private:
+		static_assert(N > 0, "an ld2410_gate_window_buffer needs at least one frame");
+		uint8_t storage_[N][LD2410_GATE_LANES];
+};
+#endif
@@ -0,0 +1,136 @@
+/*
+ *	Frame history for the ld2410 library.
+ *
+ *	An opt-in record of the last N data frames, each stamped with the millis()
+ *	it was parsed at. The storage is a fixed array sized by a template
+ *	argument, so nothing is ever allocated:
+ *
+ *		ld2410_history_buffer<32> history;
+ *		radar.setHistory(history);
+ *
+ *	Frames are numbered by RadarSnapshot::sequence and the frame with sequence
+ *	s always lives in slot s % N, so a consumer that remembers the last
+ *	sequence it has seen can catch up on everything newer with one since()
+ *	call instead of polling getSnapshot(). The parser never waits for a
+ *	reader: like getSnapshot(), the readers use a seqlock and retry if a frame
+ *	is recorded while they copy.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_history_h
+#define ld2410_history_h
+#include "ld2410.h"
+
+struct ld2410_history_entry {
+	uint32_t timestamp = 0;											//millis() when the frame was parsed
+	RadarSnapshot snapshot;											//snapshot.sequence numbers the frame
+};
+
+class ld2410_history	{
+
+	public:
+		uint16_t capacity() const { return capacity_; }
+		uint32_t newest() const {										//Sequence of the latest frame held, 0 if none
+			return newest_.load(ld2410_acquire);
+		}
+		uint32_t oldest() const {										//Sequence of the oldest frame still held, 0 if none
+			const uint32_t newest = newest_.load(ld2410_acquire);
+			if (newest == 0) {
+				return 0;
+			}
+			const uint32_t first = first_.load(ld2410_relaxed);
+			return newest - first >= capacity_ ? newest - capacity_ + 1 : first;
+		}
+		uint16_t size() const {											//Frames held, oldest() to newest() inclusive
+			const uint32_t newest = this->newest();
+			return newest == 0 ? 0 : (uint16_t)(newest - oldest() + 1);
+		}
+		// Copies out the frame with this sequence number. False if it has not
+		// arrived yet or has already been overwritten. Iterate the whole
+		// history with get() over oldest()..newest().
+		bool get(uint32_t sequence, ld2410_history_entry &entry) const {
+			if (sequence == 0) {
+				return false;
+			}
+			uint32_t seq;
+			do {
+				seq = seq_.read_begin();
+				if (sequence > newest_.load(ld2410_relaxed) || sequence < oldest()) {
+					return false;
+				}
+				entry = entries_[sequence % capacity_];
+			} while (seq_.read_retry(seq));
+			return entry.snapshot.sequence == sequence;
+		}
+		// Copies up to max frames newer than sequence into entries[], oldest
+		// first, and returns how many. Pass 0 to start from the oldest frame
+		// held, then the sequence of the last entry returned to catch up. If
+		// the consumer fell more than capacity() frames behind, the first
+		// entry's sequence is more than one past the one passed in.
+		uint16_t since(uint32_t sequence, ld2410_history_entry *entries, uint16_t max) const {
+			uint16_t count = 0;
+			uint32_t next = sequence + 1;
+			while (count < max) {
+				const uint32_t oldest = this->oldest();
+				if (oldest == 0) {
+					break;
+				}
+				if (next < oldest) {
+					next = oldest;											//Overwritten before it was read
+				}
+				if (next > newest()) {
+					break;
+				}
+				if (get(next, entries[count])) {
+					count++;
+					next++;
+				}
+			}
+			return count;
+		}
+
+	protected:
+		ld2410_history(ld2410_history_entry *entries, uint16_t capacity) : entries_(entries), capacity_(capacity) {}
+
+	private:
+		friend class ld2410_base;
+		ld2410_history(const ld2410_history &);
+		ld2410_history &operator=(const ld2410_history &);
+
+		void clear_() {
+			newest_.store(0, ld2410_release);
+			first_.store(0, ld2410_relaxed);
+		}
+		void record_(const RadarSnapshot &snapshot, uint32_t timestamp) {	//Parser only, same write section as snapshot_
+			seq_.begin_write();
+			ld2410_history_entry &entry = entries_[snapshot.sequence % capacity_];
+			entry.timestamp = timestamp;
+			entry.snapshot = snapshot;
+			if (newest_.load(ld2410_relaxed) == 0) {
+				first_.store(snapshot.sequence, ld2410_relaxed);
+			}
+			newest_.store(snapshot.sequence, ld2410_release);
+			seq_.end_write();
+		}
+
+		ld2410_history_entry *entries_;
+		uint16_t capacity_;
+		ld2410_seqlock seq_;											//Odd while record_() is writing
+		ld2410_atomic<uint32_t> newest_{0};
+		ld2410_atomic<uint32_t> first_{0};								//First sequence recorded since setHistory()
+};
+
+template <uint16_t N>
+class ld2410_history_buffer : public ld2410_history	{
+
+	public:
+		ld2410_history_buffer() : ld2410_history(storage_, N) {}
+
+	private:
+		static_assert(N > 0, "an ld2410_history_buffer needs at least one entry");
+		ld2410_history_entry storage_[N];
+};
+#endif
@@ -0,0 +1,298 @@
+/*
+ *	Linux gateway support: a termios serial Stream and an epoll reactor.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410_linux.h"
+#if defined(__linux__) && !defined(ARDUINO)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+// The kernel's termios2 rather than <termios.h>: BOTHER takes any baud rate,
+// where cfsetspeed() only knows the B* constants and 256000 is not one of
+// them. The two headers cannot be included together, which is why this lives
+// here and not in ld2410_linux.h.
+#include <asm/termbits.h>
+
+bool ld2410_linux_serial::begin(const char *path, uint32_t baud) {
+    end();
+    const int fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct termios2 tio;
+    if (::ioctl(fd, TCGETS2, &tio) != 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        return false;
+    }
+    // Raw 8N1, no flow control, and reads that return whatever is there
+    // (VMIN = VTIME = 0); the descriptor is non-blocking anyway.
+    tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF | IXANY);
+    tio.c_oflag &= ~OPOST;
+    tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS | CBAUD);
+    tio.c_cflag |= CS8 | CREAD | CLOCAL | BOTHER;
+    tio.c_ispeed = baud;
+    tio.c_ospeed = baud;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (::ioctl(fd, TCSETS2, &tio) != 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        return false;
+    }
+    ::ioctl(fd, TCFLSH, TCIOFLUSH);		// drop whatever queued up before the port was configured
+    fd_ = fd;
+    peeked_ = -1;
+    return true;
+}
+
+bool ld2410_linux_serial::setBaudRate(uint32_t baud) {
+    struct termios2 tio;
+    if (fd_ < 0 || ::ioctl(fd_, TCGETS2, &tio) != 0) {
+        return false;
+    }
+    tio.c_cflag &= ~CBAUD;
+    tio.c_cflag |= BOTHER;
+    tio.c_ispeed = baud;
+    tio.c_ospeed = baud;
+    if (::ioctl(fd_, TCSETS2, &tio) != 0) {
+        return false;
+    }
+    ::ioctl(fd_, TCFLSH, TCIFLUSH);		// bytes received at the old rate are junk
+    peeked_ = -1;
+    return true;
+}
+
+void ld2410_linux_serial::end() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    peeked_ = -1;
+}
+
+int ld2410_linux_serial::available() {
+    int queued = 0;
+    if (fd_ < 0 || ::ioctl(fd_, FIONREAD, &queued) != 0) {
+        queued = 0;
+    }
+    return queued + (peeked_ >= 0 ? 1 : 0);
+}
+
+int ld2410_linux_serial::read() {
+    uint8_t value;
+    return readBytes(&value, 1) == 1 ? value : -1;
+}
+
+int ld2410_linux_serial::peek() {
+    if (peeked_ < 0) {
+        uint8_t value;
+        if (fd_ >= 0 && ::read(fd_, &value, 1) == 1) {
+            peeked_ = value;
+        }
+    }
+    return peeked_;
+}
+
+size_t ld2410_linux_serial::readBytes(uint8_t *buf, size_t n) {
+    size_t got = 0;
+    if (n > 0 && peeked_ >= 0) {
+        buf[got++] = (uint8_t)peeked_;
+        peeked_ = -1;
+    }
+    while (got < n && fd_ >= 0) {
+        const ssize_t result = ::read(fd_, buf + got, n - got);
+        if (result > 0) {
+            got += (size_t)result;
+        } else if (result < 0 && errno == EINTR) {
+            continue;
+        } else {
+            break;		// EAGAIN: nothing more has arrived
+        }
+    }
+    return got;
+}
+
+size_t ld2410_linux_serial::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t ld2410_linux_serial::write(const uint8_t *buf, size_t n) {
+    size_t sent = 0;
+    while (sent < n && fd_ >= 0) {
+        const ssize_t result = ::write(fd_, buf + sent, n - sent);
+        if (result > 0) {
+            sent += (size_t)result;
+            continue;
+        }
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            break;
+        }
+        struct pollfd pfd = { fd_, POLLOUT, 0 };
+        if (::poll(&pfd, 1, LD2410_LINUX_WRITE_TIMEOUT_MS) <= 0) {
+            break;		// the transmit buffer did not drain in time
+        }
+    }
+    return sent;
+}
+
+ld2410_eventfd_wake_source::ld2410_eventfd_wake_source() : fd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+}
+
+ld2410_eventfd_wake_source::~ld2410_eventfd_wake_source() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+// The eventfd counter holds notifications until they are read, so one sent
+// before wait() is not lost; reading it resets the counter.
+bool ld2410_eventfd_wake_source::wait(uint32_t timeout_ms) {
+    struct pollfd pfd = { fd_, POLLIN, 0 };
+    const int timeout = timeout_ms > 0x7FFFFFFFUL ? -1 : (int)timeout_ms;
+    if (::poll(&pfd, 1, timeout) <= 0) {
+        return false;
+    }
+    uint64_t count;
+    return ::read(fd_, &count, sizeof(count)) == (ssize_t)sizeof(count);
+}
+
+void ld2410_eventfd_wake_source::notify() {
+    const uint64_t one = 1;
+    ssize_t result = ::write(fd_, &one, sizeof(one));
+    (void)result;		// EAGAIN only when the counter is saturated, which still wakes the waiter
+}
+
+ld2410_reactor::ld2410_reactor() : epoll_fd_(::epoll_create1(EPOLL_CLOEXEC)) {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;											// nullptr marks the wake-up eventfd
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_.fd(), &event);
+}
+
+ld2410_reactor::~ld2410_reactor() {
+    while (count_ > 0) {
+        remove(*sensors_[count_ - 1]);
+    }
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+    }
+}
+
+bool ld2410_reactor::add(ld2410_base &sensor, ld2410_linux_serial &serial) {
+    if (count_ >= LD2410_REACTOR_MAX_SENSORS || epoll_fd_ < 0 || !serial.isOpen() || sensor.radar_uart_ != &serial ||
+        sensor.reactor_ != nullptr || sensor.scheduler_ != nullptr || sensor.isAutoReadTaskRunning()) {
+        return false;
+    }
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = &sensor;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, serial.fd(), &event) != 0) {
+        return false;
+    }
+    sensors_[count_++] = &sensor;
+    sensor.reactor_ = this;
+    sensor.setWakeSource(wake_);
+    return true;
+}
+
+bool ld2410_reactor::remove(ld2410_base &sensor) {
+    for (uint16_t i = 0; i < count_; i++) {
+        if (sensors_[i] == &sensor) {
+            for (uint16_t j = i + 1; j < count_; j++) {
+                sensors_[j - 1] = sensors_[j];
+            }
+            count_--;
+            // The port may already be closed (and then has left the epoll
+            // set by itself), so a failure here is not an error.
+            const ld2410_linux_serial *serial = static_cast<const ld2410_linux_serial *>(sensor.radar_uart_);
+            if (serial->isOpen()) {
+                ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, serial->fd(), nullptr);
+            }
+            sensor.reactor_ = nullptr;
+            sensor.wake_source_ = nullptr;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Feeds at most LD2410_REACTOR_CHUNKS ring-sized chunks, so one chatty radar
+// cannot hold up the rest; the epoll set is level-triggered and reports
+// anything left over on the next poll().
+uint32_t ld2410_reactor::feed_(ld2410_base &sensor) {
+    uint32_t frames = 0;
+    for (uint8_t chunk = 0; chunk < LD2410_REACTOR_CHUNKS; chunk++) {
+        const uint16_t ingested = sensor.ingest_uart_((uint16_t)(sensor.ring_.size() - sensor.ring_.used()));
+        while (sensor.read_frame_()) {
+            frames++;
+        }
+        if (ingested == 0) {
+            break;
+        }
+    }
+    return frames;
+}
+
+uint32_t ld2410_reactor::poll(uint32_t timeoutMs) {
+    for (uint16_t i = 0; i < count_; i++) {
+        if (sensors_[i]->commandsPending() && timeoutMs > LD2410_POLL_INTERVAL_MS) {
+            timeoutMs = LD2410_POLL_INTERVAL_MS;
+        }
+    }
+    struct epoll_event events[16];
+    const int timeout = timeoutMs > 0x7FFFFFFFUL ? -1 : (int)timeoutMs;
+    const int ready = ::epoll_wait(epoll_fd_, events, sizeof(events) / sizeof(events[0]), timeout);
+    uint32_t frames = 0;
+    for (int i = 0; i < ready; i++) {
+        ld2410_base *sensor = static_cast<ld2410_base *>(events[i].data.ptr);
+        if (sensor == nullptr) {
+            wake_.wait(0);												// clear the eventfd; the engines are stepped below
+            continue;
+        }
+        frames += feed_(*sensor);
+        if ((events[i].events & (EPOLLHUP | EPOLLERR)) != 0 && sensor->radar_uart_->available() == 0) {
+            // The device went away (a USB-UART unplugged, the far end of a
+            // pty closed). Stop waiting on it, or every poll() would return
+            // at once; the sensor's onConnectionLost() callback reports it.
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, static_cast<ld2410_linux_serial *>(sensor->radar_uart_)->fd(), nullptr);
+        }
+    }
+    for (uint16_t i = 0; i < count_; i++) {
+        sensors_[i]->service_commands_();
+        sensors_[i]->check_connection_();
+    }
+    return frames;
+}
+
+// A stop() from before run() was called is stale, so it and its wake-up are
+// dropped: a reactor stopped while idle still runs the next time.
+void ld2410_reactor::run() {
+    wake_.wait(0);
+    stop_requested_.store(false, ld2410_relaxed);
+    running_.store(true, ld2410_release);
+    while (!stop_requested_.exchange(false, ld2410_acq_rel)) {
+        poll(LD2410_TASK_WAKE_TIMEOUT_MS);
+    }
+    running_.store(false, ld2410_release);
+}
+
+void ld2410_reactor::stop() {
+    stop_requested_.store(true, ld2410_release);
+    wake_.notify();
+}
+#endif
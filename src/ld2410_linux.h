@@ -0,0 +1,127 @@
+/*
+ *	Linux gateway support: a termios serial Stream and an epoll reactor.
+ *
+ *	ld2410_linux_serial opens a serial device (a USB-UART such as
+ *	/dev/ttyUSB0) raw and non-blocking, at any baud rate including the
+ *	LD2410's 256000, and is passed to ld2410::begin() like any other Stream.
+ *
+ *	ld2410_reactor drives many sensors from one thread. It epoll-waits on
+ *	every sensor's serial descriptor and, when one is readable, feeds the
+ *	bytes into that sensor in chunks no larger than its ring's free space,
+ *	parsing each chunk before taking the next. Bytes the radar sent while the
+ *	thread was busy stay in the kernel's buffer instead of overwriting the
+ *	ring.
+ *
+ *		ld2410_linux_serial port1, port2;
+ *		port1.begin("/dev/ttyUSB0");
+ *		port2.begin("/dev/ttyUSB1");
+ *		radar1.begin(port1, false);
+ *		radar2.begin(port2, false);
+ *		ld2410_reactor reactor;
+ *		reactor.add(radar1, port1);
+ *		reactor.add(radar2, port2);
+ *		reactor.run();						//Until reactor.stop() from another thread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_linux_h
+#define ld2410_linux_h
+#include "ld2410.h"
+#if defined(__linux__) && !defined(ARDUINO)
+
+#ifndef LD2410_REACTOR_MAX_SENSORS
+#define LD2410_REACTOR_MAX_SENSORS 64									//Sensors one reactor can hold
+#endif
+#ifndef LD2410_REACTOR_CHUNKS
+#define LD2410_REACTOR_CHUNKS 4											//Ring-sized chunks fed to one sensor per wake-up before moving on
+#endif
+#ifndef LD2410_LINUX_WRITE_TIMEOUT_MS
+#define LD2410_LINUX_WRITE_TIMEOUT_MS 100								//How long write() waits for room in the kernel's transmit buffer
+#endif
+
+// Raw 8N1 serial port, non-blocking in both directions: read(), peek() and
+// readBytes() return what has already arrived, never waiting for more.
+class ld2410_linux_serial : public Stream	{
+
+	public:
+		ld2410_linux_serial() {}
+		~ld2410_linux_serial() { end(); }
+		bool begin(const char *path, uint32_t baud = 256000);			//Open and configure the port; false (with errno set) on failure
+		void end();
+		bool setBaudRate(uint32_t baud);								//Change the rate of the open port, eg. from an ld2410_baud_hook
+		bool isOpen() const { return fd_ >= 0; }
+		int fd() const { return fd_; }
+		int available() override;
+		int read() override;
+		int peek() override;
+		size_t readBytes(uint8_t *buf, size_t n);						//Overrides Stream's where it is virtual, as in an ESP32-style Arduino.h
+		using Stream::readBytes;
+		size_t write(uint8_t value) override;
+		size_t write(const uint8_t *buf, size_t n) override;			//Waits up to LD2410_LINUX_WRITE_TIMEOUT_MS for the kernel to take it all
+		using Print::write;
+
+	private:
+		ld2410_linux_serial(const ld2410_linux_serial &);
+		ld2410_linux_serial &operator=(const ld2410_linux_serial &);
+
+		int fd_ = -1;
+		int peeked_ = -1;												//Byte taken by peek() and not yet read(), or -1
+};
+
+// Wake source backed by an eventfd, so it can sit in an epoll set next to
+// the serial descriptors. ld2410_reactor installs one on each of its sensors;
+// on its own it works like ld2410_condvar_wake_source.
+class ld2410_eventfd_wake_source : public ld2410_wake_source	{
+
+	public:
+		ld2410_eventfd_wake_source();
+		~ld2410_eventfd_wake_source();
+		bool wait(uint32_t timeout_ms) override;
+		void notify() override;
+		int fd() const { return fd_; }
+
+	private:
+		ld2410_eventfd_wake_source(const ld2410_eventfd_wake_source &);
+		ld2410_eventfd_wake_source &operator=(const ld2410_eventfd_wake_source &);
+
+		int fd_;
+};
+
+class ld2410_reactor	{
+
+	public:
+		ld2410_reactor();
+		~ld2410_reactor();
+		// Register a sensor whose begin() was given serial. False if the
+		// reactor is full, or the sensor already has a reactor, a scheduler
+		// or its own autoReadTask. Add and remove sensors while run() is not
+		// running.
+		bool add(ld2410_base &sensor, ld2410_linux_serial &serial);
+		bool remove(ld2410_base &sensor);
+		uint16_t size() const { return count_; }
+		// Wait up to timeoutMs for any sensor's port to become readable or a
+		// command to be queued, feed and parse what arrived, then step every
+		// command engine. The wait is capped at LD2410_POLL_INTERVAL_MS while
+		// any sensor has a command in flight. Returns the frames parsed.
+		uint32_t poll(uint32_t timeoutMs);
+		void run();														//poll() until stop()
+		void stop();													//Callable from any thread; only ends a run() already under way
+		bool isRunning() const { return running_.load(ld2410_acquire); }
+
+	private:
+		ld2410_reactor(const ld2410_reactor &);
+		ld2410_reactor &operator=(const ld2410_reactor &);
+		uint32_t feed_(ld2410_base &sensor);
+
+		int epoll_fd_;
+		ld2410_eventfd_wake_source wake_;								//Shared by every sensor: queueCommand() and stop() signal it
+		ld2410_base *sensors_[LD2410_REACTOR_MAX_SENSORS];
+		uint16_t count_ = 0;
+		ld2410_atomic<bool> running_{false};
+		ld2410_atomic<bool> stop_requested_{false};
+};
+#endif
+#endif
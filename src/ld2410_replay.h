@@ -0,0 +1,161 @@
+/*
+ *	Replay of raw UART captures for the ld2410 library.
+ *
+ *	ld2410_replay_stream plays back a log written by startCapture() (the
+ *	format is described in ld2410_capture.h) as a Stream, in place of the
+ *	radar's serial port:
+ *
+ *		ld2410_replay_stream replay;
+ *		replay.begin(log, logLength, 10);	//Ten times the original speed
+ *		radar.begin(replay, false);
+ *		while (!replay.done()) radar.waitAndRead(0);
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_replay_h
+#define ld2410_replay_h
+#include "ld2410_capture.h"
+
+#define LD2410_REPLAY_MAX_SPEED 0										//ld2410_replay_stream speed: no pacing at all
+
+// Plays a capture back from memory. Each chunk becomes readable once its
+// time has come, measured with micros() from the first call and divided by
+// speed: 1 is the original timing, 10 ten times faster and
+// LD2410_REPLAY_MAX_SPEED as fast as it is read. Chunks are released one at a
+// time, so available() never reports more than the radar's UART did when it
+// was captured. Commands written to it are discarded.
+class ld2410_replay_stream : public Stream	{
+
+	public:
+		// False, and nothing to read, if log is not a capture this version
+		// understands. The log is not copied and must outlive the stream.
+		bool begin(const uint8_t *log, size_t length, uint16_t speed = 1) {
+			log_ = log;
+			length_ = length;
+			speed_ = speed;
+			firmware_major_version = 0;
+			firmware_minor_version = 0;
+			firmware_bugfix_version = 0;
+			if (log == nullptr || length < LD2410_CAPTURE_HEADER_LENGTH || log[0] != 'L' || log[1] != 'D' ||
+				log[2] != 'C' || log[3] != 'P' || log[4] != LD2410_CAPTURE_FORMAT) {
+				length_ = 0;
+				rewind();
+				return false;
+			}
+			firmware_major_version = log[5];
+			firmware_minor_version = log[6];
+			firmware_bugfix_version = (uint32_t)log[8] | ((uint32_t)log[9] << 8) | ((uint32_t)log[10] << 16) | ((uint32_t)log[11] << 24);
+			rewind();
+			return true;
+		}
+		void rewind() {													//Play again from the first chunk; timing restarts too
+			position_ = length_ > 0 ? LD2410_CAPTURE_HEADER_LENGTH : 0;
+			chunk_left_ = 0;
+			pending_ = false;
+			started_ = false;
+			chunks_ = 0;
+		}
+		bool done() {													//Every byte of the log has been read
+			return chunk_left_ == 0 && !pending_ && !next_chunk_();
+		}
+		uint32_t chunks() const { return chunks_; }						//Chunks released so far
+		uint8_t firmware_major_version = 0;								//From the capture's header
+		uint8_t firmware_minor_version = 0;
+		uint32_t firmware_bugfix_version = 0;
+
+		int available() override {
+			if (chunk_left_ == 0) {
+				release_();
+			}
+			return (int)chunk_left_;
+		}
+		int read() override {
+			if (available() == 0) {
+				return -1;
+			}
+			chunk_left_--;
+			return log_[position_++];
+		}
+		int peek() override {
+			return available() == 0 ? -1 : log_[position_];
+		}
+		// Not an override: readBytes() is only virtual on some cores (ESP32,
+		// ESP8266). Elsewhere Stream's own readBytes() goes through read().
+		size_t readBytes(uint8_t *buf, size_t n) {						//Never past the end of the released chunk
+			const size_t take = n < (size_t)available() ? n : chunk_left_;
+			memcpy(buf, log_ + position_, take);
+			position_ += take;
+			chunk_left_ -= take;
+			return take;
+		}
+		using Stream::readBytes;
+		size_t write(uint8_t) override { return 1; }
+		size_t write(const uint8_t *, size_t n) override { return n; }
+		using Print::write;
+
+	private:
+		// Reads the next chunk's header, if there is one, into delta_ and
+		// pending_length_.
+		bool next_chunk_() {
+			if (pending_) {
+				return true;
+			}
+			size_t position = position_;
+			uint32_t delta, length;
+			if (!varint_(position, delta) || !varint_(position, length) || length == 0 || length > length_ - position) {
+				return false;												//End of the log, or a truncated last chunk
+			}
+			position_ = position;
+			delta_ = delta;
+			pending_length_ = length;
+			pending_ = true;
+			return true;
+		}
+		bool varint_(size_t &position, uint32_t &value) const {
+			value = 0;
+			for (uint8_t shift = 0; shift < 35 && position < length_; shift += 7) {
+				const uint8_t b = log_[position++];
+				value |= (uint32_t)(b & 0x7F) << shift;
+				if ((b & 0x80) == 0) {
+					return true;
+				}
+			}
+			return false;
+		}
+		void release_() {
+			if (!next_chunk_()) {
+				return;
+			}
+			const uint32_t now = micros();
+			if (!started_) {
+				started_ = true;
+				due_ = now;
+			}
+			if (speed_ != LD2410_REPLAY_MAX_SPEED) {
+				const uint32_t due = due_ + delta_ / speed_;
+				if ((int32_t)(now - due) < 0) {
+					return;												//Not yet
+				}
+				due_ = due;
+			}
+			chunk_left_ = pending_length_;
+			pending_ = false;
+			chunks_++;
+		}
+
+		const uint8_t *log_ = nullptr;
+		size_t length_ = 0;
+		size_t position_ = 0;											//Next byte of the log
+		size_t chunk_left_ = 0;											//Bytes of the released chunk not yet read
+		uint32_t pending_length_ = 0;									//Length of the chunk waiting for its time
+		uint32_t delta_ = 0;											//Its microseconds after the previous one
+		uint32_t due_ = 0;												//micros() the previous chunk was due at
+		uint32_t chunks_ = 0;
+		uint16_t speed_ = 1;
+		bool pending_ = false;											//delta_ and pending_length_ hold a parsed chunk header
+		bool started_ = false;
+};
+#endif
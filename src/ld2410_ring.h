@@ -0,0 +1,77 @@
+/*
+ *	Lock-free single-producer/single-consumer byte ring used to buffer the
+ *	LD2410 UART stream.
+ *
+ *	head_ and tail_ are free-running byte counts: the producer is the only
+ *	writer of head_, the consumer the only writer of tail_, and each publishes
+ *	with a release store that the other side reads with an acquire load. That
+ *	is all the synchronisation needed for one producer and one consumer to
+ *	share the ring from different threads or cores without a critical section.
+ *	Storage is supplied by the owner and must be a power of two in size, so an
+ *	index is a mask away from its count and all `size` bytes are usable.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_ring_h
+#define ld2410_ring_h
+#include <stdint.h>
+#include "ld2410_atomic.h"
+
+class ld2410_ring	{
+
+	public:
+		ld2410_ring(uint8_t *storage, uint16_t size) : storage_(storage), size_(size), mask_(size - 1) {}
+
+		// Producer side.
+		uint8_t *write_span(uint16_t &length) const {					//Contiguous free space at the head, up to the end of storage
+			const uint32_t head = head_.load(ld2410_relaxed);
+			const uint16_t free_space = size_ - (uint16_t)(head - tail_.load(ld2410_acquire));
+			const uint16_t to_end = size_ - (uint16_t)(head & mask_);
+			length = free_space < to_end ? free_space : to_end;
+			return storage_ + (head & mask_);
+		}
+		void commit(uint16_t count) {									//Publish `count` bytes written into the last write_span()
+			head_.store(head_.load(ld2410_relaxed) + count, ld2410_release);
+		}
+
+		// Consumer side.
+		uint16_t used() const {											//Bytes waiting to be consumed
+			return (uint16_t)(head_.load(ld2410_acquire) - tail_.load(ld2410_relaxed));
+		}
+		uint16_t tail_index() const {									//Storage index of the oldest unconsumed byte
+			return (uint16_t)(tail_.load(ld2410_relaxed) & mask_);
+		}
+		uint8_t peek(uint16_t offset) const {							//Byte `offset` places after the tail; offset must be < used()
+			return storage_[(tail_.load(ld2410_relaxed) + offset) & mask_];
+		}
+		const uint8_t *read_span(uint16_t &length) const {				//Contiguous unconsumed bytes at the tail, up to the end of storage
+			const uint32_t tail = tail_.load(ld2410_relaxed);
+			const uint16_t available = (uint16_t)(head_.load(ld2410_acquire) - tail);
+			const uint16_t to_end = size_ - (uint16_t)(tail & mask_);
+			length = available < to_end ? available : to_end;
+			return storage_ + (tail & mask_);
+		}
+		void consume(uint16_t count) {									//Release `count` bytes back to the producer
+			tail_.store(tail_.load(ld2410_relaxed) + count, ld2410_release);
+		}
+		void clear() {													//Drop everything published so far
+			tail_.store(head_.load(ld2410_acquire), ld2410_release);
+		}
+
+		// Either side.
+		uint32_t written() const { return head_.load(ld2410_acquire); }	//Bytes ever committed
+		uint32_t read_position() const { return tail_.load(ld2410_acquire); }	//Bytes ever consumed
+		uint16_t size() const { return size_; }
+		const uint8_t *storage() const { return storage_; }
+
+	private:
+		uint8_t *storage_;
+		uint16_t size_;
+		uint16_t mask_;
+		ld2410_atomic<uint32_t> head_{0};
+		ld2410_atomic<uint32_t> tail_{0};
+};
+#endif
@@ -0,0 +1,182 @@
+/*
+ *	Cooperative scheduler for several ld2410 sensors.
+ *
+ *	Instead of one autoReadTask (and its stack) per radar, register every
+ *	sensor with one ld2410_scheduler and service them all from a single task
+ *	or from loop():
+ *
+ *		ld2410_scheduler radars;
+ *		radars.add(radar1);
+ *		radars.add(radar2);
+ *		radars.autoReadTask();				//ESP32, or call radars.service() from loop()
+ *
+ *	Each pass first drains every UART into its sensor's ring, which is a
+ *	short copy, so no hardware FIFO overflows while frames are parsed. It
+ *	then parses one frame per sensor in turn until every ring is empty or
+ *	the time budget is spent. A pass that runs out of budget resumes with the
+ *	next sensor in line, so a busy radar cannot starve the others.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_scheduler_h
+#define ld2410_scheduler_h
+#include "ld2410.h"
+
+#ifndef LD2410_SCHEDULER_MAX_SENSORS
+#define LD2410_SCHEDULER_MAX_SENSORS 4									//Sensors one scheduler can hold
+#endif
+#ifndef LD2410_SCHEDULER_BUDGET_US
+#define LD2410_SCHEDULER_BUDGET_US 2000									//Default time budget for parsing in one service() pass
+#endif
+
+class ld2410_scheduler	{
+
+	public:
+		ld2410_scheduler() {}
+		~ld2410_scheduler() {
+#if defined(ESP32)
+			stopAutoReadTask();
+#endif
+			while (count_ > 0) {
+				remove(*sensors_[count_ - 1]);
+			}
+		}
+		// Register a sensor after its begin(). False if the scheduler is
+		// full, or the sensor already has a scheduler, an ld2410_reactor or
+		// its own autoReadTask. Add and remove sensors before the scheduler's task is
+		// started.
+		bool add(ld2410_base &sensor) {
+			if (count_ >= LD2410_SCHEDULER_MAX_SENSORS || sensor.scheduler_ != nullptr || sensor.reactor_ != nullptr || sensor.isAutoReadTaskRunning()) {
+				return false;
+			}
+			sensors_[count_++] = &sensor;
+			sensor.scheduler_ = this;
+			if (wake_source_ != nullptr) {
+				sensor.setWakeSource(*wake_source_);
+			}
+			return true;
+		}
+		bool remove(ld2410_base &sensor) {
+			for (uint8_t i = 0; i < count_; i++) {
+				if (sensors_[i] == &sensor) {
+					for (uint8_t j = i + 1; j < count_; j++) {
+						sensors_[j - 1] = sensors_[j];
+					}
+					count_--;
+					next_ = 0;
+					sensor.scheduler_ = nullptr;
+					return true;
+				}
+			}
+			return false;
+		}
+		uint8_t size() const { return count_; }
+		// One wake source for all of the sensors: every sensor's
+		// notifyDataAvailable() (call it from each UART's receive callback)
+		// and queueCommand() then wake the scheduler.
+		void setWakeSource(ld2410_wake_source &source) {
+			wake_source_ = &source;
+			for (uint8_t i = 0; i < count_; i++) {
+				sensors_[i]->setWakeSource(source);
+			}
+		}
+		// One pass over every sensor: drain the UARTs, parse frames round-robin
+		// for up to budgetUs, then step each command engine. True if any
+		// frame was parsed.
+		bool service(uint32_t budgetUs = LD2410_SCHEDULER_BUDGET_US) {
+			const uint32_t start = micros();
+			for (uint8_t i = 0; i < count_; i++) {
+				sensors_[i]->ingest_uart_();
+			}
+			bool parsed = false;
+			backlog_ = false;
+			uint8_t i = next_;
+			uint8_t idle = 0;											//Sensors in a row that had nothing to parse
+			while (idle < count_) {
+				if (sensors_[i]->read_frame_()) {
+					parsed = true;
+					idle = 0;
+				} else {
+					idle++;
+				}
+				i = (uint8_t)(i + 1 < count_ ? i + 1 : 0);
+				if (idle < count_ && micros() - start >= budgetUs) {
+					backlog_ = true;									//Frames may be left: the next pass starts with sensor i
+					break;
+				}
+			}
+			next_ = i;
+			for (uint8_t j = 0; j < count_; j++) {
+				sensors_[j]->service_commands_();
+				sensors_[j]->check_connection_();
+			}
+			return parsed;
+		}
+		// The scheduler's equivalent of ld2410::waitAndRead(): block on the
+		// wake source (or sleep LD2410_POLL_INTERVAL_MS) unless the last pass
+		// left frames behind, then service(). The wait is capped at
+		// LD2410_POLL_INTERVAL_MS while any sensor has a command in flight.
+		bool waitAndService(uint32_t timeoutMs, uint32_t budgetUs = LD2410_SCHEDULER_BUDGET_US) {
+			if (!backlog_) {
+				for (uint8_t i = 0; i < count_; i++) {
+					if (sensors_[i]->commandsPending() && timeoutMs > LD2410_POLL_INTERVAL_MS) {
+						timeoutMs = LD2410_POLL_INTERVAL_MS;
+					}
+				}
+				if (wake_source_ != nullptr) {
+					wake_source_->wait(timeoutMs);
+				} else {
+					delay(timeoutMs < LD2410_POLL_INTERVAL_MS ? timeoutMs : LD2410_POLL_INTERVAL_MS);
+				}
+			}
+			return service(budgetUs);
+		}
+		bool isAutoReadTaskRunning() {									//Always false on non-ESP32
+#if defined(ESP32)
+			return taskHandle_ != nullptr;
+#else
+			return false;
+#endif
+		}
+#if defined(ESP32)
+		bool autoReadTask(uint32_t stack = 4096, UBaseType_t priority = 1, BaseType_t core = tskNO_AFFINITY) {
+			if (taskHandle_ != nullptr) {
+				return true;
+			}
+			if (xTaskCreatePinnedToCore(taskFunction, "LD2410Sched", stack, this, priority, &taskHandle_, core) != pdPASS) {
+				taskHandle_ = nullptr;
+				return false;
+			}
+			return true;
+		}
+		void stopAutoReadTask() {
+			if (taskHandle_ != nullptr) {
+				vTaskDelete(taskHandle_);
+				taskHandle_ = nullptr;
+			}
+		}
+#endif
+
+	private:
+		ld2410_scheduler(const ld2410_scheduler &);
+		ld2410_scheduler &operator=(const ld2410_scheduler &);
+
+		ld2410_base *sensors_[LD2410_SCHEDULER_MAX_SENSORS];
+		uint8_t count_ = 0;
+		uint8_t next_ = 0;												//Sensor the next pass parses first
+		bool backlog_ = false;											//The last pass ran out of budget
+		ld2410_wake_source *wake_source_ = nullptr;
+#if defined(ESP32)
+		TaskHandle_t taskHandle_ = nullptr;
+		static void taskFunction(void *param) {
+			ld2410_scheduler *scheduler = static_cast<ld2410_scheduler *>(param);
+			for (;;) {
+				scheduler->waitAndService(LD2410_TASK_WAKE_TIMEOUT_MS);
+			}
+		}
+#endif
+};
+#endif
@@ -0,0 +1,116 @@
+/*
+ *	Wake-up sources for the ld2410 read loop.
+ *
+ *	ld2410::waitAndRead() (and so the autoReadTask loop) blocks on one of these
+ *	until UART data is reported, instead of sleeping a fixed interval. The
+ *	UART's receive callback calls notify(), or ld2410::notifyDataAvailable(),
+ *	which forwards to it. A notify() that lands before wait() is called must
+ *	not be lost: the next wait() returns straight away.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410_wake_h
+#define ld2410_wake_h
+#include <stdint.h>
+#include "ld2410_atomic.h"
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+#if !defined(ARDUINO)
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+class ld2410_wake_source	{
+
+	public:
+		virtual ~ld2410_wake_source() {}
+		virtual bool wait(uint32_t timeout_ms) = 0;						//Block until notify() or timeout; true if notified
+		virtual void notify() = 0;										//Wake the waiter; callable from any task
+};
+
+#if defined(ESP32)
+// FreeRTOS direct-to-task notification. notify() gives to the waiting task;
+// notifications are counted by the kernel, so one sent before the wait is not
+// lost. The task is known from the constructor or attach(), or else from its
+// first wait(); a notify() before then is latched and that wait() returns at
+// once. At worst a notify() racing the first wait() costs one spurious
+// wake-up later. On arduino-esp32 wire it to HardwareSerial::onReceive(),
+// whose callback runs in the UART event task.
+class ld2410_task_notify_wake_source : public ld2410_wake_source	{
+
+	public:
+		explicit ld2410_task_notify_wake_source(TaskHandle_t waiter = nullptr) : waiter_(waiter) {}
+		void attach(TaskHandle_t waiter) {								//The task that will call wait(), if known before it does
+			waiter_.store(waiter);
+		}
+		bool wait(uint32_t timeout_ms) override {
+			waiter_.store(xTaskGetCurrentTaskHandle());
+			if (pending_.exchange(false)) {
+				return true;
+			}
+			return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) > 0;
+		}
+		void notify() override {
+			TaskHandle_t waiter = waiter_for_notify_();
+			if (waiter != nullptr) {
+				xTaskNotifyGive(waiter);
+			}
+		}
+		void notifyFromISR() {											//For a raw UART interrupt handler
+			TaskHandle_t waiter = waiter_for_notify_();
+			if (waiter != nullptr) {
+				BaseType_t woken = pdFALSE;
+				vTaskNotifyGiveFromISR(waiter, &woken);
+				portYIELD_FROM_ISR(woken);
+			}
+		}
+
+	private:
+		// Sequentially consistent, so either wait() sees pending_ or this
+		// sees the handle wait() stored before looking.
+		TaskHandle_t waiter_for_notify_() {
+			TaskHandle_t waiter = waiter_.load();
+			if (waiter == nullptr) {
+				pending_.store(true);
+				waiter = waiter_.load();
+			}
+			return waiter;
+		}
+		ld2410_atomic<TaskHandle_t> waiter_;
+		ld2410_atomic<bool> pending_{false};							//A notify() that came before any task was known
+};
+#endif
+
+#if !defined(ARDUINO)
+// Condition-variable wake source for host builds (Linux gateways, tests).
+class ld2410_condvar_wake_source : public ld2410_wake_source	{
+
+	public:
+		bool wait(uint32_t timeout_ms) override {
+			std::unique_lock<std::mutex> lock(mutex_);
+			const bool notified = condition_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+				[this] { return pending_; });
+			pending_ = false;
+			return notified;
+		}
+		void notify() override {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				pending_ = true;
+			}
+			condition_.notify_one();
+		}
+
+	private:
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		bool pending_ = false;
+};
+#endif
+#endif
@@ -1,21 +1,36 @@
 // Minimal Arduino stub for host-side unit testing of ld2410.cpp.
 // Only exposes the surface that src/ld2410.cpp actually uses:
-//   Stream / Print interface, millis(), F() macro, yield(), HEX/DEC constants.
+//   Stream / Print interface (readBytes() as on the AVR and API cores unless
+//   LD2410_STUB_VIRTUAL_READBYTES is defined), millis(), micros(),
+//   F() macro and the PROGMEM accessors (flash is ordinary memory on the
+//   host), yield(), HEX/DEC constants.
 #pragma once
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
 
 #define HEX 16
 #define DEC 10
-#define F(s) (s)
-typedef const char* __FlashStringHelper;
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define memcpy_P memcpy
 
 typedef uint8_t byte;
 
+// A fake clock that advances one tick per call. Atomic so the threaded tests
+// can call it from several threads.
 inline unsigned long millis() {
-    static unsigned long t = 1;
+    static std::atomic<unsigned long> t(1);
+    return ++t;
+}
+
+// Same for micros(), on its own counter.
+inline unsigned long micros() {
+    static std::atomic<unsigned long> t(1);
     return ++t;
 }
 
@@ -25,7 +40,15 @@ inline void delay(unsigned long /*ms*/) {}
 class Print {
 public:
     virtual size_t write(uint8_t) { return 1; }
-    virtual size_t write(const uint8_t* /*buf*/, size_t n) { return n; }
+    // Same fallback as the Arduino core: one write() per byte.
+    virtual size_t write(const uint8_t* buf, size_t n) {
+        size_t i = 0;
+        for (; i < n; i++) {
+            if (write(buf[i]) == 0) break;
+        }
+        return i;
+    }
+    size_t print(const __FlashStringHelper*) { return 0; }
     size_t print(const char*) { return 0; }
     size_t print(char) { return 0; }
     size_t print(int, int = DEC) { return 0; }
@@ -45,5 +68,38 @@ public:
     virtual int available() = 0;
     virtual int read() = 0;
     virtual int peek() { return -1; }
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+#if defined(LD2410_STUB_VIRTUAL_READBYTES)
+    // As on ESP32 and ESP8266, where readBytes() is virtual and HardwareSerial
+    // overrides it with a bulk copy out of the driver's buffer, as the test
+    // mocks do. Build with -DLD2410_STUB_VIRTUAL_READBYTES to model those.
+#define LD2410_BULK_READBYTES
+    virtual size_t readBytes(uint8_t* buf, size_t n) {
+#else
+    // As in ArduinoCore-avr and ArduinoCore-API: not virtual, so a Stream
+    // cannot replace it, and every byte goes through timedRead(). This is the
+    // default, so a readBytes() marked override fails to build here as it
+    // would on those cores.
+    size_t readBytes(uint8_t* buf, size_t n) {
+#endif
+        size_t i = 0;
+        for (; i < n; i++) {
+            int c = timedRead();
+            if (c < 0) break;
+            buf[i] = (uint8_t)c;
+        }
+        return i;
+    }
+    size_t readBytes(char* buf, size_t n) { return readBytes((uint8_t*)buf, n); }
     virtual ~Stream() {}
+protected:
+    int timedRead() {
+        const unsigned long start = millis();
+        do {
+            const int c = read();
+            if (c >= 0) return c;
+        } while (millis() - start < _timeout);
+        return -1;
+    }
+    unsigned long _timeout = 1000;
 };
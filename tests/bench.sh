@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+# Build and run the host-side benchmarks.
+# Usage: bash tests/bench.sh [name ...]   (e.g. bash tests/bench.sh ingest)
+# With no arguments every tests/bench_*.cpp is built and run.
+# EXTRA_CXXFLAGS=-DLD2410_STUB_VIRTUAL_READBYTES models the ESP32/ESP8266 Stream
+# instead of the AVR/ArduinoCore-API one.
+set -euo pipefail
+
+HERE="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT="$(cd "$HERE/.." && pwd)"
+
+if [ "$#" -gt 0 ]; then
+    SOURCES=()
+    for name in "$@"; do SOURCES+=("$HERE/bench_$name.cpp"); done
+else
+    SOURCES=("$HERE"/bench_*.cpp)
+fi
+
+for src in "${SOURCES[@]}"; do
+    bin="${src%.cpp}"
+    g++ -std=c++17 -O2 -Wall -Wextra -pthread ${EXTRA_CXXFLAGS:-} \
+        -I"$HERE" \
+        -I"$ROOT/src" \
+        "$src" \
+        "$ROOT"/src/*.cpp \
+        -o "$bin"
+    "$bin"
+done
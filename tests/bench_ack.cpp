@@ -0,0 +1,86 @@
+// Host benchmark for ACK frame handling through the public read() API.
+//
+// Build & run:  bash tests/bench.sh ack   (from the repo root)
+//
+// A stream of back-to-back command ACKs, cycling through every ACK the
+// library decodes plus one it does not know, is fed in 64-byte bursts and
+// read() is called until all of them have been handled. Reported per ACK:
+// wall time, and TSC cycles where the host has a time-stamp counter
+// (fastest run). The last opcodes in the old if/else ladder paid for every
+// comparison before them; a table lookup costs the same for all of them.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "bench_common.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+static void add_ack(std::vector<uint8_t>& v, uint8_t op, std::initializer_list<uint8_t> value) {
+    const uint16_t length = (uint16_t)(4 + value.size());
+    const uint8_t head[] = {0xFD, 0xFC, 0xFB, 0xFA, (uint8_t)length, (uint8_t)(length >> 8), op, 0x01, 0x00, 0x00};
+    v.insert(v.end(), head, head + sizeof(head));
+    v.insert(v.end(), value.begin(), value.end());
+    v.insert(v.end(), {0x04, 0x03, 0x02, 0x01});
+}
+
+static std::vector<uint8_t> make_ack_cycle() {
+    std::vector<uint8_t> v;
+    add_ack(v, 0xFF, {0x01, 0x00, 0x40, 0x00});
+    add_ack(v, 0x60, {});
+    add_ack(v, 0x61, {0xAA, 0x08, 0x08, 0x08,
+                      0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+                      0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19,
+                      0x05, 0x00});
+    add_ack(v, 0x62, {});
+    add_ack(v, 0x64, {});
+    add_ack(v, 0xA0, {0x01, 0x00, 0x07, 0x01, 0x16, 0x15, 0x09, 0x22});
+    add_ack(v, 0xA2, {});
+    add_ack(v, 0xA3, {});
+    add_ack(v, 0xAB, {0x01, 0x00});
+    add_ack(v, 0xFE, {});
+    return v;
+}
+
+int main() {
+    const size_t cycles_per_run = 5000;
+    const size_t acks_per_cycle = 10;
+    const int reps = 11;
+    const std::vector<uint8_t> cycle = make_ack_cycle();
+    std::vector<uint8_t> line;
+    line.reserve(cycle.size() * cycles_per_run);
+    for (size_t i = 0; i < cycles_per_run; i++) line.insert(line.end(), cycle.begin(), cycle.end());
+    const size_t acks = cycles_per_run * acks_per_cycle;
+
+    BurstStream s;
+    size_t handled = 0;
+    uint64_t cycles = UINT64_MAX;
+    double ns = bench_median_ns(reps, [&] {
+        ld2410 radar;
+        radar.begin(s, false);
+        s.load(line, 64);
+        handled = 0;
+#if BENCH_HAVE_TSC
+        uint64_t c0 = __rdtsc();
+#endif
+        while (!s.done()) {
+            s.tick();
+            while (radar.read()) handled++;
+        }
+        while (radar.read()) handled++;
+#if BENCH_HAVE_TSC
+        cycles = std::min<uint64_t>(cycles, __rdtsc() - c0);
+#endif
+        bench_keep(radar);
+    });
+
+    bench_report("ack", "ns_per_ack", ns / acks, "ns");
+#if BENCH_HAVE_TSC
+    bench_report("ack", "cycles_per_ack", (double)cycles / acks, "cycles");
+#endif
+    if (handled < acks) {
+        std::fprintf(stderr, "ack: handled only %zu of %zu ACKs\n", handled, acks);
+    }
+    return 0;
+}
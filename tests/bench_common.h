@@ -0,0 +1,93 @@
+// Shared helpers for the host-side benchmarks (tests/bench_*.cpp).
+//
+// Every benchmark prints one tab-separated line per measurement:
+//   <benchmark>\t<metric>\t<value>\t<unit>
+// so runs can be diffed or loaded into a spreadsheet without scraping.
+#pragma once
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static inline uint64_t bench_now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Runs `fn` `reps` times and returns the median wall time of one run in ns.
+// The median keeps a single descheduled run from skewing the result.
+template <typename F>
+static double bench_median_ns(int reps, F fn) {
+    std::vector<uint64_t> samples;
+    samples.reserve(reps);
+    for (int i = 0; i < reps; i++) {
+        uint64_t t0 = bench_now_ns();
+        fn();
+        samples.push_back(bench_now_ns() - t0);
+    }
+    std::sort(samples.begin(), samples.end());
+    return (double)samples[samples.size() / 2];
+}
+
+// Runs `fn` `reps` times after one warm-up run and returns the fastest run in
+// ns. For loops of a few milliseconds, where a single timer tick or a
+// frequency change would move the median, the fastest run is the one that
+// was not disturbed and repeats best from one invocation to the next.
+template <typename F>
+static double bench_fastest_ns(int reps, F fn) {
+    fn();
+    uint64_t fastest = UINT64_MAX;
+    for (int i = 0; i < reps; i++) {
+        uint64_t t0 = bench_now_ns();
+        fn();
+        fastest = std::min<uint64_t>(fastest, bench_now_ns() - t0);
+    }
+    return (double)fastest;
+}
+
+static inline void bench_report(const char* bench, const char* metric, double value, const char* unit) {
+    std::printf("%s\t%s\t%.3f\t%s\n", bench, metric, value, unit);
+}
+
+// Keeps the optimiser from discarding a value computed only for timing.
+template <typename T>
+static inline void bench_keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Replays a pre-built byte stream in UART-sized bursts: available() never
+// reports more than `burst` bytes until they have been consumed, which is
+// how a hardware FIFO presents data to read(). readBytes() is a memcpy, like
+// the bulk path of a buffered UART driver.
+class BurstStream : public Stream {
+    const std::vector<uint8_t>* data_ = nullptr;
+    size_t pos_ = 0;
+    size_t burst_left_ = 0;
+    size_t burst_ = 64;
+public:
+    void load(const std::vector<uint8_t>& data, size_t burst) {
+        data_ = &data; pos_ = 0; burst_ = burst; burst_left_ = 0;
+    }
+    bool done() const { return pos_ >= data_->size(); }
+    // Releases the next burst; call once per simulated UART interrupt.
+    void tick() {
+        size_t left = data_->size() - pos_;
+        burst_left_ = left < burst_ ? left : burst_;
+    }
+    int available() override { return (int)burst_left_; }
+    int read() override {
+        if (burst_left_ == 0) return -1;
+        burst_left_--;
+        return (*data_)[pos_++];
+    }
+    size_t readBytes(uint8_t* buf, size_t n) {
+        if (n > burst_left_) n = burst_left_;
+        std::memcpy(buf, data_->data() + pos_, n);
+        pos_ += n;
+        burst_left_ -= n;
+        return n;
+    }
+    using Stream::readBytes;
+};
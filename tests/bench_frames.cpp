@@ -0,0 +1,91 @@
+// Host benchmark for frame parsing cost through the public read() API.
+//
+// Build & run:  bash tests/bench.sh frames   (from the repo root)
+//
+// Streams of back-to-back basic (Table 12) and engineering (Table 14) frames,
+// and basic frames with a few bytes of line noise between them, are fed in
+// 64-byte bursts, and read() is called until every frame has been decoded.
+// Reported per frame: wall time, frames per second and TSC cycles where the
+// host has a time-stamp counter (fastest run); and wall time per input byte.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "bench_common.h"
+#include "radar_frames.h"
+#include <random>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+static std::vector<uint8_t> repeat_frame(const std::vector<uint8_t>& frame, size_t count) {
+    std::vector<uint8_t> v;
+    v.reserve(frame.size() * count);
+    for (size_t i = 0; i < count; i++) v.insert(v.end(), frame.begin(), frame.end());
+    return v;
+}
+
+// Basic frames with 0 to 7 junk bytes before each. The junk never contains a
+// header byte, so every frame is still recovered.
+static std::vector<uint8_t> noisy_line(size_t count) {
+    std::mt19937 rng(2410);
+    std::vector<uint8_t> v;
+    for (size_t i = 0; i < count; i++) {
+        for (unsigned n = rng() % 8; n > 0; n--) {
+            uint8_t junk = (uint8_t)rng();
+            if (junk == 0xF4 || junk == 0xFD) junk = 0x00;
+            v.push_back(junk);
+        }
+        v.insert(v.end(), kBasicFrame.begin(), kBasicFrame.end());
+    }
+    return v;
+}
+
+static void run(const char* name, const std::vector<uint8_t>& line, size_t frames) {
+    const int reps = 11;
+    BurstStream s;
+    size_t parsed = 0;
+    uint64_t cycles = UINT64_MAX;
+
+    double ns = bench_median_ns(reps, [&] {
+        ld2410 radar;
+        radar.begin(s, false);
+        s.load(line, 64);
+        parsed = 0;
+#if BENCH_HAVE_TSC
+        uint64_t c0 = __rdtsc();
+#endif
+        while (!s.done()) {
+            s.tick();
+            while (radar.read()) parsed++;
+        }
+        while (radar.read()) parsed++;
+#if BENCH_HAVE_TSC
+        cycles = std::min<uint64_t>(cycles, __rdtsc() - c0);
+#endif
+        bench_keep(radar);
+    });
+
+    char metric[64];
+    std::snprintf(metric, sizeof(metric), "%s_ns_per_frame", name);
+    bench_report("frames", metric, ns / frames, "ns");
+    std::snprintf(metric, sizeof(metric), "%s_ns_per_byte", name);
+    bench_report("frames", metric, ns / line.size(), "ns");
+    std::snprintf(metric, sizeof(metric), "%s_frames_per_sec", name);
+    bench_report("frames", metric, frames / (ns / 1e9), "frames/s");
+#if BENCH_HAVE_TSC
+    std::snprintf(metric, sizeof(metric), "%s_cycles_per_frame", name);
+    bench_report("frames", metric, (double)cycles / frames, "cycles");
+#endif
+    if (parsed < frames) {
+        std::fprintf(stderr, "frames: %s parsed only %zu of %zu frames\n", name, parsed, frames);
+    }
+}
+
+int main() {
+    const size_t frames = 50000;
+    run("basic", repeat_frame(kBasicFrame, frames), frames);
+    run("engineering", repeat_frame(kEngineeringFrame, frames), frames);
+    run("noisy", noisy_line(frames), frames);
+    return 0;
+}
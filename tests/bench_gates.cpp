@@ -0,0 +1,137 @@
+// Host benchmark for the ld2410_gate_window per-gate statistics.
+//
+// Build & run:  bash tests/bench.sh gates   (from the repo root)
+//
+// Reported for windows of 8, 32 and 128 engineering frames:
+//   - record_ns_per_frame: parse cost with the window set, less the cost
+//     without it, ie. what keeping the statistics adds to each frame.
+//   - stats_ns: one stats() call over a full window.
+//   - scalar_ns: the same answers from a hand-written scalar reference, a
+//     gate-by-gate two-pass loop over a copy of the last N frames, which is
+//     what consumers did before the window existed.
+// The reference's answers are compared with stats() before timing.
+
+#include <Arduino.h>
+#include <ld2410_gates.h>
+#include "bench_common.h"
+#include "radar_frames.h"
+#include <cmath>
+
+static Energies energies_for(uint32_t i) {
+    Energies e;
+    for (int g = 0; g < 9; g++) {
+        e.moving[g] = (uint8_t)((i * 37 + g * 11) % 101);
+        e.stationary[g] = (uint8_t)((i * 53 + g * 7 + 5) % 101);
+    }
+    return e;
+}
+
+static void scalar_gate(const Energies* frames, int count, bool moving, int gate, ld2410_gate_stats& out) {
+    uint8_t low = 255, high = 0;
+    uint32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        const uint8_t v = moving ? frames[i].moving[gate] : frames[i].stationary[gate];
+        if (v < low) low = v;
+        if (v > high) high = v;
+        sum += v;
+    }
+    const float mean = (float)sum / count;
+    float spread = 0;
+    for (int i = 0; i < count; i++) {
+        const float d = (moving ? frames[i].moving[gate] : frames[i].stationary[gate]) - mean;
+        spread += d * d;
+    }
+    out.min[gate] = low;
+    out.max[gate] = high;
+    out.mean[gate] = mean;
+    out.variance[gate] = spread / count;
+}
+
+static void scalar_stats(const Energies* frames, int count, ld2410_gate_window_stats& out) {
+    out.frames = (uint16_t)count;
+    for (int g = 0; g < 9; g++) {
+        scalar_gate(frames, count, true, g, out.moving);
+        scalar_gate(frames, count, false, g, out.stationary);
+    }
+}
+
+static bool agree(const ld2410_gate_stats& a, const ld2410_gate_stats& b) {
+    for (int g = 0; g < 9; g++) {
+        if (a.min[g] != b.min[g] || a.max[g] != b.max[g] ||
+            std::fabs(a.mean[g] - b.mean[g]) > 1e-3f || std::fabs(a.variance[g] - b.variance[g]) > 1e-2f) return false;
+    }
+    return true;
+}
+
+// Parses the whole stream and returns the fastest run in ns.
+static double parse_ns(const std::vector<uint8_t>& stream, ld2410_gate_window* window) {
+    return bench_fastest_ns(15, [&] {
+        BurstStream s;
+        ld2410 radar;
+        radar.begin(s, false);
+        if (window != nullptr) radar.setGateWindow(*window);
+        s.load(stream, 64);
+        while (!s.done()) {
+            s.tick();
+            while (radar.read()) {}
+        }
+        while (radar.read()) {}
+    });
+}
+
+template <uint16_t N>
+static bool run(const char* name) {
+    const int frames = 4000;
+    std::vector<uint8_t> stream;
+    std::vector<Energies> sent;
+    for (int i = 0; i < frames; i++) {
+        sent.push_back(energies_for((uint32_t)i));
+        const std::vector<uint8_t> f = engineering_frame(sent.back());
+        stream.insert(stream.end(), f.begin(), f.end());
+    }
+
+    static ld2410_gate_window_buffer<N> window;
+    const double with = parse_ns(stream, &window);
+    const double without = parse_ns(stream, nullptr);
+    char metric[64];
+    std::snprintf(metric, sizeof(metric), "%s_record_ns_per_frame", name);
+    bench_report("gates", metric, (with - without) / frames, "ns");
+
+    ld2410_gate_window_stats fast, slow;
+    const Energies* last = sent.data() + frames - N;
+    if (!window.stats(fast)) {
+        std::fprintf(stderr, "gates: the window is empty\n");
+        return false;
+    }
+    scalar_stats(last, N, slow);
+    if (fast.frames != N || !agree(fast.moving, slow.moving) || !agree(fast.stationary, slow.stationary)) {
+        std::fprintf(stderr, "gates: stats() disagrees with the scalar reference for N=%u\n", (unsigned)N);
+        return false;
+    }
+
+    const int calls = 2000;
+    const double stats_ns = bench_fastest_ns(25, [&] {
+        for (int i = 0; i < calls; i++) {
+            window.stats(fast);
+            bench_keep(fast);
+        }
+    });
+    const double scalar_ns = bench_fastest_ns(25, [&] {
+        for (int i = 0; i < calls; i++) {
+            scalar_stats(last, N, slow);
+            bench_keep(slow);
+        }
+    });
+    std::snprintf(metric, sizeof(metric), "%s_stats_ns", name);
+    bench_report("gates", metric, stats_ns / calls, "ns");
+    std::snprintf(metric, sizeof(metric), "%s_scalar_ns", name);
+    bench_report("gates", metric, scalar_ns / calls, "ns");
+    return true;
+}
+
+int main() {
+    bool ok = run<8>("window8");
+    ok = run<32>("window32") && ok;
+    ok = run<128>("window128") && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+// Host benchmark for the cost of the public getters.
+//
+// Build & run:  bash tests/bench.sh getters   (from the repo root)
+//
+// One engineering frame is parsed, then each getter is called in a tight
+// loop. Reported per getter: wall time per call (fastest run). The
+// plain getters read one field; getSnapshot() copies a whole RadarSnapshot
+// under the seqlock, so it is the one to watch.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "bench_common.h"
+#include "radar_frames.h"
+
+template <typename F>
+static void run(const char* name, F getter) {
+    const int calls = 200000;
+    const int reps = 25;
+    double ns = bench_fastest_ns(reps, [&] {
+        for (int i = 0; i < calls; i++) {
+            auto value = getter();
+            bench_keep(value);
+        }
+    });
+    char metric[64];
+    std::snprintf(metric, sizeof(metric), "%s_ns_per_call", name);
+    bench_report("getters", metric, ns / calls, "ns");
+}
+
+int main() {
+    BurstStream s;
+    ld2410 radar;
+    radar.begin(s, false);
+    s.load(kEngineeringFrame, 64);
+    while (!s.done()) {
+        s.tick();
+        radar.read();
+    }
+    if (!radar.engineeringRetrieved()) {
+        std::fprintf(stderr, "getters: the engineering frame was not parsed\n");
+        return 1;
+    }
+
+    run("presenceDetected", [&] { return radar.presenceDetected(); });
+    run("movingTargetDistance", [&] { return radar.movingTargetDistance(); });
+    run("stationaryTargetEnergy", [&] { return radar.stationaryTargetEnergy(); });
+    run("detectionDistance", [&] { return radar.detectionDistance(); });
+    run("movingEnergyAtGate", [&] { return radar.movingEnergyAtGate(3); });
+    run("getSnapshot", [&] { return radar.getSnapshot(); });
+    return 0;
+}
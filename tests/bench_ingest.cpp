@@ -0,0 +1,107 @@
+// Host benchmark for UART ingestion: ld2410::read() with the bulk readBytes()
+// path against a replica of the original per-byte loop.
+//
+// Build & run:  bash tests/bench.sh ingest   (from the repo root)
+//
+// The replica reproduces what read() did before bulk ingestion: one virtual
+// available()/read() pair and one `%` wrap per byte on the way in, then one
+// `%` wrap per byte while the parser scans for a header. Both sides see the
+// same bytes in the same 64-byte bursts, so the difference is the cost of
+// moving bytes, not of parsing frames.
+//
+// Only a core whose Stream::readBytes() is virtual (ESP32, ESP8266) gives the
+// library a bulk copy; build with
+//   EXTRA_CXXFLAGS=-DLD2410_STUB_VIRTUAL_READBYTES bash tests/bench.sh ingest
+// to measure that. By default the stub models the AVR and ArduinoCore-API
+// cores, where ingestion is a read() per byte like the replica's.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "bench_common.h"
+
+// The pre-bulk ingestion loop, kept verbatim apart from being pulled out of
+// the class so the benchmark can still run it.
+struct LegacyIngest {
+    uint8_t circular_buffer[LD2410_BUFFER_SIZE];
+    uint16_t buffer_head = 0;
+    uint16_t buffer_tail = 0;
+    uint8_t position = 0;
+
+    void add_to_buffer(uint8_t byte) {
+        circular_buffer[buffer_head] = byte;
+        buffer_head = (buffer_head + 1) % LD2410_BUFFER_SIZE;
+        if (buffer_head == buffer_tail) {
+            buffer_tail = (buffer_tail + 1) % LD2410_BUFFER_SIZE;
+        }
+    }
+    bool read_from_buffer(uint8_t& byte) {
+        if (buffer_head == buffer_tail) return false;
+        byte = circular_buffer[buffer_tail];
+        buffer_tail = (buffer_tail + 1) % LD2410_BUFFER_SIZE;
+        return true;
+    }
+    bool read(Stream& uart) {
+        bool new_data = false;
+        while (uart.available()) {
+            add_to_buffer(uart.read());
+            new_data = true;
+        }
+        // Stage A of the original read_frame_(): scan for a header byte.
+        uint8_t b;
+        while (read_from_buffer(b)) {
+            if (b == 0xF4 || b == 0xFD) position = 1;
+        }
+        return new_data;
+    }
+};
+
+// Header-free filler, so neither side spends time assembling frames.
+static std::vector<uint8_t> make_idle_line(size_t n) {
+    std::vector<uint8_t> v(n);
+    for (size_t i = 0; i < n; i++) {
+        v[i] = (uint8_t)(i * 37 + 11);
+        if (v[i] == 0xF4 || v[i] == 0xFD) v[i] = 0x00;
+    }
+    return v;
+}
+
+int main() {
+    const size_t total = 1 << 20;
+    const size_t burst = 64;
+    const int reps = 15;
+    std::vector<uint8_t> line = make_idle_line(total);
+
+    BurstStream s;
+    // Through a pointer the compiler cannot see through, so the replica pays
+    // for the virtual calls as the library does and as it did on a board.
+    Stream* volatile opaque = &s;
+    double legacy_ns = bench_median_ns(reps, [&] {
+        LegacyIngest legacy;
+        s.load(line, burst);
+        while (!s.done()) {
+            s.tick();
+            legacy.read(*opaque);
+        }
+        bench_keep(legacy.position);
+    });
+
+    double bulk_ns = bench_median_ns(reps, [&] {
+        ld2410 radar;
+        radar.begin(s, false);
+        s.load(line, burst);
+        while (!s.done()) {
+            s.tick();
+            radar.read();
+        }
+        bench_keep(radar);
+    });
+
+    const double legacy_bps = total / (legacy_ns / 1e9);
+    const double bulk_bps = total / (bulk_ns / 1e9);
+    bench_report("ingest", "legacy_bytes_per_sec", legacy_bps, "B/s");
+    bench_report("ingest", "bulk_bytes_per_sec", bulk_bps, "B/s");
+    bench_report("ingest", "legacy_ns_per_byte", legacy_ns / total, "ns");
+    bench_report("ingest", "bulk_ns_per_byte", bulk_ns / total, "ns");
+    bench_report("ingest", "speedup", bulk_bps / legacy_bps, "x");
+    return 0;
+}
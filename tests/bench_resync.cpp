@@ -0,0 +1,71 @@
+// Host benchmark for resynchronisation through line noise.
+//
+// Build & run:  bash tests/bench.sh resync   (from the repo root)
+//
+// Basic frames are interleaved with random junk so that junk makes up a set
+// share of the byte stream (0%, 50%, 90%, 99%), the way a rebooting radar, a
+// baud mismatch or a noisy line looks to the parser. Everything is fed
+// through read() in 64-byte bursts. Reported per ratio: ns per input byte,
+// and how many of the embedded frames were recovered.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "bench_common.h"
+#include <random>
+
+static std::vector<uint8_t> make_noisy_line(unsigned noise_percent, size_t frames, std::mt19937& rng) {
+    std::vector<uint8_t> v;
+    const size_t frame_len = 23;
+    const size_t noise_per_frame = noise_percent == 0 ? 0
+        : frame_len * noise_percent / (100 - noise_percent);
+    for (size_t i = 0; i < frames; i++) {
+        for (size_t n = 0; n < noise_per_frame; n++) v.push_back((uint8_t)rng());
+        // Distance field counts frames (1-based) so recovered frames can be
+        // told apart from each other.
+        const uint16_t tag = (uint16_t)(i % 60000 + 1);
+        const uint8_t frame[] = {
+            0xF4, 0xF3, 0xF2, 0xF1, 0x0D, 0x00,
+            0x02, 0xAA, 0x01, (uint8_t)tag, (uint8_t)(tag >> 8), 0x32,
+            0x00, 0x00, 0x00, 0x00, 0x00,
+            0x55, 0x00,
+            0xF8, 0xF7, 0xF6, 0xF5
+        };
+        v.insert(v.end(), frame, frame + frame_len);
+    }
+    return v;
+}
+
+int main() {
+    const unsigned ratios[] = {0, 50, 90, 99};
+    const size_t frames = 4000;
+    const int reps = 9;
+    std::mt19937 rng(2410);
+    BurstStream s;
+
+    for (unsigned ratio : ratios) {
+        std::vector<uint8_t> line = make_noisy_line(ratio, frames, rng);
+        size_t recovered = 0;
+        double ns = bench_median_ns(reps, [&] {
+            ld2410 radar;
+            radar.begin(s, false);
+            s.load(line, 64);
+            recovered = 0;
+            uint16_t last = 0;
+            while (!s.done()) {
+                s.tick();
+                while (radar.read()) {
+                    if (radar.movingTargetDistance() != last) {
+                        last = radar.movingTargetDistance();
+                        recovered++;
+                    }
+                }
+            }
+        });
+        char metric[64];
+        std::snprintf(metric, sizeof(metric), "noise%u_ns_per_byte", ratio);
+        bench_report("resync", metric, ns / line.size(), "ns");
+        std::snprintf(metric, sizeof(metric), "noise%u_frames_recovered", ratio);
+        bench_report("resync", metric, 100.0 * recovered / frames, "%");
+    }
+    return 0;
+}
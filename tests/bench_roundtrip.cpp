@@ -0,0 +1,87 @@
+// Host benchmark for command/ACK round trips through the command engine.
+//
+// Build & run:  bash tests/bench.sh roundtrip   (from the repo root)
+//
+// The stream plays a radar that answers every command frame at once, so the
+// time from a command frame being written to its ACK reaching the onAck()
+// callback is the library's own share of a round trip: engine step, frame
+// encoding, ingestion, parsing and ACK dispatch. Reported per ACK (median of
+// all of them), and per blocking requestFirmwareVersion() call, which is
+// three round trips plus the engine's LD2410_COMMAND_GAP_MS pauses. The host
+// millis() advances one tick per call, so those pauses cost a fixed number of
+// idle passes rather than 50ms each; the figure is for comparing builds, not
+// a prediction of time on a radar.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "bench_common.h"
+
+class AnsweringStream : public Stream {
+    std::vector<uint8_t> rx_;
+    size_t pos_ = 0;
+public:
+    std::vector<uint64_t> sent_ns;
+    int available() override { return (int)(rx_.size() - pos_); }
+    int read() override { return pos_ < rx_.size() ? rx_[pos_++] : -1; }
+    size_t readBytes(uint8_t* buf, size_t n) {
+        if (n > rx_.size() - pos_) n = rx_.size() - pos_;
+        std::memcpy(buf, rx_.data() + pos_, n);
+        pos_ += n;
+        if (pos_ == rx_.size()) {
+            rx_.clear();
+            pos_ = 0;
+        }
+        return n;
+    }
+    using Stream::readBytes;
+    size_t write(const uint8_t* buf, size_t n) override {
+        if (n < 8 || buf[0] != 0xFD) return n;
+        sent_ns.push_back(bench_now_ns());
+        const uint8_t op = buf[6];
+        std::vector<uint8_t> value;
+        if (op == 0xFF) value = {0x01, 0x00, 0x40, 0x00};
+        if (op == 0xA0) value = {0x01, 0x00, 0x07, 0x01, 0x16, 0x15, 0x09, 0x22};
+        const uint16_t length = (uint16_t)(4 + value.size());
+        const uint8_t head[] = {0xFD, 0xFC, 0xFB, 0xFA, (uint8_t)length, (uint8_t)(length >> 8), op, 0x01, 0x00, 0x00};
+        rx_.insert(rx_.end(), head, head + sizeof(head));
+        rx_.insert(rx_.end(), value.begin(), value.end());
+        rx_.insert(rx_.end(), {0x04, 0x03, 0x02, 0x01});
+        return n;
+    }
+    using Print::write;
+};
+
+static void on_ack(ld2410_base&, uint8_t, bool, void* context) {
+    static_cast<std::vector<uint64_t>*>(context)->push_back(bench_now_ns());
+}
+
+int main() {
+    const int requests = 2000;
+    const int reps = 5;
+    AnsweringStream s;
+    std::vector<uint64_t> acked_ns;
+    std::vector<uint64_t> round_trips;
+    int failed = 0;
+
+    double ns = bench_median_ns(reps, [&] {
+        ld2410 radar;
+        radar.begin(s, false);
+        radar.onAck(on_ack, &acked_ns);
+        for (int i = 0; i < requests; i++) {
+            s.sent_ns.clear();
+            acked_ns.clear();
+            if (!radar.requestFirmwareVersion()) failed++;
+            for (size_t j = 0; j < s.sent_ns.size() && j < acked_ns.size(); j++) {
+                round_trips.push_back(acked_ns[j] - s.sent_ns[j]);
+            }
+        }
+    });
+
+    std::sort(round_trips.begin(), round_trips.end());
+    bench_report("roundtrip", "ns_per_ack", round_trips.empty() ? 0.0 : (double)round_trips[round_trips.size() / 2], "ns");
+    bench_report("roundtrip", "ns_per_request", ns / requests, "ns");
+    if (failed > 0 || round_trips.size() != (size_t)(3 * requests * reps)) {
+        std::fprintf(stderr, "roundtrip: %d requests failed, %zu ACKs timed\n", failed, round_trips.size());
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+// Host benchmark for time to first reading after begin().
+//
+// Build & run:  bash tests/bench.sh startup   (from the repo root)
+//
+// The stream plays a radar on the host millis() clock: a data frame every
+// 100ms at a phase that is varied from run to run, none while it is in
+// configuration mode, and each ACK 5ms after its command. For each startup
+// mode the time from begin() to the first reading getSnapshot() can see is
+// reported, mean and worst over the phases, and for passive startup also the
+// time until the background firmware query has finished. The host millis()
+// advances one tick per call, so busy loops age the clock faster than a
+// microcontroller would; the figures are for comparing the two paths with
+// each other, not a prediction of time on a radar.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "bench_common.h"
+
+class ClockedRadar : public Stream {
+    std::vector<uint8_t> rx_;
+    size_t pos_ = 0;
+    struct Pending { unsigned long due; std::vector<uint8_t> bytes; };
+    std::vector<Pending> pending_;
+    unsigned long next_frame_ = 0;
+    bool configuring_ = false;
+    static const unsigned long kPeriod = 100;
+    static const unsigned long kAckLatency = 5;
+
+    void advance() {
+        const unsigned long now = millis();
+        while (!pending_.empty() && (long)(now - pending_.front().due) >= 0) {
+            rx_.insert(rx_.end(), pending_.front().bytes.begin(), pending_.front().bytes.end());
+            pending_.erase(pending_.begin());
+        }
+        while ((long)(now - next_frame_) >= 0) {
+            if (!configuring_) {
+                static const uint8_t frame[] = {
+                    0xF4, 0xF3, 0xF2, 0xF1, 0x0D, 0x00,
+                    0x02, 0xAA, 0x01, 0x20, 0x00, 0x32, 0x00, 0x00, 0x00, 0x20, 0x00,
+                    0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5
+                };
+                rx_.insert(rx_.end(), frame, frame + sizeof(frame));
+            }
+            next_frame_ += kPeriod;
+        }
+    }
+
+public:
+    explicit ClockedRadar(unsigned long phase) { next_frame_ = millis() + phase; }
+    int available() override {
+        advance();
+        return (int)(rx_.size() - pos_);
+    }
+    int read() override { return pos_ < rx_.size() ? rx_[pos_++] : -1; }
+    size_t readBytes(uint8_t* buf, size_t n) {
+        if (n > rx_.size() - pos_) n = rx_.size() - pos_;
+        std::memcpy(buf, rx_.data() + pos_, n);
+        pos_ += n;
+        return n;
+    }
+    using Stream::readBytes;
+    size_t write(const uint8_t* buf, size_t n) override {
+        if (n < 8 || buf[0] != 0xFD) return n;
+        const uint8_t op = buf[6];
+        if (op == 0xFF) configuring_ = true;
+        if (op == 0xFE) configuring_ = false;
+        std::vector<uint8_t> value;
+        if (op == 0xFF) value = {0x01, 0x00, 0x40, 0x00};
+        if (op == 0xA0) value = {0x01, 0x00, 0x07, 0x01, 0x16, 0x15, 0x09, 0x22};
+        const uint16_t length = (uint16_t)(4 + value.size());
+        std::vector<uint8_t> ack = {0xFD, 0xFC, 0xFB, 0xFA, (uint8_t)length, (uint8_t)(length >> 8), op, 0x01, 0x00, 0x00};
+        ack.insert(ack.end(), value.begin(), value.end());
+        ack.insert(ack.end(), {0x04, 0x03, 0x02, 0x01});
+        pending_.push_back({millis() + kAckLatency, ack});
+        return n;
+    }
+    using Print::write;
+};
+
+struct Timing {
+    double first_reading_ms = 0;
+    double worst_first_reading_ms = 0;
+    double firmware_ms = 0;
+    int failed = 0;
+};
+
+static Timing measure(ld2410_startup startup) {
+    const int phases = 20;
+    Timing timing;
+    for (int phase = 0; phase < phases; phase++) {
+        ClockedRadar s((unsigned long)phase * 5);
+        ld2410 radar;
+        const unsigned long started = millis();
+        if (!radar.begin(s, startup)) timing.failed++;
+        int reads = 0;
+        while (radar.getSnapshot().sequence == 0 && reads++ < 1000000) radar.read();
+        const double first = (double)(millis() - started);
+        while (radar.firmware_major_version == 0 && reads++ < 1000000) radar.read();
+        const double firmware = (double)(millis() - started);
+        if (radar.firmware_major_version == 0) timing.failed++;
+        timing.first_reading_ms += first / phases;
+        timing.worst_first_reading_ms = std::max(timing.worst_first_reading_ms, first);
+        timing.firmware_ms += firmware / phases;
+    }
+    return timing;
+}
+
+int main() {
+    const Timing query = measure(LD2410_STARTUP_FIRMWARE);
+    const Timing passive = measure(LD2410_STARTUP_PASSIVE);
+    bench_report("startup", "firmware_first_reading_ms", query.first_reading_ms, "ms");
+    bench_report("startup", "firmware_worst_first_reading_ms", query.worst_first_reading_ms, "ms");
+    bench_report("startup", "passive_first_reading_ms", passive.first_reading_ms, "ms");
+    bench_report("startup", "passive_worst_first_reading_ms", passive.worst_first_reading_ms, "ms");
+    bench_report("startup", "passive_firmware_known_ms", passive.firmware_ms, "ms");
+    if (query.failed > 0 || passive.failed > 0) {
+        std::fprintf(stderr, "startup: %d firmware and %d passive startups failed\n", query.failed, passive.failed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Host benchmark for frame-to-snapshot latency of the background read loop,
+// polling versus event-driven.
+//
+// Build & run:  bash tests/bench.sh wake   (from the repo root)
+//
+// A reader thread runs waitAndRead() in a loop, as autoReadTask does on
+// ESP32. A feeder thread injects one basic frame at a time at irregular
+// intervals and timestamps it; the reader timestamps the moment the frame's
+// sequence number shows up in getSnapshot().
+//   poll:  the classic loop, sleeping LD2410_POLL_INTERVAL_MS between passes
+//          (a sleeping wake source stands in for vTaskDelay(), which the host
+//          delay() stub does not model).
+//   event: ld2410_condvar_wake_source, notified by the feeder right after the
+//          bytes land, as a UART receive callback would.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "bench_common.h"
+#include "locked_serial.h"
+#include "radar_frames.h"
+#include <atomic>
+#include <random>
+#include <thread>
+
+// The polling loop's fixed sleep, expressed as a wake source that never
+// gets notified.
+class SleepPollSource : public ld2410_wake_source {
+public:
+    bool wait(uint32_t timeout_ms) override {
+        uint32_t ms = timeout_ms < LD2410_POLL_INTERVAL_MS ? timeout_ms : LD2410_POLL_INTERVAL_MS;
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return false;
+    }
+    void notify() override {}
+};
+
+static void run(const char* mode, ld2410_wake_source& wake, bool notify) {
+    const int frames = 300;
+    ld2410 radar;
+    LockedSerial s;
+    radar.begin(s, false);
+    radar.setWakeSource(wake);
+
+    std::vector<uint64_t> sent(frames + 1), seen(frames + 1);
+    std::atomic<bool> done(false);
+
+    std::thread reader([&] {
+        uint32_t last = 0;
+        while (!done) {
+            radar.waitAndRead(100);
+            const uint32_t seq = radar.getSnapshot().sequence;
+            const uint64_t now = bench_now_ns();
+            while (last < seq && last < (uint32_t)frames) seen[++last] = now;
+        }
+    });
+
+    std::mt19937 rng(2410);
+    for (int i = 1; i <= frames; i++) {
+        // Irregular gaps so frame arrival is not phase-locked to the poll.
+        std::this_thread::sleep_for(std::chrono::microseconds(3000 + rng() % 9000));
+        sent[i] = bench_now_ns();
+        s.inject(kBasicFrame);
+        if (notify) radar.notifyDataAvailable();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    done = true;
+    wake.notify();
+    reader.join();
+
+    std::vector<double> latency_us;
+    for (int i = 1; i <= frames; i++) {
+        if (seen[i] >= sent[i]) latency_us.push_back((seen[i] - sent[i]) / 1e3);
+    }
+    std::sort(latency_us.begin(), latency_us.end());
+    char metric[64];
+    std::snprintf(metric, sizeof(metric), "%s_latency_p50", mode);
+    bench_report("wake", metric, latency_us[latency_us.size() / 2], "us");
+    std::snprintf(metric, sizeof(metric), "%s_latency_p99", mode);
+    bench_report("wake", metric, latency_us[latency_us.size() * 99 / 100], "us");
+    std::snprintf(metric, sizeof(metric), "%s_latency_max", mode);
+    bench_report("wake", metric, latency_us.back(), "us");
+}
+
+int main() {
+    SleepPollSource poll;
+    run("poll", poll, false);
+    ld2410_condvar_wake_source event;
+    run("event", event, true);
+    return 0;
+}
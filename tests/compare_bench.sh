@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+# Compare two saved benchmark runs.
+# Usage: bash tests/bench.sh > before.tsv
+#        (make the change)
+#        bash tests/bench.sh > after.tsv
+#        bash tests/compare_bench.sh before.tsv after.tsv [threshold%]
+#
+# Prints one tab-separated line per metric found in both runs:
+#   <benchmark>\t<metric>\t<before>\t<after>\t<change%>\t<verdict>
+# The verdict is "better" or "worse" when the change exceeds the threshold
+# (default 5%), taking the unit into account: time and cycles should go
+# down, rates and recovery percentages up. Otherwise it is "same".
+set -euo pipefail
+
+if [ "$#" -lt 2 ]; then
+    echo "usage: $0 before.tsv after.tsv [threshold%]" >&2
+    exit 2
+fi
+THRESHOLD="${3:-5}"
+
+awk -F'\t' -v OFS='\t' -v threshold="$THRESHOLD" '
+    NR == FNR { before[$1 "\t" $2] = $3; next }
+    ($1 "\t" $2) in before {
+        old = before[$1 "\t" $2]; new = $3
+        change = old == 0 ? 0 : 100 * (new - old) / old
+        higher_is_better = ($4 ~ /\/s$/ || $4 == "x" || $4 == "%")
+        verdict = "same"
+        if (change > threshold) verdict = higher_is_better ? "better" : "worse"
+        if (change < -threshold) verdict = higher_is_better ? "worse" : "better"
+        printf "%s\t%s\t%s\t%s\t%+.1f\t%s\n", $1, $2, old, new, change, verdict
+    }
+' "$1" "$2"
@@ -0,0 +1,33 @@
+// Thread-safe mock UART for the host tests and benchmarks that run the
+// parser on one std::thread and feed it from another, the way a UART driver
+// and autoReadTask share a Stream on ESP32.
+#pragma once
+#include <Arduino.h>
+#include <mutex>
+#include <vector>
+
+class LockedSerial : public Stream {
+    std::mutex m_;
+    std::vector<uint8_t> q_;
+    size_t pos_ = 0;
+public:
+    void inject(const std::vector<uint8_t>& bytes) {
+        std::lock_guard<std::mutex> lock(m_);
+        q_.insert(q_.end(), bytes.begin(), bytes.end());
+    }
+    int available() override {
+        std::lock_guard<std::mutex> lock(m_);
+        return (int)(q_.size() - pos_);
+    }
+    int read() override {
+        std::lock_guard<std::mutex> lock(m_);
+        return pos_ < q_.size() ? q_[pos_++] : -1;
+    }
+    size_t readBytes(uint8_t* buf, size_t n) {
+        std::lock_guard<std::mutex> lock(m_);
+        size_t got = 0;
+        while (got < n && pos_ < q_.size()) buf[got++] = q_[pos_++];
+        return got;
+    }
+    using Stream::readBytes;
+};
@@ -0,0 +1,79 @@
+// Frames as the radar sends them, built for the host tests and benchmarks.
+//
+// Functions and constants are inline, so a file that includes this header and
+// uses only part of it builds without unused-function warnings.
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// Basic frame (Table 12) with the given target state, distances and energies.
+inline std::vector<uint8_t> basic_frame(uint8_t state, uint16_t moving_distance, uint8_t moving_energy,
+                                        uint16_t stationary_distance, uint8_t stationary_energy,
+                                        uint16_t detection_distance) {
+    return {
+        0xF4, 0xF3, 0xF2, 0xF1, 0x0D, 0x00,
+        0x02, 0xAA, state,
+        (uint8_t)moving_distance, (uint8_t)(moving_distance >> 8), moving_energy,
+        (uint8_t)stationary_distance, (uint8_t)(stationary_distance >> 8), stationary_energy,
+        (uint8_t)detection_distance, (uint8_t)(detection_distance >> 8),
+        0x55, 0x00,
+        0xF8, 0xF7, 0xF6, 0xF5
+    };
+}
+
+// A moving target at `distance` cm with energy 50, detected up to the same distance.
+inline std::vector<uint8_t> basic_frame(uint8_t distance) {
+    return basic_frame(0x01, distance, 0x32, 0, 0, distance);
+}
+
+// `count` copies of basic_frame(distance), back to back.
+inline std::vector<uint8_t> basic_frames(uint8_t distance, int count) {
+    const std::vector<uint8_t> f = basic_frame(distance);
+    std::vector<uint8_t> v;
+    for (int i = 0; i < count; i++) v.insert(v.end(), f.begin(), f.end());
+    return v;
+}
+
+// The protocol's Table 12 example: target state 2, moving distance 81cm with
+// energy 0, stationary energy 59, the other distances 0.
+inline const std::vector<uint8_t> kBasicFrame = basic_frame(0x02, 0x51, 0x00, 0x00, 0x3B, 0x00);
+
+// Per-gate energies of an engineering frame (Table 14).
+struct Energies {
+    uint8_t moving[9] = {0,0,0,0,0,0,0,0,0};
+    uint8_t stationary[9] = {0,0,0,0,0,0,0,0,0};
+};
+
+// Engineering frame with the target fields of the protocol's example and the
+// given per-gate energies.
+inline std::vector<uint8_t> engineering_frame(const Energies& e) {
+    std::vector<uint8_t> f = {
+        0xF4, 0xF3, 0xF2, 0xF1, 0x23, 0x00,
+        0x01, 0xAA, 0x03, 0x1E, 0x00, 0x3C, 0x00, 0x00, 0x39, 0x00, 0x00,
+        0x08, 0x08
+    };
+    f.insert(f.end(), e.moving, e.moving + 9);
+    f.insert(f.end(), e.stationary, e.stationary + 9);
+    f.insert(f.end(), {0x03, 0x05, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5});
+    return f;
+}
+
+// The protocol's engineering frame example, gate energies included.
+inline const std::vector<uint8_t> kEngineeringFrame = engineering_frame(Energies{
+    {0x3C, 0x22, 0x05, 0x03, 0x03, 0x04, 0x03, 0x06, 0x05},
+    {0x00, 0x00, 0x39, 0x10, 0x13, 0x06, 0x06, 0x08, 0x04}
+});
+
+// ACK frame for command word `op`, padded with zeros to `intra_len` bytes
+// after the length field.
+inline std::vector<uint8_t> ack(uint8_t op, bool success = true, uint16_t intra_len = 4) {
+    std::vector<uint8_t> v = {
+        0xFD, 0xFC, 0xFB, 0xFA,
+        (uint8_t)(intra_len & 0xFF), (uint8_t)(intra_len >> 8),
+        op, 0x01,
+        (uint8_t)(success ? 0x00 : 0x01), 0x00
+    };
+    for (uint16_t i = 4; i < intra_len; i++) v.push_back(0x00);
+    v.insert(v.end(), {0x04, 0x03, 0x02, 0x01});
+    return v;
+}
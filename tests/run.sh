@@ -1,17 +1,20 @@
 #!/usr/bin/env bash
-# Build and run the host-side parser unit tests.
+# Build and run the host-side unit tests (every tests/test_*.cpp).
 # Usage: bash tests/run.sh   (from the repo root, or anywhere)
+# EXTRA_CXXFLAGS=-DLD2410_STUB_VIRTUAL_READBYTES models the ESP32/ESP8266 Stream
+# instead of the AVR/ArduinoCore-API one.
 set -euo pipefail
 
 HERE="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 ROOT="$(cd "$HERE/.." && pwd)"
-BIN="$HERE/test_parser"
 
-g++ -std=c++17 -Wall -Wextra \
-    -I"$HERE" \
-    -I"$ROOT/src" \
-    "$HERE/test_parser.cpp" \
-    "$ROOT/src/ld2410.cpp" \
-    -o "$BIN"
-
-"$BIN"
+for src in "$HERE"/test_*.cpp; do
+    bin="${src%.cpp}"
+    g++ -std=c++17 -Wall -Wextra -pthread ${EXTRA_CXXFLAGS:-} \
+        -I"$HERE" \
+        -I"$ROOT/src" \
+        "$src" \
+        "$ROOT"/src/*.cpp \
+        -o "$bin"
+    "$bin"
+done
@@ -0,0 +1,117 @@
+// Native host-side tests for the ld2410_background per-gate model.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// Engineering frames are built gate by gate: a steady clutter level in a few
+// gates that the model should learn and cancel, and a "person" that raises
+// one gate above it.
+
+#include <Arduino.h>
+#include <ld2410_background.h>
+#include "test_common.h"
+#include <cstdio>
+#include <vector>
+
+static Energies clutter() {
+    Energies e;
+    e.moving[2] = 40;                               // a fan
+    e.stationary[2] = 35;
+    e.stationary[6] = 60;                           // a radiator
+    for (int g = 0; g < 9; g++) if (e.moving[g] == 0) e.moving[g] = 5;
+    return e;
+}
+
+// Steady clutter is taken as the background at once and never reads as
+// presence; a person on top of it does, by exactly how far they stand out.
+static void test_background_cancels_clutter() {
+    std::printf("test_background_cancels_clutter ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    ld2410_background background;
+    ld2410_background_state state;
+    CHECK(!background.state(state));
+    r.setBackground(background);
+    feed(r, s, kBasicFrame);                        // no per-gate energies: ignored
+    CHECK(!background.state(state));
+
+    for (int i = 0; i < 50; i++) feed(r, s, engineering_frame(clutter()));
+    CHECK(background.state(state));
+    CHECK(state.frames == 50);
+    CHECK(!state.presence && !background.presenceDetected());
+    CHECK(state.moving_background[2] == 40);
+    CHECK(state.stationary_background[6] == 60);
+    CHECK(state.stationary_excess[6] == 0);
+
+    Energies person = clutter();
+    person.moving[4] = 5 + 30;
+    person.stationary[2] = 35 + 10;                 // under the threshold of 15
+    feed(r, s, engineering_frame(person));
+    CHECK(background.presenceDetected());
+    CHECK(background.state(state));
+    CHECK(state.presence);
+    CHECK(state.moving_excess[4] == 30);
+    CHECK(state.stationary_excess[2] == 10);
+    CHECK(state.moving_background[4] == 5);          // a rise is followed only slowly
+
+    feed(r, s, engineering_frame(clutter()));
+    CHECK(!background.presenceDetected());
+    std::printf("ok\n");
+}
+
+// Falls are followed within a few frames, rises only over about 2^rise
+// frames, so a person who stays put is still reported a good while later.
+static void test_background_adaptation() {
+    std::printf("test_background_adaptation ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    ld2410_background background;
+    background.configure(15, 3, 8);
+    r.setBackground(background);
+    Energies e;
+    e.moving[1] = 80;
+    feed(r, s, engineering_frame(e));
+    e.moving[1] = 20;                               // the clutter went away
+    for (int i = 0; i < 40; i++) feed(r, s, engineering_frame(e));
+    ld2410_background_state state;
+    CHECK(background.state(state));
+    CHECK(state.moving_background[1] == 20);
+
+    e.moving[1] = 60;                               // someone arrives and stays
+    feed(r, s, engineering_frame(e));
+    CHECK(background.presenceDetected());
+    int frames_present = 1;
+    while (frames_present < 2000) {
+        feed(r, s, engineering_frame(e));
+        if (!background.presenceDetected()) break;
+        frames_present++;
+    }
+    CHECK(frames_present > 50);                     // 1/256 per frame: about 250 frames to close 40 to 15
+    CHECK(frames_present < 2000);
+    CHECK(background.state(state));
+    CHECK(state.moving_background[1] >= 45);
+    for (int i = 0; i < 3000; i++) feed(r, s, engineering_frame(e));
+    CHECK(background.state(state));
+    CHECK(state.moving_background[1] == 60);        // no stalling short of the sample
+
+    // reset() relearns from the next frame.
+    e.moving[1] = 10;
+    background.reset();
+    feed(r, s, engineering_frame(e));
+    CHECK(background.state(state));
+    CHECK(state.frames == 1);
+    CHECK(state.moving_background[1] == 10);
+
+    // So does a second setBackground().
+    r.setBackground(background);
+    CHECK(!background.state(state));
+    std::printf("ok\n");
+}
+
+int main() {
+    test_background_cancels_clutter();
+    test_background_adaptation();
+
+    return test_result();
+}
@@ -0,0 +1,190 @@
+// Native host-side tests for setBaudRate() and detectBaudRate().
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// The radar runs at one baud rate and the UART at whatever the detection hook
+// last set. While they match the radar's frames come through intact; while
+// they do not, each frame arrives as the same number of junk bytes, as it
+// does on a real line at the wrong rate.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "test_common.h"
+#include <cstdio>
+#include <vector>
+
+static const std::vector<uint8_t> kFrame = basic_frame(0x20);    // a moving target at 32cm
+
+class BaudRadar : public Stream {
+    std::vector<uint8_t> rx_;
+    size_t pos_ = 0;
+    std::vector<uint8_t> command_;
+    uint32_t polls_ = 0;
+public:
+    uint32_t radar_baud = 256000;
+    uint32_t uart_baud = 256000;
+    bool silent = false;
+    uint32_t frames_sent = 0;
+    uint32_t wrong_frames_sent = 0;                 // frames sent while the rates differed
+    std::vector<uint8_t> opcodes;
+    uint16_t baud_value = 0;                        // value of the last 0xA1 command
+
+    // A frame every few polls, like the radar's ~100ms against a busy loop.
+    int available() override {
+        if (pos_ == rx_.size() && !silent && ++polls_ % 4 == 0) frame();
+        return (int)(rx_.size() - pos_);
+    }
+    int read() override { return pos_ < rx_.size() ? rx_[pos_++] : -1; }
+    size_t write(uint8_t b) override { receive(b); return 1; }
+    size_t write(const uint8_t* buf, size_t n) override {
+        for (size_t i = 0; i < n; i++) receive(buf[i]);
+        return n;
+    }
+
+private:
+    void frame() {
+        frames_sent++;
+        if (uart_baud == radar_baud) {
+            rx_.insert(rx_.end(), kFrame.begin(), kFrame.end());
+            return;
+        }
+        wrong_frames_sent++;
+        for (size_t i = 0; i < kFrame.size(); i++) rx_.push_back((uint8_t)(0x80 | (frames_sent * 7 + i * 13) % 0x70));
+    }
+
+    void receive(uint8_t b) {
+        command_.push_back(b);
+        const size_t n = command_.size();
+        if (n >= 6 && n == (size_t)(command_[4] | (command_[5] << 8)) + 10) {
+            const uint8_t op = command_[6];
+            opcodes.push_back(op);
+            if (op == 0xA1) baud_value = (uint16_t)(command_[8] | (command_[9] << 8));
+            std::vector<uint8_t> a = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, op, 0x01, 0x00, 0x00};
+            if (op == 0xFF) {
+                a[4] = 0x08;
+                a.insert(a.end(), {0x01, 0x00, 0x40, 0x00});
+            }
+            a.insert(a.end(), {0x04, 0x03, 0x02, 0x01});
+            if (uart_baud == radar_baud) rx_.insert(rx_.end(), a.begin(), a.end());
+            command_.clear();
+        }
+    }
+};
+
+struct Tries {
+    BaudRadar* radar;
+    std::vector<uint32_t> rates;
+    uint32_t refuse = 0;                            // a rate the UART cannot do
+};
+
+static bool reconfigure(uint32_t baud, void* context) {
+    Tries* tries = static_cast<Tries*>(context);
+    tries->rates.push_back(baud);
+    if (baud == tries->refuse) return false;
+    tries->radar->uart_baud = baud;
+    return true;
+}
+
+static void test_set_baud_rate() {
+    std::printf("test_set_baud_rate ... ");
+    BaudRadar radar;
+    radar.silent = true;
+    ld2410 sensor;
+    sensor.begin(radar, false);
+    CHECK(sensor.setBaudRate(115200));
+    CHECK((radar.opcodes == std::vector<uint8_t>{0xFF, 0xA1, 0xFE}));
+    CHECK(radar.baud_value == 5);
+    CHECK(sensor.setBaudRate(9600) && radar.baud_value == 1);
+    CHECK(sensor.setBaudRate(460800) && radar.baud_value == 8);
+    radar.opcodes.clear();
+    CHECK(!sensor.setBaudRate(250000));             // not one of the radar's rates
+    CHECK(!sensor.setBaudRate(0));
+    CHECK(radar.opcodes.empty());
+    std::printf("ok\n");
+}
+
+// The radar was left at 57600: the factory default and 115200 are tried and
+// given up on as soon as the junk shows they are wrong, then 57600 matches.
+static void test_detect_baud_rate() {
+    std::printf("test_detect_baud_rate ... ");
+    BaudRadar radar;
+    radar.radar_baud = 57600;
+    ld2410 sensor;
+    sensor.begin(radar, false);
+    Tries tries = {&radar, {}, 0};
+    CHECK(sensor.detectBaudRate(reconfigure, &tries) == 57600);
+    CHECK((tries.rates == std::vector<uint32_t>{256000, 115200, 57600}));
+    CHECK(radar.uart_baud == 57600);
+    CHECK(radar.wrong_frames_sent < 20);            // two rates, well short of the timeout each
+    CHECK(sensor.presenceDetected());
+    CHECK(sensor.movingTargetDistance() == 0x20);
+
+    // Once found, the sensor carries on as normal, commands included.
+    CHECK(sensor.setBaudRate(256000) && radar.baud_value == 7);
+
+    // Detection starts from the top of the list every time.
+    tries.rates.clear();
+    CHECK(sensor.detectBaudRate(reconfigure, &tries) == 57600);
+    CHECK(tries.rates.size() == 3);
+    std::printf("ok\n");
+}
+
+static void test_detect_baud_rate_candidates() {
+    std::printf("test_detect_baud_rate_candidates ... ");
+    BaudRadar radar;
+    radar.radar_baud = 9600;
+    ld2410 sensor;
+    sensor.begin(radar, false);
+    Tries tries = {&radar, {}, 19200};
+    const uint32_t candidates[] = {19200, 38400, 9600};
+    CHECK(sensor.detectBaudRate(reconfigure, &tries, 300, candidates, 3) == 9600);
+    CHECK((tries.rates == std::vector<uint32_t>{19200, 38400, 9600}));
+    CHECK(radar.uart_baud == 9600);                 // 19200 was refused, not listened at
+    std::printf("ok\n");
+}
+
+static void test_detect_baud_rate_fails() {
+    std::printf("test_detect_baud_rate_fails ... ");
+    {
+        // Nothing on the line at any rate: every default candidate is tried,
+        // then the UART goes back to the factory default.
+        BaudRadar radar;
+        radar.silent = true;
+        ld2410 sensor;
+        sensor.begin(radar, false);
+        Tries tries = {&radar, {}, 0};
+        CHECK(sensor.detectBaudRate(reconfigure, &tries, 50) == 0);
+        CHECK(tries.rates.size() == 9);
+        CHECK(tries.rates.front() == 256000 && tries.rates.back() == 256000);
+        CHECK(radar.uart_baud == 256000);
+    }
+    {
+        // A rate the radar does not run at among the candidates.
+        BaudRadar radar;
+        radar.radar_baud = 230400;
+        ld2410 sensor;
+        sensor.begin(radar, false);
+        Tries tries = {&radar, {}, 0};
+        const uint32_t candidates[] = {115200, 9600};
+        CHECK(sensor.detectBaudRate(reconfigure, &tries, 300, candidates, 2) == 0);
+        CHECK(radar.uart_baud == 115200);
+        CHECK(!sensor.presenceDetected());
+    }
+    {
+        BaudRadar radar;
+        ld2410 sensor;
+        CHECK(sensor.detectBaudRate(reconfigure, nullptr) == 0);    // before begin()
+        sensor.begin(radar, false);
+        CHECK(sensor.detectBaudRate(nullptr) == 0);
+    }
+    std::printf("ok\n");
+}
+
+int main() {
+    test_set_baud_rate();
+    test_detect_baud_rate();
+    test_detect_baud_rate_candidates();
+    test_detect_baud_rate_fails();
+
+    return test_result();
+}
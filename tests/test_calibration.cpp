@@ -0,0 +1,286 @@
+// Native host-side tests for ld2410_calibration.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// The sensor talks to an emulated radar: it decodes every command frame
+// written to it, ACKs it, keeps the gate thresholds and the engineering mode
+// flag the commands set, and answers 0x61 with its real configuration. Like
+// the real radar it keeps no stationary threshold for gates 0 and 1, and
+// reads back the value it holds rather than the one last sent. Each
+// call to frame() emits one data frame of an "empty room" whose per-gate
+// energies wobble around a fixed level, engineering or basic depending on
+// the mode, so the thresholds calibration arrives at can be checked against
+// the same energies recomputed here.
+
+#include <Arduino.h>
+#include <ld2410_calibration.h>
+#include "test_common.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+class EmulatedRadar : public Stream {
+    std::vector<uint8_t> rx_;
+    size_t pos_ = 0;
+    std::vector<uint8_t> command_;
+public:
+    uint8_t moving[9] = {50, 50, 40, 30, 20, 15, 15, 15, 15};
+    uint8_t stationary[9] = {0, 0, 40, 40, 40, 30, 20, 15, 15};
+    bool engineering = false;
+    int nak_opcode = -1;                            // NAK this command word
+    uint8_t moving_cap = 100;                       // Motion thresholds above this are stored as this
+    uint8_t stationary_sent[9] = {};                // Last stationary threshold each gate was sent
+    uint32_t frames_sent = 0;
+    std::vector<uint8_t> opcodes;                   // every command word received
+
+    // The room's energy at gate g in frame i: a level per gate plus 0-6.
+    static uint8_t room_moving(uint32_t i, int g) { return (uint8_t)(8 + g * 3 + (i * 3 + g) % 7); }
+    static uint8_t room_stationary(uint32_t i, int g) { return (uint8_t)(30 - g * 2 + (i * 2 + g * 3) % 5); }
+
+    void frame() {
+        std::vector<uint8_t> f;
+        if (engineering) {
+            f = {0xF4, 0xF3, 0xF2, 0xF1, 0x23, 0x00,
+                 0x01, 0xAA, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                 0x08, 0x08};
+            for (int g = 0; g < 9; g++) f.push_back(room_moving(frames_sent, g));
+            for (int g = 0; g < 9; g++) f.push_back(room_stationary(frames_sent, g));
+            f.insert(f.end(), {0x00, 0x00, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5});
+            frames_sent++;
+        } else {
+            f = {0xF4, 0xF3, 0xF2, 0xF1, 0x0D, 0x00,
+                 0x02, 0xAA, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5};
+        }
+        rx_.insert(rx_.end(), f.begin(), f.end());
+    }
+
+    int available() override { return (int)(rx_.size() - pos_); }
+    int read() override { return pos_ < rx_.size() ? rx_[pos_++] : -1; }
+    // A memcpy like HardwareSerial's, so the ESP model's bulk reads do not
+    // age the fake clock a tick per byte through timedRead().
+    size_t readBytes(uint8_t* buf, size_t n) {
+        if (n > rx_.size() - pos_) n = rx_.size() - pos_;
+        std::memcpy(buf, rx_.data() + pos_, n);
+        pos_ += n;
+        return n;
+    }
+    using Stream::readBytes;
+    size_t write(uint8_t b) override { receive(b); return 1; }
+    size_t write(const uint8_t* buf, size_t n) override {
+        for (size_t i = 0; i < n; i++) receive(buf[i]);
+        return n;
+    }
+
+private:
+    static uint16_t le16(const std::vector<uint8_t>& v, size_t i) { return (uint16_t)(v[i] | (v[i + 1] << 8)); }
+
+    void receive(uint8_t b) {
+        command_.push_back(b);
+        const size_t n = command_.size();
+        if (n >= 6 && n == (size_t)le16(command_, 4) + 10) {
+            execute();
+            command_.clear();
+        }
+    }
+
+    void execute() {
+        const uint8_t op = command_[6];
+        opcodes.push_back(op);
+        const bool ok = op != nak_opcode;
+        if (ok && op == 0x64) {
+            const uint16_t gate = le16(command_, 10);
+            moving[gate] = (uint8_t)le16(command_, 16);
+            stationary_sent[gate] = (uint8_t)le16(command_, 22);
+            if (gate >= 2) stationary[gate] = stationary_sent[gate];
+            if (moving[gate] > moving_cap) moving[gate] = moving_cap;
+        }
+        if (ok && op == 0x62) engineering = true;
+        if (ok && op == 0x63) engineering = false;
+        std::vector<uint8_t> a = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, op, 0x01, (uint8_t)(ok ? 0 : 1), 0x00};
+        if (op == 0xFF) {
+            a[4] = 0x08;
+            a.insert(a.end(), {0x01, 0x00, 0x40, 0x00});
+        } else if (op == 0x61) {
+            a[4] = 0x1C;
+            a.insert(a.end(), {0xAA, 0x08, 0x08, 0x08});
+            a.insert(a.end(), moving, moving + 9);
+            a.insert(a.end(), stationary, stationary + 9);
+            a.insert(a.end(), {0x05, 0x00});
+        }
+        a.insert(a.end(), {0x04, 0x03, 0x02, 0x01});
+        rx_.insert(rx_.end(), a.begin(), a.end());
+    }
+};
+
+// Steps the calibration, with the radar sending a frame between steps, until
+// it has finished or the bound is hit.
+static void drive(ld2410_calibration& calibration, EmulatedRadar& radar) {
+    for (int i = 0; i < 200000 && !calibration.step(); i++) {
+        if (calibration.status() == LD2410_CALIBRATION_RECORDING && i % 4 == 0) radar.frame();
+    }
+}
+
+// What the thresholds should be for the frames the radar sent.
+static uint8_t expected(bool moving, int g, uint32_t frames, uint8_t margin) {
+    double sum = 0, sum_sq = 0;
+    int high = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        const int v = moving ? EmulatedRadar::room_moving(i, g) : EmulatedRadar::room_stationary(i, g);
+        sum += v;
+        sum_sq += v * v;
+        high = v > high ? v : high;
+    }
+    const double mean = sum / frames;
+    const double limit = mean + 3 * std::sqrt(sum_sq / frames - mean * mean);
+    int level = limit > high ? (int)std::ceil(limit - 1e-4) : high;
+    level += margin;
+    return (uint8_t)(level > 100 ? 100 : level);
+}
+
+static void test_calibration_applies() {
+    std::printf("test_calibration_applies ... ");
+    EmulatedRadar radar;
+    radar.moving_cap = 30;
+    ld2410 sensor;
+    sensor.begin(radar, false);
+    uint8_t before_moving[9], before_stationary[9];
+    std::memcpy(before_moving, radar.moving, 9);
+    std::memcpy(before_stationary, radar.stationary, 9);
+
+    ld2410_calibration calibration;
+    CHECK(calibration.finished());
+    CHECK(sensor.engineeringMode() == LD2410_ENGINEERING_UNKNOWN);
+    CHECK(!calibration.start(sensor, 5000, 10));   // no frame yet to say whether engineering mode is on
+    CHECK(radar.opcodes.empty());
+    radar.frame();
+    sensor.read();
+    CHECK(sensor.engineeringMode() == LD2410_ENGINEERING_OFF);
+    CHECK(calibration.start(sensor, 5000, 10));
+    CHECK(!calibration.start(sensor, 5000, 10));   // already running
+    drive(calibration, radar);
+
+    CHECK(calibration.status() == LD2410_CALIBRATION_SUCCEEDED);
+    const ld2410_calibration_report& report = calibration.report();
+    CHECK(report.applied);
+    CHECK(report.failed_command == -1);
+    CHECK(report.frames > 100);
+    CHECK(report.frames == radar.frames_sent);
+    bool thresholds_right = true;
+    uint16_t changed = 0;
+    for (int g = 0; g < 9; g++) {
+        if (report.old_moving[g] != before_moving[g] || report.old_stationary[g] != before_stationary[g]) thresholds_right = false;
+        // What the radar holds, read back: capped motion thresholds, and
+        // gates 0 and 1 keep their stationary threshold.
+        const uint8_t moving = expected(true, g, report.frames, 10);
+        if (report.new_moving[g] != (moving > 30 ? 30 : moving)) thresholds_right = false;
+        if (report.new_stationary[g] != (g < 2 ? before_stationary[g] : expected(false, g, report.frames, 10))) thresholds_right = false;
+        if (radar.stationary_sent[g] != report.new_stationary[g]) thresholds_right = false;
+        if (radar.moving[g] != report.new_moving[g] || radar.stationary[g] != report.new_stationary[g]) thresholds_right = false;
+        if (sensor.motion_sensitivity[g] != report.new_moving[g]) thresholds_right = false;
+        if (report.new_moving[g] != before_moving[g] || report.new_stationary[g] != before_stationary[g]) changed |= 1 << g;
+        if (report.moving.min[g] > report.moving.max[g]) thresholds_right = false;
+    }
+    CHECK(thresholds_right);
+    CHECK(report.changed_gates == changed);
+    CHECK(report.moving.max[0] == 14 && report.moving.min[0] == 8);
+
+    // Two configuration windows, engineering mode off again afterwards.
+    const std::vector<uint8_t> windows = {
+        0xFF, 0x61, 0x62, 0xFE,
+        0xFF, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x61, 0x63, 0xFE
+    };
+    CHECK(radar.opcodes == windows);
+    CHECK(!radar.engineering);
+    CHECK(sensor.engineeringMode() == LD2410_ENGINEERING_OFF);
+    std::printf("ok\n");
+}
+
+// A dry run computes the same thresholds and writes nothing; engineering
+// mode, already on, is left on. The sensor knows it is on from the ACK.
+static void test_calibration_dry_run() {
+    std::printf("test_calibration_dry_run ... ");
+    EmulatedRadar radar;
+    ld2410 sensor;
+    sensor.begin(radar, false);
+    CHECK(sensor.requestStartEngineeringMode());
+    CHECK(radar.engineering);
+    CHECK(sensor.engineeringMode() == LD2410_ENGINEERING_ON);
+    radar.opcodes.clear();
+
+    ld2410_calibration calibration;
+    CHECK(calibration.start(sensor, 2000, 5, false));
+    drive(calibration, radar);
+    CHECK(calibration.status() == LD2410_CALIBRATION_SUCCEEDED);
+    const ld2410_calibration_report& report = calibration.report();
+    CHECK(!report.applied);
+    CHECK(report.frames == radar.frames_sent);
+    CHECK(report.new_moving[3] == expected(true, 3, report.frames, 5));
+    CHECK(radar.moving[3] == 30);
+    const std::vector<uint8_t> windows = {0xFF, 0x61, 0xFE};
+    CHECK(radar.opcodes == windows);
+    CHECK(radar.engineering);
+    std::printf("ok\n");
+}
+
+static void test_calibration_failures() {
+    std::printf("test_calibration_failures ... ");
+    {
+        // The radar stays in basic mode: nothing to measure.
+        EmulatedRadar radar;
+        radar.nak_opcode = 0x62;
+        ld2410 sensor;
+        sensor.begin(radar, false);
+        radar.frame();
+        sensor.read();
+        ld2410_calibration calibration;
+        CHECK(calibration.start(sensor, 2000));
+        drive(calibration, radar);
+        CHECK(calibration.status() == LD2410_CALIBRATION_FAILED);
+        CHECK(calibration.report().failed_command == 1);
+    }
+    {
+        // Engineering mode on, but the frames never come.
+        EmulatedRadar radar;
+        ld2410 sensor;
+        sensor.begin(radar, false);
+        radar.frame();
+        sensor.read();
+        ld2410_calibration calibration;
+        CHECK(calibration.start(sensor, 2000));
+        for (int i = 0; i < 200000 && !calibration.step(); i++) {}
+        CHECK(calibration.status() == LD2410_CALIBRATION_NO_FRAMES);
+        CHECK(!calibration.report().applied);
+        CHECK(!radar.engineering);
+    }
+    {
+        // The radar refuses a threshold: the rest of the window is skipped.
+        EmulatedRadar radar;
+        radar.nak_opcode = 0x64;
+        ld2410 sensor;
+        sensor.begin(radar, false);
+        radar.frame();
+        sensor.read();
+        ld2410_calibration calibration;
+        CHECK(calibration.start(sensor, 2000));
+        drive(calibration, radar);
+        CHECK(calibration.status() == LD2410_CALIBRATION_FAILED);
+        CHECK(calibration.report().failed_command == 0);
+        CHECK(!calibration.report().applied);
+        // A new calibration can start once one has finished.
+        radar.nak_opcode = -1;
+        CHECK(calibration.start(sensor, 2000));
+        drive(calibration, radar);
+        CHECK(calibration.status() == LD2410_CALIBRATION_SUCCEEDED);
+    }
+    std::printf("ok\n");
+}
+
+int main() {
+    test_calibration_applies();
+    test_calibration_dry_run();
+    test_calibration_failures();
+
+    return test_result();
+}
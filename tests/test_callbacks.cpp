@@ -0,0 +1,137 @@
+// Native host-side tests for the frame callbacks (onDataFrame(),
+// onEngineeringFrame(), onAck(), onConnectionLost()).
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "test_common.h"
+#include <cstdio>
+#include <vector>
+
+static std::vector<uint8_t> engineering_frame(uint8_t v) {
+    std::vector<uint8_t> f = {
+        0xF4, 0xF3, 0xF2, 0xF1, 0x23, 0x00,
+        0x01, 0xAA, 0x03,
+        v, 0x00, v, v, 0x00, v, v, 0x00,
+        0x08, 0x08
+    };
+    for (int g = 0; g < 18; g++) f.push_back(v);
+    f.insert(f.end(), {0x00, 0x00, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5});
+    return f;
+}
+
+struct Observed {
+    int data = 0;
+    int engineering = 0;
+    uint32_t last_sequence = 0;
+    uint16_t last_distance = 0;
+    bool getter_agreed = true;
+    std::vector<uint8_t> ack_opcodes;
+    std::vector<bool> ack_success;
+    int lost = 0;
+};
+
+static void on_data(ld2410_base& sensor, const RadarSnapshot& snapshot, void* context) {
+    Observed* o = static_cast<Observed*>(context);
+    o->data++;
+    o->last_sequence = snapshot.sequence;
+    o->last_distance = snapshot.moving_target_distance;
+    if (sensor.movingTargetDistance() != snapshot.moving_target_distance) o->getter_agreed = false;
+}
+
+static void on_engineering(ld2410_base&, const RadarSnapshot& snapshot, void* context) {
+    Observed* o = static_cast<Observed*>(context);
+    if (snapshot.engineering) o->engineering++;
+}
+
+static void on_ack(ld2410_base&, uint8_t opcode, bool success, void* context) {
+    Observed* o = static_cast<Observed*>(context);
+    o->ack_opcodes.push_back(opcode);
+    o->ack_success.push_back(success);
+}
+
+static void on_lost(ld2410_base&, void* context) {
+    static_cast<Observed*>(context)->lost++;
+}
+
+static void test_frame_callbacks() {
+    std::printf("test_frame_callbacks ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    Observed o;
+    r.onDataFrame(on_data, &o);
+    r.onEngineeringFrame(on_engineering, &o);
+    r.onAck(on_ack, &o);
+
+    feed(r, s, kBasicFrame);
+    CHECK(o.data == 1);
+    CHECK(o.engineering == 0);
+    CHECK(o.last_sequence == 1);
+    CHECK(o.last_distance == 0x51);
+
+    feed(r, s, engineering_frame(42));
+    CHECK(o.data == 2);
+    CHECK(o.engineering == 1);
+    CHECK(o.last_distance == 42);
+    CHECK(o.getter_agreed);
+
+    // Two frames in one waitAndRead() pass: one call each, in order.
+    std::vector<uint8_t> both = kBasicFrame;
+    both.insert(both.end(), kBasicFrame.begin(), kBasicFrame.end());
+    s.inject(both);
+    r.waitAndRead(0);
+    CHECK(o.data == 4);
+    CHECK(o.last_sequence == 4);
+
+    // A corrupt frame is not reported.
+    std::vector<uint8_t> bad = kBasicFrame;
+    bad[17] = 0x00;
+    feed(r, s, bad);
+    CHECK(o.data == 4);
+
+    // ACKs are reported whether the radar accepted the command or not.
+    feed(r, s, ack(0x62, true));
+    feed(r, s, ack(0x64, false));
+    CHECK((o.ack_opcodes == std::vector<uint8_t>{0x62, 0x64}));
+    CHECK((o.ack_success == std::vector<bool>{true, false}));
+    CHECK(o.data == 4);
+
+    // Removing a callback.
+    r.onDataFrame(nullptr);
+    feed(r, s, kBasicFrame);
+    CHECK(o.data == 4);
+    std::printf("ok\n");
+}
+
+// The host millis() advances by one on every call, so a few thousand read()
+// passes on a quiet line are well past LD2410_CONNECTION_LOST_MS.
+static void test_connection_lost() {
+    std::printf("test_connection_lost ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    Observed o;
+    r.onConnectionLost(on_lost, &o);
+
+    for (int i = 0; i < 3 * LD2410_CONNECTION_LOST_MS; i++) r.read();
+    CHECK(o.lost == 0);                             // nothing heard yet, nothing lost
+
+    feed(r, s, kBasicFrame);
+    for (int i = 0; i < 3 * LD2410_CONNECTION_LOST_MS; i++) r.read();
+    CHECK(o.lost == 1);                             // once per outage
+
+    feed(r, s, kBasicFrame);
+    CHECK(o.lost == 1);
+    for (int i = 0; i < 3 * LD2410_CONNECTION_LOST_MS; i++) r.waitAndRead(0);
+    CHECK(o.lost == 2);
+    std::printf("ok\n");
+}
+
+int main() {
+    test_frame_callbacks();
+    test_connection_lost();
+
+    return test_result();
+}
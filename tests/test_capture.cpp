@@ -0,0 +1,267 @@
+// Native host-side tests for raw UART capture (startCapture()) and
+// ld2410_replay_stream.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// The host micros() advances by one per call, so replay timing is counted in
+// calls and the paced tests are deterministic.
+
+#include <Arduino.h>
+#include <ld2410_replay.h>
+#include <ld2410.h>
+#include "test_common.h"
+#include <cstdio>
+#include <vector>
+
+// A Print that keeps everything written to it, standing in for a log file.
+class LogSink : public Print {
+public:
+    std::vector<uint8_t> bytes;
+    size_t write(uint8_t b) override { bytes.push_back(b); return 1; }
+    size_t write(const uint8_t* buf, size_t n) override { bytes.insert(bytes.end(), buf, buf + n); return n; }
+    using Print::write;
+};
+
+// A radar that answers commands: the next staged reply arrives when a
+// command frame's footer (04 03 02 01) goes out. Everything it ever queued
+// to be read stays in rx, so rx[0, pos) is exactly what the sensor read.
+class AnsweringRadar : public Stream {
+public:
+    std::vector<uint8_t> rx;
+    size_t pos = 0;
+    std::vector<std::vector<uint8_t>> replies;
+    std::vector<uint8_t> footer;
+
+    void inject(const std::vector<uint8_t>& bytes) { rx.insert(rx.end(), bytes.begin(), bytes.end()); }
+    int available() override { return (int)(rx.size() - pos); }
+    int read() override { return pos < rx.size() ? rx[pos++] : -1; }
+    size_t write(uint8_t b) override {
+        footer.push_back(b);
+        if (footer.size() > 4) footer.erase(footer.begin());
+        if (footer == std::vector<uint8_t>{0x04, 0x03, 0x02, 0x01} && !replies.empty()) {
+            inject(replies.front());
+            replies.erase(replies.begin());
+        }
+        return 1;
+    }
+    using Print::write;
+};
+
+// Reads one LEB128 varint at *pos.
+static uint32_t varint(const std::vector<uint8_t>& log, size_t* pos) {
+    uint32_t value = 0;
+    for (int shift = 0; *pos < log.size(); shift += 7) {
+        const uint8_t b = log[(*pos)++];
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) break;
+    }
+    return value;
+}
+
+static std::vector<uint8_t> header(uint8_t major, uint8_t minor, uint32_t bugfix) {
+    return {'L', 'D', 'C', 'P', LD2410_CAPTURE_FORMAT, major, minor, 0,
+            (uint8_t)bugfix, (uint8_t)(bugfix >> 8), (uint8_t)(bugfix >> 16), (uint8_t)(bugfix >> 24)};
+}
+
+static void append_chunk(std::vector<uint8_t>& log, uint32_t delta_us, const std::vector<uint8_t>& bytes) {
+    uint8_t buf[LD2410_CAPTURE_MAX_CHUNK_HEADER];
+    uint8_t n = ld2410_capture_varint(delta_us, buf);
+    n += ld2410_capture_varint((uint32_t)bytes.size(), buf + n);
+    log.insert(log.end(), buf, buf + n);
+    log.insert(log.end(), bytes.begin(), bytes.end());
+}
+
+static void test_capture_format() {
+    std::printf("test_capture_format ... ");
+    uint8_t buf[5];
+    CHECK(ld2410_capture_varint(0, buf) == 1 && buf[0] == 0);
+    CHECK(ld2410_capture_varint(300, buf) == 2 && buf[0] == 0xAC && buf[1] == 0x02);
+    CHECK(ld2410_capture_varint(0xFFFFFFFF, buf) == 5 && buf[4] == 0x0F);
+
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    r.firmware_major_version = 2;
+    r.firmware_minor_version = 4;
+    r.firmware_bugfix_version = 0x22062416;
+    LogSink sink;
+    r.startCapture(sink);
+    CHECK(sink.bytes == header(2, 4, 0x22062416));
+
+    // Three reads, three chunks, holding exactly the bytes read.
+    std::vector<uint8_t> sent;
+    for (uint8_t d = 10; d < 13; d++) {
+        const std::vector<uint8_t> f = basic_frame(d);
+        sent.insert(sent.end(), f.begin(), f.end());
+        s.inject(f);
+        r.read();
+    }
+    r.stopCapture();
+    s.inject(basic_frame(13));
+    r.read();
+
+    size_t pos = LD2410_CAPTURE_HEADER_LENGTH;
+    std::vector<uint8_t> logged;
+    int chunks = 0;
+    while (pos < sink.bytes.size()) {
+        const uint32_t delta = varint(sink.bytes, &pos);
+        const uint32_t length = varint(sink.bytes, &pos);
+        CHECK(delta > 0);
+        CHECK(length == 23);
+        logged.insert(logged.end(), sink.bytes.begin() + pos, sink.bytes.begin() + pos + length);
+        pos += length;
+        chunks++;
+    }
+    CHECK(chunks == 3);
+    CHECK(logged == sent);
+    CHECK(sink.bytes.size() == LD2410_CAPTURE_HEADER_LENGTH + 3 * 23 + 3 * 2);
+    std::printf("ok\n");
+}
+
+// Concatenates the chunks' bytes, checking the log is well formed.
+static std::vector<uint8_t> logged_bytes(const std::vector<uint8_t>& log) {
+    size_t pos = LD2410_CAPTURE_HEADER_LENGTH;
+    std::vector<uint8_t> bytes;
+    while (pos < log.size()) {
+        varint(log, &pos);
+        const uint32_t length = varint(log, &pos);
+        CHECK(pos + length <= log.size());
+        if (pos + length > log.size()) break;
+        bytes.insert(bytes.end(), log.begin() + pos, log.begin() + pos + length);
+        pos += length;
+    }
+    return bytes;
+}
+
+// A restart's ACKs are parsed and what the radar sends while it reboots is
+// thrown away; the capture still holds every byte the sensor took, in order.
+static void test_capture_across_command() {
+    std::printf("test_capture_across_command ... ");
+    ld2410 r;
+    AnsweringRadar s;
+    r.begin(s, false);
+    LogSink sink;
+    r.startCapture(sink);
+    s.inject(basic_frame(40));
+    r.read();
+    s.replies.push_back(ack(0xFF, true, 8));
+    s.replies.push_back(ack(0xA3));
+    s.replies.push_back(ack(0xFE));
+    const ld2410_command_handle handle = r.queueCommand(ld2410_command::requestRestart());
+    while (!s.replies.empty() || s.available() > 0) r.read();
+    r.read();
+    CHECK(r.commandsPending());                                         // Rebooting, reception muted
+    s.inject({0x00, 0xF4, 0xF3, 0x13, 0x37, 0xFF});
+    r.read();
+    CHECK(s.available() == 0);
+    while (r.commandsPending()) r.read();
+    CHECK(r.commandStatus(handle) == LD2410_COMMAND_SUCCEEDED);
+    s.inject(basic_frame(42));
+    r.read();
+    r.stopCapture();
+    CHECK(r.getSnapshot().moving_target_distance == 42);
+
+    CHECK(s.pos == s.rx.size());
+    CHECK(logged_bytes(sink.bytes) == s.rx);
+    std::printf("ok\n");
+}
+
+// A capture replayed at maximum speed gives a second sensor the same frames
+// as the first, chunk for chunk.
+static void test_replay_round_trip() {
+    std::printf("test_replay_round_trip ... ");
+    ld2410 original;
+    LockedSerial s;
+    original.begin(s, false);
+    LogSink sink;
+    original.startCapture(sink);
+    for (int i = 0; i < 200; i++) {
+        std::vector<uint8_t> bytes = basic_frame((uint8_t)(i % 150));
+        if (i % 7 == 0) bytes.insert(bytes.begin(), {0x00, 0xF4, 0x13});   // line noise
+        if (i % 3 == 0) {
+            // Split across two reads, as a UART FIFO often does.
+            s.inject(std::vector<uint8_t>(bytes.begin(), bytes.begin() + 9));
+            original.read();
+            s.inject(std::vector<uint8_t>(bytes.begin() + 9, bytes.end()));
+        } else {
+            s.inject(bytes);
+        }
+        original.read();
+    }
+    const RadarSnapshot expected = original.getSnapshot();
+    CHECK(expected.sequence == 200);
+
+    ld2410_replay_stream replay;
+    CHECK(replay.begin(sink.bytes.data(), sink.bytes.size(), LD2410_REPLAY_MAX_SPEED));
+    ld2410 copy;
+    copy.begin(replay, false);
+    while (!replay.done()) copy.waitAndRead(0);
+    const RadarSnapshot replayed = copy.getSnapshot();
+    CHECK(replayed.sequence == expected.sequence);
+    CHECK(replayed.moving_target_distance == expected.moving_target_distance);
+
+    // Played again from the start.
+    replay.rewind();
+    ld2410 again;
+    again.begin(replay, false);
+    while (!replay.done()) again.waitAndRead(0);
+    CHECK(again.getSnapshot().sequence == 200);
+    std::printf("ok\n");
+}
+
+static void test_replay_pacing() {
+    std::printf("test_replay_pacing ... ");
+    std::vector<uint8_t> log = header(1, 2, 3);
+    append_chunk(log, 0, {0x01, 0x02});
+    append_chunk(log, 2000, {0x03});
+    append_chunk(log, 2000, {0x04, 0x05, 0x06});
+
+    ld2410_replay_stream replay;
+    CHECK(replay.begin(log.data(), log.size()));
+    CHECK(replay.firmware_major_version == 1 && replay.firmware_minor_version == 2 && replay.firmware_bugfix_version == 3);
+    CHECK(replay.available() == 2);
+    CHECK(replay.read() == 0x01);
+    CHECK(replay.available() == 1);                 // one chunk at a time
+    CHECK(replay.read() == 0x02);
+
+    // The host micros() ticks once per call, so polling counts microseconds.
+    int polls = 0;
+    while (replay.available() == 0) polls++;
+    CHECK(polls >= 1900 && polls <= 2000);
+    CHECK(replay.read() == 0x03);
+
+    // Ten times faster.
+    CHECK(replay.begin(log.data(), log.size(), 10));
+    uint8_t buf[8];
+    CHECK(replay.readBytes(buf, sizeof(buf)) == 2);
+    polls = 0;
+    while (replay.available() == 0) polls++;
+    CHECK(polls >= 190 && polls <= 200);
+    CHECK(replay.readBytes(buf, sizeof(buf)) == 1);
+    while (replay.available() == 0) {}
+    CHECK(replay.readBytes(buf, sizeof(buf)) == 3 && buf[2] == 0x06);
+    CHECK(replay.done());
+    CHECK(replay.read() == -1);
+    CHECK(replay.write(buf, 3) == 3);               // commands go nowhere
+
+    // Not a capture, or a truncated one.
+    std::vector<uint8_t> bad = log;
+    bad[0] = 'X';
+    CHECK(!replay.begin(bad.data(), bad.size()));
+    CHECK(replay.available() == 0 && replay.done());
+    CHECK(replay.begin(log.data(), log.size() - 1, LD2410_REPLAY_MAX_SPEED));
+    CHECK(replay.readBytes(buf, sizeof(buf)) == 2);
+    CHECK(replay.readBytes(buf, sizeof(buf)) == 1);
+    CHECK(replay.readBytes(buf, sizeof(buf)) == 0);
+    CHECK(replay.done());
+    std::printf("ok\n");
+}
+
+int main() {
+    test_capture_format();
+    test_capture_across_command();
+    test_replay_round_trip();
+    test_replay_pacing();
+
+    return test_result();
+}
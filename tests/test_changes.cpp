@@ -0,0 +1,128 @@
+// Native host-side tests for change detection (RadarSnapshot::changed,
+// setChangeThresholds(), takeChanges(), onChange()).
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "test_common.h"
+#include <cstdio>
+#include <vector>
+
+// The target of basic_frame(1, 100, 50, 0, 0, 100) with every gate at `gate_energy`.
+static std::vector<uint8_t> engineering_frame(uint8_t gate_energy) {
+    std::vector<uint8_t> f = {
+        0xF4, 0xF3, 0xF2, 0xF1, 0x23, 0x00,
+        0x01, 0xAA, 0x01,
+        100, 0x00, 50, 0x00, 0x00, 0x00, 100, 0x00,
+        0x08, 0x08
+    };
+    for (int g = 0; g < 18; g++) f.push_back(gate_energy);
+    f.insert(f.end(), {0x00, 0x00, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5});
+    return f;
+}
+
+// Feeds one frame and returns the changed bits of the snapshot it produced.
+static uint16_t changed_by(ld2410& r, LockedSerial& s, const std::vector<uint8_t>& frame) {
+    s.inject(frame);
+    while (s.available() > 0) r.read();
+    return r.getSnapshot().changed;
+}
+
+static void test_deadbands() {
+    std::printf("test_deadbands ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    r.setChangeThresholds(10, 5);
+
+    CHECK(changed_by(r, s, basic_frame(1, 100, 50, 0, 0, 100)) == LD2410_CHANGED_ALL);
+    CHECK(changed_by(r, s, basic_frame(1, 100, 50, 0, 0, 100)) == 0);
+    // Jitter inside the deadbands is not a change.
+    CHECK(changed_by(r, s, basic_frame(1, 108, 54, 0, 0, 92)) == 0);
+    CHECK(changed_by(r, s, basic_frame(1, 95, 47, 0, 0, 105)) == 0);
+    // Measured from the last reported value, so a slow drift is reported.
+    CHECK(changed_by(r, s, basic_frame(1, 111, 50, 0, 0, 100)) == LD2410_CHANGED_MOVING_DISTANCE);
+    CHECK(changed_by(r, s, basic_frame(1, 118, 50, 0, 0, 100)) == 0);
+    CHECK(changed_by(r, s, basic_frame(1, 122, 56, 0, 0, 100)) ==
+          (LD2410_CHANGED_MOVING_DISTANCE | LD2410_CHANGED_MOVING_ENERGY));
+    // Target state flips.
+    CHECK(changed_by(r, s, basic_frame(3, 122, 56, 200, 40, 200)) ==
+          (LD2410_CHANGED_STATIONARY_TARGET | LD2410_CHANGED_STATIONARY_DISTANCE |
+           LD2410_CHANGED_STATIONARY_ENERGY | LD2410_CHANGED_DETECTION_DISTANCE));
+    CHECK(changed_by(r, s, basic_frame(2, 0, 0, 200, 40, 200)) ==
+          (LD2410_CHANGED_MOVING_TARGET | LD2410_CHANGED_MOVING_DISTANCE | LD2410_CHANGED_MOVING_ENERGY));
+    CHECK(changed_by(r, s, basic_frame(0, 0, 0, 0, 0, 0)) ==
+          (LD2410_CHANGED_PRESENCE | LD2410_CHANGED_STATIONARY_TARGET | LD2410_CHANGED_STATIONARY_DISTANCE |
+           LD2410_CHANGED_STATIONARY_ENERGY | LD2410_CHANGED_DETECTION_DISTANCE));
+
+    // Engineering frames: mode switch and per-gate energies.
+    CHECK(changed_by(r, s, engineering_frame(30)) & LD2410_CHANGED_ENGINEERING);
+    CHECK(changed_by(r, s, engineering_frame(33)) == 0);
+    CHECK(changed_by(r, s, engineering_frame(36)) == LD2410_CHANGED_GATE_ENERGY);
+    CHECK(changed_by(r, s, basic_frame(1, 100, 50, 0, 0, 100)) == LD2410_CHANGED_ENGINEERING);
+    std::printf("ok\n");
+}
+
+// A new target state has to last stateFrames frames; a one-frame dropout is
+// absorbed.
+static void test_state_hysteresis() {
+    std::printf("test_state_hysteresis ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    r.setChangeThresholds(10, 5, 3);
+
+    changed_by(r, s, basic_frame(1, 100, 50, 0, 0, 100));
+    CHECK(changed_by(r, s, basic_frame(0, 100, 50, 0, 0, 100)) == 0);
+    CHECK(changed_by(r, s, basic_frame(1, 100, 50, 0, 0, 100)) == 0);
+    CHECK(changed_by(r, s, basic_frame(0, 100, 50, 0, 0, 100)) == 0);
+    CHECK(changed_by(r, s, basic_frame(0, 100, 50, 0, 0, 100)) == 0);
+    CHECK(changed_by(r, s, basic_frame(0, 100, 50, 0, 0, 100)) ==
+          (LD2410_CHANGED_PRESENCE | LD2410_CHANGED_MOVING_TARGET));
+    CHECK(changed_by(r, s, basic_frame(0, 100, 50, 0, 0, 100)) == 0);
+    std::printf("ok\n");
+}
+
+static void on_change(ld2410_base&, const RadarSnapshot& snapshot, void* context) {
+    std::vector<uint16_t>* seen = static_cast<std::vector<uint16_t>*>(context);
+    seen->push_back(snapshot.changed);
+}
+
+static void test_take_and_callback() {
+    std::printf("test_take_and_callback ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    std::vector<uint16_t> seen;
+    r.onChange(on_change, &seen);
+    CHECK(r.takeChanges() == 0);
+
+    changed_by(r, s, basic_frame(1, 100, 50, 0, 0, 100));
+    CHECK(r.takeChanges() == LD2410_CHANGED_ALL);
+    CHECK(r.takeChanges() == 0);
+    changed_by(r, s, basic_frame(1, 100, 50, 0, 0, 100));
+    changed_by(r, s, basic_frame(1, 150, 50, 0, 0, 100));
+    changed_by(r, s, basic_frame(1, 150, 80, 0, 0, 100));
+    // Bits from frames the consumer did not look at accumulate.
+    CHECK(r.takeChanges() == (LD2410_CHANGED_MOVING_DISTANCE | LD2410_CHANGED_MOVING_ENERGY));
+    // The callback only runs for frames that changed something.
+    CHECK((seen == std::vector<uint16_t>{LD2410_CHANGED_ALL, LD2410_CHANGED_MOVING_DISTANCE,
+                                         LD2410_CHANGED_MOVING_ENERGY}));
+
+    // Off unless asked for.
+    ld2410 quiet;
+    LockedSerial t;
+    quiet.begin(t, false);
+    CHECK(changed_by(quiet, t, basic_frame(1, 100, 50, 0, 0, 100)) == 0);
+    CHECK(quiet.takeChanges() == 0);
+    std::printf("ok\n");
+}
+
+int main() {
+    test_deadbands();
+    test_state_hysteresis();
+    test_take_and_callback();
+
+    return test_result();
+}
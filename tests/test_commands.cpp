@@ -0,0 +1,536 @@
+// Native host-side unit test for the asynchronous command engine.
+// Commands are queued with queueCommand() and driven to completion by
+// read(), the way a sketch's loop() or the autoReadTask would, against a
+// mock radar that releases a staged ACK each time a command frame ends.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "test_common.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+// Mock UART: records everything written, and releases the next staged
+// response when a command footer (04 03 02 01) goes out.
+class MockRadar : public Stream {
+    std::vector<uint8_t> rx_;
+    size_t pos_ = 0;
+    std::vector<std::vector<uint8_t>> responses_;
+public:
+    std::vector<uint8_t> written;
+    std::function<void(int)> on_footer;   // called with the count of command frames written so far
+    int footers = 0;
+
+    void inject(const std::vector<uint8_t>& bytes) { rx_.insert(rx_.end(), bytes.begin(), bytes.end()); }
+    void stage(const std::vector<uint8_t>& bytes) { responses_.push_back(bytes); }
+    int available() override { return (int)(rx_.size() - pos_); }
+    int read() override { return pos_ < rx_.size() ? rx_[pos_++] : -1; }
+    size_t single_writes = 0;   // write(uint8_t) calls
+    size_t bulk_writes = 0;     // write(buf, n) calls
+
+    size_t write(uint8_t b) override {
+        single_writes++;
+        record(b);
+        return 1;
+    }
+    size_t write(const uint8_t* buf, size_t n) override {
+        bulk_writes++;
+        for (size_t i = 0; i < n; i++) record(buf[i]);
+        return n;
+    }
+
+    // Command words of every frame written so far, in order.
+    std::vector<uint8_t> opcodes() const {
+        std::vector<uint8_t> ops;
+        for (size_t i = 0; i + 6 < written.size(); i++) {
+            if (written[i] == 0xFD && written[i + 1] == 0xFC && written[i + 2] == 0xFB && written[i + 3] == 0xFA) {
+                ops.push_back(written[i + 6]);
+            }
+        }
+        return ops;
+    }
+
+private:
+    void record(uint8_t b) {
+        written.push_back(b);
+        const size_t n = written.size();
+        if (n >= 4 && written[n - 4] == 0x04 && written[n - 3] == 0x03 &&
+            written[n - 2] == 0x02 && written[n - 1] == 0x01 && !responses_.empty()) {
+            inject(responses_.front());
+            responses_.erase(responses_.begin());
+        }
+        if (n >= 4 && written[n - 4] == 0x04 && written[n - 3] == 0x03 &&
+            written[n - 2] == 0x02 && written[n - 1] == 0x01 && on_footer) {
+            on_footer(++footers);
+        }
+    }
+};
+
+static std::vector<uint8_t> firmware_ack(uint8_t major, uint8_t minor) {
+    return {
+        0xFD, 0xFC, 0xFB, 0xFA, 0x0C, 0x00,
+        0xA0, 0x01, 0x00, 0x00, 0x01, 0x00,
+        minor, major, 0x16, 0x15, 0x09, 0x22,
+        0x04, 0x03, 0x02, 0x01
+    };
+}
+
+// Step the engine through read() until nothing is pending, with a bound so a
+// stuck engine fails the test instead of hanging it.
+static int pump(ld2410& radar) {
+    int calls = 0;
+    while (radar.commandsPending() && calls < 100000) {
+        radar.read();
+        calls++;
+    }
+    return calls;
+}
+
+struct Completion {
+    int calls = 0;
+    ld2410_command_handle handle = 0;
+    ld2410_command_status status = LD2410_COMMAND_UNKNOWN;
+};
+
+static void on_done(ld2410_base &, ld2410_command_handle handle, ld2410_command_status status, void *context) {
+    Completion* c = static_cast<Completion*>(context);
+    c->calls++;
+    c->handle = handle;
+    c->status = status;
+}
+
+// queueCommand() returns at once; read() runs enter -> command -> leave and
+// the callback reports the ACK, with the firmware fields already decoded.
+static void test_queue_with_callback() {
+    std::printf("test_queue_with_callback ... ");
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    s.stage(ack(0xFF, true, 8));
+    s.stage(firmware_ack(1, 7));
+    s.stage(ack(0xFE));
+
+    Completion done;
+    const ld2410_command_handle h = radar.queueCommand(ld2410_command::requestFirmwareVersion(), on_done, &done);
+    CHECK(h != 0);
+    CHECK(s.written.empty());
+    CHECK(radar.commandStatus(h) == LD2410_COMMAND_QUEUED);
+    pump(radar);
+    CHECK(done.calls == 1);
+    CHECK(done.handle == h);
+    CHECK(done.status == LD2410_COMMAND_SUCCEEDED);
+    CHECK(radar.firmware_major_version == 1 && radar.firmware_minor_version == 7);
+    CHECK((s.opcodes() == std::vector<uint8_t>{0xFF, 0xA0, 0xFE}));
+    CHECK(radar.commandStatus(h) == LD2410_COMMAND_UNKNOWN);	// a callback consumes the result
+    std::printf("ok\n");
+}
+
+// Data frames keep being parsed while a command waits out its gaps.
+static void test_data_flows_during_command() {
+    std::printf("test_data_flows_during_command ... ");
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    s.stage(ack(0xFF, true, 8));
+    s.stage(ack(0x61, true, 0x1C));
+    s.stage(ack(0xFE));
+
+    const ld2410_command_handle h = radar.queueCommand(ld2410_command::requestCurrentConfiguration());
+    radar.read();		// sends enter-config
+    radar.read();		// parses its ACK, starts the 50 ms gap
+    CHECK(radar.commandStatus(h) == LD2410_COMMAND_RUNNING);
+    s.inject(kBasicFrame);
+    radar.read();
+    CHECK(radar.getSnapshot().sequence == 1);
+    CHECK(radar.movingTargetDistance() == 0x51);
+    CHECK(radar.commandsPending());
+    pump(radar);
+    CHECK(radar.commandStatus(h) == LD2410_COMMAND_SUCCEEDED);
+    CHECK(radar.commandStatus(h) == LD2410_COMMAND_UNKNOWN);	// collected
+    std::printf("ok\n");
+}
+
+// Queued commands run one configuration window each, in queue order, and
+// the setMaxValues frame matches the protocol example (§2.2.3).
+static void test_fifo_and_encoding() {
+    std::printf("test_fifo_and_encoding ... ");
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    for (uint8_t op : {0x60, 0x64}) {
+        s.stage(ack(0xFF, true, 8));
+        s.stage(ack(op));
+        s.stage(ack(0xFE));
+    }
+    const ld2410_command_handle a = radar.queueCommand(ld2410_command::setMaxValues(8, 8, 5));
+    const ld2410_command_handle b = radar.queueCommand(ld2410_command::setGateSensitivityThreshold(3, 40, 40));
+    pump(radar);
+    CHECK(radar.commandStatus(a) == LD2410_COMMAND_SUCCEEDED);
+    CHECK(radar.commandStatus(b) == LD2410_COMMAND_SUCCEEDED);
+    CHECK((s.opcodes() == std::vector<uint8_t>{0xFF, 0x60, 0xFE, 0xFF, 0x64, 0xFE}));
+
+    const std::vector<uint8_t> max_values = {
+        0xFD, 0xFC, 0xFB, 0xFA, 0x14, 0x00, 0x60, 0x00,
+        0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+        0x01, 0x00, 0x08, 0x00, 0x00, 0x00,
+        0x02, 0x00, 0x05, 0x00, 0x00, 0x00,
+        0x04, 0x03, 0x02, 0x01
+    };
+    const std::vector<uint8_t> sensitivity = {
+        0xFD, 0xFC, 0xFB, 0xFA, 0x14, 0x00, 0x64, 0x00,
+        0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+        0x01, 0x00, 0x28, 0x00, 0x00, 0x00,
+        0x02, 0x00, 0x28, 0x00, 0x00, 0x00,
+        0x04, 0x03, 0x02, 0x01
+    };
+    CHECK(std::search(s.written.begin(), s.written.end(), max_values.begin(), max_values.end()) != s.written.end());
+    CHECK(std::search(s.written.begin(), s.written.end(), sensitivity.begin(), sensitivity.end()) != s.written.end());
+    std::printf("ok\n");
+}
+
+static std::vector<uint8_t> encoded(const ld2410_command& command) {
+    uint8_t frame[LD2410_MAX_COMMAND_FRAME_LENGTH];
+    const uint8_t length = command.encode(frame);
+    CHECK(length == command.frame_length());
+    return std::vector<uint8_t>(frame, frame + length);
+}
+
+// Frames byte for byte against the examples in docs/HLK-LD2410C_protocol.md,
+// and each one goes to the UART in a single write().
+static void test_command_frames() {
+    std::printf("test_command_frames ... ");
+    static_assert(ld2410_command::requestFirmwareVersion().frame_length() == 12, "A0 frame length");
+    static_assert(ld2410_command::setGateSensitivityThreshold(0, 0, 0).frame_length() == 30, "64 frame length");
+    CHECK((encoded(ld2410_command::enterConfigurationMode()) == std::vector<uint8_t>{
+        0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xFF, 0x00, 0x01, 0x00, 0x04, 0x03, 0x02, 0x01}));
+    CHECK((encoded(ld2410_command::leaveConfigurationMode()) == std::vector<uint8_t>{
+        0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, 0xFE, 0x00, 0x04, 0x03, 0x02, 0x01}));
+    CHECK((encoded(ld2410_command::requestCurrentConfiguration()) == std::vector<uint8_t>{
+        0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, 0x61, 0x00, 0x04, 0x03, 0x02, 0x01}));
+    CHECK((encoded(ld2410_command::requestFirmwareVersion()) == std::vector<uint8_t>{
+        0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, 0xA0, 0x00, 0x04, 0x03, 0x02, 0x01}));
+    CHECK((encoded(ld2410_command::requestMacAddress()) == std::vector<uint8_t>{
+        0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xA5, 0x00, 0x01, 0x00, 0x04, 0x03, 0x02, 0x01}));
+    CHECK((encoded(ld2410_command::setMaxValues(8, 8, 5)) == std::vector<uint8_t>{
+        0xFD, 0xFC, 0xFB, 0xFA, 0x14, 0x00, 0x60, 0x00,
+        0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+        0x01, 0x00, 0x08, 0x00, 0x00, 0x00,
+        0x02, 0x00, 0x05, 0x00, 0x00, 0x00,
+        0x04, 0x03, 0x02, 0x01}));
+    CHECK((encoded(ld2410_command::make(0x64, 3, 0xFFFF, 40, 40)) == std::vector<uint8_t>{
+        0xFD, 0xFC, 0xFB, 0xFA, 0x14, 0x00, 0x64, 0x00,
+        0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00,
+        0x01, 0x00, 0x28, 0x00, 0x00, 0x00,
+        0x02, 0x00, 0x28, 0x00, 0x00, 0x00,
+        0x04, 0x03, 0x02, 0x01}));
+
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    s.stage(ack(0xFF, true, 8));
+    s.stage(firmware_ack(1, 7));
+    s.stage(ack(0xFE));
+    CHECK(radar.requestFirmwareVersion());
+    CHECK(s.bulk_writes == 3);
+    CHECK(s.single_writes == 0);
+    std::printf("ok\n");
+}
+
+// A refused enter-config fails the command but still leaves config mode; a
+// silent radar times out.
+static void test_nak_and_timeout() {
+    std::printf("test_nak_and_timeout ... ");
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    s.stage(ack(0xFF, false, 8));
+    s.stage(ack(0xFE));
+    const ld2410_command_handle nak = radar.queueCommand(ld2410_command::requestFactoryReset());
+    pump(radar);
+    CHECK(radar.commandStatus(nak) == LD2410_COMMAND_FAILED);
+    CHECK((s.opcodes() == std::vector<uint8_t>{0xFF, 0xFE}));
+
+    const ld2410_command_handle silent = radar.queueCommand(ld2410_command::requestFirmwareVersion());
+    pump(radar);
+    CHECK(radar.commandStatus(silent) == LD2410_COMMAND_TIMED_OUT);
+    std::printf("ok\n");
+}
+
+// A full queue refuses new commands; finished but uncollected results are
+// recycled before that happens.
+static void test_queue_full() {
+    std::printf("test_queue_full ... ");
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    ld2410_command_handle handles[LD2410_COMMAND_QUEUE_LENGTH];
+    for (int i = 0; i < LD2410_COMMAND_QUEUE_LENGTH; i++) {
+        handles[i] = radar.queueCommand(ld2410_command::requestFirmwareVersion());
+        CHECK(handles[i] != 0);
+    }
+    CHECK(radar.queueCommand(ld2410_command::requestFirmwareVersion()) == 0);
+    pump(radar);	// all time out, nobody collects them
+    const ld2410_command_handle h = radar.queueCommand(ld2410_command::requestFirmwareVersion());
+    CHECK(h != 0);
+    CHECK(radar.commandStatus(handles[0]) == LD2410_COMMAND_UNKNOWN);	// its slot was recycled
+    CHECK(radar.commandStatus(h) == LD2410_COMMAND_QUEUED);
+    std::printf("ok\n");
+}
+
+// A blocking call's finished command is not recycled while the call is
+// still to collect it. The engine starts the next command as soon as the
+// blocking one finishes, before the caller looks at its status; queueing a
+// full queue's worth from there must not take the caller's slot.
+static void test_waited_slot_not_recycled() {
+    std::printf("test_waited_slot_not_recycled ... ");
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    s.stage(ack(0xFF, true, 8));
+    s.stage(firmware_ack(1, 7));
+    s.stage(ack(0xFE));
+    std::vector<ld2410_command_handle> queued;
+    s.on_footer = [&](int frames) {
+        if (frames == 1) {          // The blocking command's enter-config: queue one behind it
+            queued.push_back(radar.queueCommand(ld2410_command::requestMacAddress()));
+        } else if (frames == 4) {   // That one's enter-config, the blocking one just finished
+            for (int i = 0; i < LD2410_COMMAND_QUEUE_LENGTH - 1; i++) {
+                queued.push_back(radar.queueCommand(ld2410_command::requestMacAddress()));
+            }
+        }
+    };
+    CHECK(radar.requestFirmwareVersion());
+    CHECK(radar.firmware_major_version == 1);
+    CHECK(queued.size() == LD2410_COMMAND_QUEUE_LENGTH);
+    CHECK(queued[0] != 0 && queued[1] != 0 && queued[2] != 0);
+    CHECK(queued[3] == 0);          // Full: the finished blocking command's slot was kept
+    s.on_footer = nullptr;
+    // Once collected, the slot is free again.
+    CHECK(radar.queueCommand(ld2410_command::requestMacAddress()) != 0);
+    std::printf("ok\n");
+}
+
+// A whole provisioning run -- nine gates, max values, read-back -- goes out
+// in one configuration window.
+static void test_transaction_single_window() {
+    std::printf("test_transaction_single_window ... ");
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    ld2410_transaction tx;
+    tx.begin();
+    std::vector<uint8_t> expected = {0xFF};
+    s.stage(ack(0xFF, true, 8));
+    for (uint8_t gate = 0; gate < 9; gate++) {
+        CHECK(tx.append(ld2410_command::setGateSensitivityThreshold(gate, 50, 40)));
+        s.stage(ack(0x64));
+        expected.push_back(0x64);
+    }
+    CHECK(tx.append(ld2410_command::setMaxValues(8, 8, 5)));
+    s.stage(ack(0x60));
+    CHECK(tx.append(ld2410_command::requestCurrentConfiguration()));
+    s.stage(ack(0x61, true, 0x1C));
+    s.stage(ack(0xFE));
+    expected.insert(expected.end(), {0x60, 0x61, 0xFE});
+
+    CHECK(radar.commitTransaction(tx));
+    CHECK(s.opcodes() == expected);
+    CHECK(tx.size() == 11);
+    CHECK(tx.firstFailure() == -1);
+    for (uint8_t i = 0; i < tx.size(); i++) {
+        CHECK(tx.result(i) == LD2410_COMMAND_SUCCEEDED);
+    }
+    std::printf("ok\n");
+}
+
+// The first NAK ends the window; later commands are never sent.
+static void test_transaction_stops_at_nak() {
+    std::printf("test_transaction_stops_at_nak ... ");
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    s.stage(ack(0xFF, true, 8));
+    s.stage(ack(0x64));
+    s.stage(ack(0x64, false));
+    s.stage(ack(0xFE));
+    ld2410_transaction tx;
+    tx.begin();
+    tx.append(ld2410_command::setGateSensitivityThreshold(0, 50, 40));
+    tx.append(ld2410_command::setGateSensitivityThreshold(1, 50, 40));
+    tx.append(ld2410_command::setMaxValues(8, 8, 5));
+
+    Completion done;
+    const ld2410_command_handle h = radar.queueTransaction(tx, on_done, &done);
+    CHECK(h != 0);
+    pump(radar);
+    CHECK(done.calls == 1);
+    CHECK(done.status == LD2410_COMMAND_FAILED);
+    CHECK((s.opcodes() == std::vector<uint8_t>{0xFF, 0x64, 0x64, 0xFE}));
+    CHECK(tx.result(0) == LD2410_COMMAND_SUCCEEDED);
+    CHECK(tx.result(1) == LD2410_COMMAND_FAILED);
+    CHECK(tx.result(2) == LD2410_COMMAND_SKIPPED);
+    CHECK(tx.firstFailure() == 1);
+
+    // A refused enter-config is charged to the first command
+    s.stage(ack(0xFF, false, 8));
+    s.stage(ack(0xFE));
+    CHECK(!radar.commitTransaction(tx));
+    CHECK(tx.result(0) == LD2410_COMMAND_FAILED);
+    CHECK(tx.result(1) == LD2410_COMMAND_SKIPPED);
+    CHECK(tx.result(2) == LD2410_COMMAND_SKIPPED);
+    std::printf("ok\n");
+}
+
+static void test_transaction_limits() {
+    std::printf("test_transaction_limits ... ");
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    ld2410_transaction tx;
+    tx.begin();
+    CHECK(radar.queueTransaction(tx) == 0);		// nothing to send
+    CHECK(radar.commitTransaction(tx));
+    CHECK(s.written.empty());
+    for (int i = 0; i < LD2410_MAX_TRANSACTION_COMMANDS; i++) {
+        CHECK(tx.append(ld2410_command::requestFirmwareVersion()));
+    }
+    CHECK(!tx.append(ld2410_command::requestFirmwareVersion()));
+    CHECK(tx.size() == LD2410_MAX_TRANSACTION_COMMANDS);
+    std::printf("ok\n");
+}
+
+// ACKs that carry a value are decoded through the dispatch table: MAC
+// address (§2.2.13) and distance resolution (§2.2.17), as in the protocol
+// examples. A value is only decoded from a successful ACK of the expected
+// length.
+static void test_ack_decoders() {
+    std::printf("test_ack_decoders ... ");
+    ld2410 radar;
+    MockRadar s;
+    radar.begin(s, false);
+    s.stage(ack(0xFF, true, 8));
+    s.stage({0xFD, 0xFC, 0xFB, 0xFA, 0x0A, 0x00, 0xA5, 0x01, 0x00, 0x00,
+             0x8F, 0x27, 0x2E, 0xB8, 0x0F, 0x65, 0x04, 0x03, 0x02, 0x01});
+    s.stage(ack(0xFE));
+    CHECK(radar.requestMacAddress());
+    const uint8_t mac[6] = {0x8F, 0x27, 0x2E, 0xB8, 0x0F, 0x65};
+    CHECK(std::memcmp(radar.mac_address, mac, 6) == 0);
+
+    s.stage(ack(0xFF, true, 8));
+    s.stage({0xFD, 0xFC, 0xFB, 0xFA, 0x06, 0x00, 0xAB, 0x01, 0x00, 0x00,
+             0x01, 0x00, 0x04, 0x03, 0x02, 0x01});
+    s.stage(ack(0xFE));
+    CHECK(radar.requestDistanceResolution());
+    CHECK(radar.distance_resolution == 1);
+
+    s.stage(ack(0xFF, true, 8));
+    s.stage(ack(0xAA));
+    s.stage(ack(0xFE));
+    CHECK(radar.setDistanceResolution(1));
+    const size_t sent = s.written.size();
+    CHECK(!radar.setDistanceResolution(2));         // only 0.75m and 0.2m exist
+    CHECK(s.written.size() == sent);
+
+    // Truncated configuration ACK: accepted, but nothing decoded from it
+    s.stage(ack(0xFF, true, 8));
+    s.stage(ack(0x61, true, 8));
+    s.stage(ack(0xFE));
+    CHECK(radar.requestCurrentConfiguration());
+    CHECK(radar.max_gate == 0);
+
+    // NAKed query: no decode, command fails
+    s.stage(ack(0xFF, true, 8));
+    s.stage({0xFD, 0xFC, 0xFB, 0xFA, 0x06, 0x00, 0xAB, 0x01, 0x01, 0x00,
+             0x00, 0x00, 0x04, 0x03, 0x02, 0x01});
+    s.stage(ack(0xFE));
+    CHECK(!radar.requestDistanceResolution());
+    CHECK(radar.distance_resolution == 1);
+    std::printf("ok\n");
+}
+
+// Without begin() there is no UART to send on.
+static void test_no_uart() {
+    std::printf("test_no_uart ... ");
+    ld2410 radar;
+    CHECK(radar.queueCommand(ld2410_command::requestFirmwareVersion()) == 0);
+    CHECK(!radar.requestFirmwareVersion());
+    std::printf("ok\n");
+}
+
+// Passive startup takes the first data frame as proof the radar is there and
+// leaves the firmware query to read(); with no data frame it falls back to
+// the query, which is all begin(stream, true) does.
+static void test_startup_modes() {
+    std::printf("test_startup_modes ... ");
+    {
+        ld2410 radar;
+        MockRadar s;
+        s.inject(kBasicFrame);
+        s.stage(ack(0xFF, true, 8));
+        s.stage(firmware_ack(2, 4));
+        s.stage(ack(0xFE));
+        CHECK(radar.begin(s, LD2410_STARTUP_PASSIVE));
+        CHECK(s.written.empty());                   // nothing sent before the first reading
+        CHECK(radar.movingTargetDistance() == 0x51);
+        CHECK(radar.firmware_major_version == 0);
+        CHECK(radar.commandsPending());
+        pump(radar);
+        CHECK((s.opcodes() == std::vector<uint8_t>{0xFF, 0xA0, 0xFE}));
+        CHECK(radar.firmware_major_version == 2 && radar.firmware_minor_version == 4);
+        // Finished, the query leaves every slot to the sketch.
+        for (int i = 0; i < LD2410_COMMAND_QUEUE_LENGTH; i++) {
+            CHECK(radar.queueCommand(ld2410_command::requestFirmwareVersion()) != 0);
+        }
+    }
+    {
+        // Silent, eg. left in configuration mode: one firmware query.
+        ld2410 radar;
+        MockRadar s;
+        s.stage(ack(0xFF, true, 8));
+        s.stage(firmware_ack(2, 4));
+        s.stage(ack(0xFE));
+        CHECK(radar.begin(s, LD2410_STARTUP_PASSIVE, 50));
+        CHECK((s.opcodes() == std::vector<uint8_t>{0xFF, 0xA0, 0xFE}));
+        CHECK(radar.firmware_major_version == 2);
+        CHECK(!radar.commandsPending());
+    }
+    {
+        ld2410 radar;
+        MockRadar s;
+        CHECK(!radar.begin(s, LD2410_STARTUP_PASSIVE, 50));
+        CHECK((s.opcodes() == std::vector<uint8_t>{0xFF, 0xFE}));
+    }
+    {
+        ld2410 radar;
+        MockRadar s;
+        s.inject(kBasicFrame);
+        s.stage(ack(0xFF, true, 8));
+        s.stage(firmware_ack(1, 7));
+        s.stage(ack(0xFE));
+        CHECK(radar.begin(s));                      // LD2410_STARTUP_FIRMWARE
+        CHECK(radar.firmware_major_version == 1 && radar.firmware_minor_version == 7);
+        CHECK(radar.begin(s, LD2410_STARTUP_NO_WAIT));
+    }
+    std::printf("ok\n");
+}
+
+int main() {
+    test_queue_with_callback();
+    test_data_flows_during_command();
+    test_fifo_and_encoding();
+    test_command_frames();
+    test_nak_and_timeout();
+    test_queue_full();
+    test_waited_slot_not_recycled();
+    test_transaction_single_window();
+    test_transaction_stops_at_nak();
+    test_transaction_limits();
+    test_ack_decoders();
+    test_no_uart();
+    test_startup_modes();
+    return test_result();
+}
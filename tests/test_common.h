@@ -0,0 +1,38 @@
+// Shared pieces of the host-side tests (tests/test_*.cpp): the CHECK macro and
+// its failure count, the radar's frames and feeding them to a sensor.
+//
+// Each test prints "test_name ... ok" as it passes and main() ends with
+// `return test_result();`.
+#pragma once
+#include <Arduino.h>
+#include <ld2410.h>
+#include "locked_serial.h"
+#include "radar_frames.h"
+#include <cstdio>
+#include <vector>
+
+inline int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "FAIL %s:%d  %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+// Hands the bytes to the sensor and parses every frame among them.
+inline void feed(ld2410_base& r, LockedSerial& s, const std::vector<uint8_t>& bytes) {
+    s.inject(bytes);
+    while (s.available() > 0) r.read();
+    while (r.read()) {}
+}
+
+// Prints the summary and gives main() its exit code.
+inline int test_result() {
+    if (failures == 0) {
+        std::printf("\nALL TESTS PASS\n");
+        return 0;
+    }
+    std::printf("\n%d FAILURE(S)\n", failures);
+    return 1;
+}
@@ -0,0 +1,177 @@
+// Native host-side tests for the ld2410_gate_window per-gate statistics.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// Every frame's per-gate energies come from a small generator, and the
+// window's answers are checked against a plain recomputation over the same
+// values, before and after the window wraps.
+
+#include <Arduino.h>
+#include <ld2410_gates.h>
+#include "test_common.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <thread>
+#include <vector>
+
+static Energies energies_for(uint32_t i) {
+    Energies e;
+    for (int g = 0; g < 9; g++) {
+        e.moving[g] = (uint8_t)((i * 37 + g * 11) % 101);
+        e.stationary[g] = (uint8_t)((i * 53 + g * 7 + 5) % 101);
+    }
+    return e;
+}
+
+// min/max/mean/variance of one gate, recomputed from scratch.
+static bool matches(const ld2410_gate_stats& stats, int gate, const std::deque<Energies>& window, bool moving) {
+    uint8_t low = 255, high = 0;
+    double sum = 0;
+    for (const Energies& e : window) {
+        const uint8_t v = moving ? e.moving[gate] : e.stationary[gate];
+        low = v < low ? v : low;
+        high = v > high ? v : high;
+        sum += v;
+    }
+    const double mean = sum / window.size();
+    double spread = 0;
+    for (const Energies& e : window) {
+        const double d = (moving ? e.moving[gate] : e.stationary[gate]) - mean;
+        spread += d * d;
+    }
+    const double variance = spread / window.size();
+    return stats.min[gate] == low && stats.max[gate] == high &&
+           std::fabs(stats.mean[gate] - mean) < 1e-3 &&
+           std::fabs(stats.variance[gate] - variance) < 1e-2;
+}
+
+static bool matches(const ld2410_gate_window_stats& stats, const std::deque<Energies>& window) {
+    if (stats.frames != window.size()) return false;
+    for (int g = 0; g < 9; g++) {
+        if (!matches(stats.moving, g, window, true) || !matches(stats.stationary, g, window, false)) return false;
+    }
+    return true;
+}
+
+static void test_gate_window_stats() {
+    std::printf("test_gate_window_stats ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    ld2410_gate_window_buffer<8> window;
+    CHECK(window.capacity() == 8);
+    ld2410_gate_window_stats stats;
+    CHECK(!window.stats(stats));
+    feed(r, s, engineering_frame(energies_for(0)));   // before setGateWindow(): not counted
+    r.setGateWindow(window);
+    CHECK(!window.stats(stats));
+
+    std::deque<Energies> reference;
+    bool all_matched = true;
+    for (uint32_t i = 1; i <= 30; i++) {
+        const Energies e = energies_for(i);
+        feed(r, s, engineering_frame(e));
+        reference.push_back(e);
+        if (reference.size() > 8) reference.pop_front();
+        if (!window.stats(stats) || !matches(stats, reference)) all_matched = false;
+    }
+    CHECK(all_matched);
+    CHECK(stats.frames == 8);
+    CHECK(stats.newest == r.getSnapshot().sequence);
+
+    // Basic frames carry no per-gate energies and leave the window alone.
+    feed(r, s, kBasicFrame);
+    ld2410_gate_window_stats after;
+    CHECK(window.stats(after));
+    CHECK(after.newest == stats.newest);
+    CHECK(matches(after, reference));
+
+    // A second setGateWindow() starts afresh.
+    r.setGateWindow(window);
+    CHECK(!window.stats(stats));
+    feed(r, s, engineering_frame(energies_for(99)));
+    reference.assign(1, energies_for(99));
+    CHECK(window.stats(stats));
+    CHECK(matches(stats, reference));
+    CHECK(stats.moving.variance[4] == 0.0f);
+    std::printf("ok\n");
+}
+
+// Constant energies: the running sums stay exact however many times the
+// window wraps.
+static void test_gate_window_no_drift() {
+    std::printf("test_gate_window_no_drift ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    ld2410_gate_window_buffer<3> window;
+    r.setGateWindow(window);
+    for (uint32_t i = 0; i < 1000; i++) feed(r, s, engineering_frame(energies_for(i)));
+    Energies flat;
+    for (int g = 0; g < 9; g++) { flat.moving[g] = 100; flat.stationary[g] = (uint8_t)g; }
+    for (int i = 0; i < 3; i++) feed(r, s, engineering_frame(flat));
+    ld2410_gate_window_stats stats;
+    CHECK(window.stats(stats));
+    for (int g = 0; g < 9; g++) {
+        CHECK(stats.moving.min[g] == 100 && stats.moving.max[g] == 100);
+        CHECK(stats.moving.mean[g] == 100.0f && stats.moving.variance[g] == 0.0f);
+        CHECK(stats.stationary.mean[g] == (float)g && stats.stationary.variance[g] == 0.0f);
+    }
+    std::printf("ok\n");
+}
+
+// With the parser on another thread, every stats() result still describes
+// one consistent window: all frames carry a single value v in every gate, so
+// min <= mean <= max must hold and the frame count never exceeds capacity.
+static void test_gate_window_concurrent() {
+    std::printf("test_gate_window_concurrent ... ");
+    const int frames = 20000;
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    ld2410_gate_window_buffer<4> window;
+    r.setGateWindow(window);
+    std::atomic<bool> done(false);
+    int torn = 0;
+    int reads = 0;
+
+    std::thread parser([&] {
+        for (int i = 0; i < frames; i++) {
+            Energies e;
+            for (int g = 0; g < 9; g++) e.moving[g] = e.stationary[g] = (uint8_t)(i % 100);
+            feed(r, s, engineering_frame(e));
+        }
+        done = true;
+    });
+    std::thread consumer([&] {
+        ld2410_gate_window_stats stats;
+        while (!done) {
+            if (!window.stats(stats)) continue;
+            reads++;
+            if (stats.frames > 4) torn++;
+            for (int g = 0; g < 9; g++) {
+                if (stats.moving.min[g] != stats.moving.min[0] || stats.moving.max[g] != stats.stationary.max[g] ||
+                    stats.moving.mean[g] < stats.moving.min[g] || stats.moving.mean[g] > stats.moving.max[g]) torn++;
+            }
+        }
+    });
+    parser.join();
+    consumer.join();
+
+    CHECK(torn == 0);
+    CHECK(reads > 0);
+    ld2410_gate_window_stats stats;
+    CHECK(window.stats(stats));
+    CHECK(stats.newest == (uint32_t)frames);
+    std::printf("ok\n");
+}
+
+int main() {
+    test_gate_window_stats();
+    test_gate_window_no_drift();
+    test_gate_window_concurrent();
+
+    return test_result();
+}
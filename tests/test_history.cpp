@@ -0,0 +1,170 @@
+// Native host-side tests for the ld2410_history frame record.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// The concurrent test runs the parser on one std::thread and a consumer
+// catching up with since() on another. As in test_snapshot, every frame
+// carries one counter value in all of its fields, so an entry that mixes two
+// frames is detectable.
+
+#include <Arduino.h>
+#include <ld2410_history.h>
+#include "test_common.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static std::vector<uint8_t> make_frame(uint8_t v) {
+    std::vector<uint8_t> f = {
+        0xF4, 0xF3, 0xF2, 0xF1, 0x23, 0x00,
+        0x01, 0xAA, 0x03,
+        v, 0x00, v,                    // moving distance, moving energy
+        v, 0x00, v,                    // stationary distance, stationary energy
+        v, 0x00,                       // detection distance
+        0x08, 0x08
+    };
+    for (int g = 0; g < 18; g++) f.push_back(v);
+    f.insert(f.end(), {0x00, 0x00, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5});
+    return f;
+}
+
+static bool consistent(const RadarSnapshot& s) {
+    const uint8_t v = s.moving_target_energy;
+    if (s.moving_target_distance != v || s.stationary_target_distance != v ||
+        s.stationary_target_energy != v || s.detection_distance != v) return false;
+    for (int g = 0; g < 9; g++) {
+        if (s.moving_gate_energy[g] != v || s.stationary_gate_energy[g] != v) return false;
+    }
+    return true;
+}
+
+static void feed(ld2410& r, LockedSerial& s, uint8_t v) {
+    feed(r, s, make_frame(v));
+}
+
+static void test_history_record() {
+    std::printf("test_history_record ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    ld2410_history_buffer<8> history;
+    CHECK(history.capacity() == 8);
+    CHECK(history.size() == 0);
+    CHECK(history.newest() == 0 && history.oldest() == 0);
+    feed(r, s, 9);                                  // before setHistory(): not recorded
+    r.setHistory(history);
+    CHECK(history.size() == 0);
+    for (uint8_t v = 10; v < 13; v++) feed(r, s, v);
+
+    CHECK(history.size() == 3);
+    CHECK(history.oldest() == 2);
+    CHECK(history.newest() == 4);
+    ld2410_history_entry entry;
+    CHECK(!history.get(1, entry));
+    CHECK(!history.get(5, entry));
+    uint32_t last_timestamp = 0;
+    for (uint32_t sequence = history.oldest(); sequence <= history.newest(); sequence++) {
+        CHECK(history.get(sequence, entry));
+        CHECK(entry.snapshot.sequence == sequence);
+        CHECK(entry.snapshot.moving_target_distance == sequence + 8);
+        CHECK(consistent(entry.snapshot));
+        CHECK(entry.timestamp > last_timestamp);
+        last_timestamp = entry.timestamp;
+    }
+    std::printf("ok\n");
+}
+
+// Once full, the oldest frames are overwritten; since() skips over them and
+// the gap shows in the sequence numbers.
+static void test_history_wrap_and_since() {
+    std::printf("test_history_wrap_and_since ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    ld2410_history_buffer<4> history;
+    r.setHistory(history);
+    ld2410_history_entry entries[8];
+    CHECK(history.since(0, entries, 8) == 0);
+    for (uint8_t v = 1; v <= 10; v++) feed(r, s, v);
+
+    CHECK(history.size() == 4);
+    CHECK(history.oldest() == 7);
+    CHECK(history.newest() == 10);
+    ld2410_history_entry entry;
+    CHECK(!history.get(6, entry));
+
+    CHECK(history.since(0, entries, 8) == 4);
+    CHECK(entries[0].snapshot.sequence == 7);
+    CHECK(entries[3].snapshot.sequence == 10);
+    CHECK(entries[3].snapshot.moving_target_energy == 10);
+    CHECK(history.since(8, entries, 8) == 2);
+    CHECK(entries[0].snapshot.sequence == 9);
+    CHECK(history.since(7, entries, 1) == 1);
+    CHECK(entries[0].snapshot.sequence == 8);
+    CHECK(history.since(10, entries, 8) == 0);
+
+    // Catching up leaves off where the previous call stopped.
+    feed(r, s, 11);
+    CHECK(history.since(10, entries, 8) == 1);
+    CHECK(entries[0].snapshot.sequence == 11);
+
+    // A second setHistory() starts the record afresh.
+    r.setHistory(history);
+    CHECK(history.size() == 0);
+    feed(r, s, 12);
+    CHECK(history.oldest() == 12 && history.newest() == 12);
+    std::printf("ok\n");
+}
+
+static void test_history_concurrent() {
+    std::printf("test_history_concurrent ... ");
+    const int frames = 20000;
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    ld2410_history_buffer<16> history;
+    r.setHistory(history);
+    std::atomic<bool> done(false);
+    int torn = 0;
+    uint32_t received = 0;
+    uint32_t last_sequence = 0;
+    bool out_of_order = false;
+
+    std::thread parser([&] {
+        for (int i = 0; i < frames; i++) feed(r, s, (uint8_t)(i % 200 + 1));
+        done = true;
+    });
+    std::thread consumer([&] {
+        ld2410_history_entry entries[8];
+        for (;;) {
+            const bool finished = done;
+            uint16_t n;
+            while ((n = history.since(last_sequence, entries, 8)) > 0) {
+                for (uint16_t i = 0; i < n; i++) {
+                    if (!consistent(entries[i].snapshot)) torn++;
+                    if (entries[i].snapshot.sequence <= last_sequence) out_of_order = true;
+                    last_sequence = entries[i].snapshot.sequence;
+                    received++;
+                }
+            }
+            if (finished) break;
+        }
+    });
+    parser.join();
+    consumer.join();
+
+    CHECK(torn == 0);
+    CHECK(!out_of_order);
+    CHECK(received > 0);
+    CHECK(last_sequence == (uint32_t)frames);
+    std::printf("ok\n");
+}
+
+int main() {
+    test_history_record();
+    test_history_wrap_and_since();
+    test_history_concurrent();
+
+    return test_result();
+}
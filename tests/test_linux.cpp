@@ -0,0 +1,240 @@
+// Native host-side tests for ld2410_linux_serial and ld2410_reactor.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// Each radar is played by the master side of a pseudo-terminal pair; the
+// library opens the slave side as its serial port, so no hardware is needed.
+
+#include <Arduino.h>
+#include <ld2410_linux.h>
+#include <ld2410_scheduler.h>
+#include "test_common.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// The radar's end of a pty pair; port() is the path the library opens.
+class FakeRadar {
+public:
+    FakeRadar() {
+        master_ = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master_ >= 0 && (grantpt(master_) != 0 || unlockpt(master_) != 0)) {
+            ::close(master_);
+            master_ = -1;
+        }
+    }
+    ~FakeRadar() { hangUp(); }
+    const char* port() const { return master_ >= 0 ? ptsname(master_) : ""; }
+    void send(const std::vector<uint8_t>& bytes) {
+        size_t sent = 0;
+        while (sent < bytes.size()) {
+            const ssize_t n = ::write(master_, bytes.data() + sent, bytes.size() - sent);
+            if (n > 0) sent += (size_t)n;
+        }
+    }
+    // Whatever the library wrote, waiting up to timeout_ms for the first byte.
+    std::vector<uint8_t> receive(int timeout_ms) {
+        std::vector<uint8_t> bytes;
+        struct pollfd pfd = { master_, POLLIN, 0 };
+        while (::poll(&pfd, 1, bytes.empty() ? timeout_ms : 20) > 0) {
+            uint8_t buf[256];
+            const ssize_t n = ::read(master_, buf, sizeof(buf));
+            if (n <= 0) break;
+            bytes.insert(bytes.end(), buf, buf + n);
+        }
+        return bytes;
+    }
+    void hangUp() {
+        if (master_ >= 0) ::close(master_);
+        master_ = -1;
+    }
+private:
+    int master_ = -1;
+};
+
+static void test_serial_stream() {
+    std::printf("test_serial_stream ... ");
+    FakeRadar radar;
+    ld2410_linux_serial serial;
+    CHECK(!serial.isOpen());
+    CHECK(serial.read() == -1 && serial.available() == 0);
+    CHECK(!serial.setBaudRate(115200));             // not open
+    CHECK(!serial.begin("/dev/nonexistent-ld2410"));
+    CHECK(serial.begin(radar.port()));
+    CHECK(serial.isOpen());
+    CHECK(serial.setBaudRate(115200));
+    CHECK(serial.setBaudRate(256000));
+    CHECK(serial.available() == 0);
+    CHECK(serial.read() == -1);                     // non-blocking
+
+    radar.send({0x01, 0x02, 0x03, 0x0A, 0x0D});     // raw: no CR/LF translation
+    for (int i = 0; i < 1000 && serial.available() < 5; i++) usleep(1000);
+    CHECK(serial.available() == 5);
+    CHECK(serial.peek() == 0x01);
+    CHECK(serial.available() == 5);
+    CHECK(serial.read() == 0x01);
+    uint8_t buf[8] = {};
+    CHECK(serial.readBytes(buf, sizeof(buf)) == 4);
+    CHECK(buf[0] == 0x02 && buf[2] == 0x0A && buf[3] == 0x0D);
+
+    const uint8_t out[] = {0xFD, 0xFC, 0x0A, 0x00};
+    CHECK(serial.write(out, sizeof(out)) == sizeof(out));
+    CHECK((radar.receive(1000) == std::vector<uint8_t>{0xFD, 0xFC, 0x0A, 0x00}));
+    serial.end();
+    CHECK(!serial.isOpen());
+    std::printf("ok\n");
+}
+
+// One reactor, several radars, each with a backlog several times the ring
+// size: fed in chunks, none of it is lost.
+static void test_reactor_many_sensors() {
+    std::printf("test_reactor_many_sensors ... ");
+    const int count = 8;
+    const int backlog = 3 * LD2410_BUFFER_SIZE / 23;
+    FakeRadar radars[count];
+    ld2410_linux_serial serials[count];
+    ld2410 sensors[count];
+    ld2410_reactor reactor;
+    for (int i = 0; i < count; i++) {
+        CHECK(!reactor.add(sensors[i], serials[i]));  // not open, not the sensor's stream
+        CHECK(serials[i].begin(radars[i].port()));
+        sensors[i].begin(serials[i], false);
+        CHECK(reactor.add(sensors[i], serials[i]));
+    }
+    CHECK(reactor.size() == count);
+    CHECK(!reactor.add(sensors[0], serials[0]));
+    ld2410_scheduler scheduler;
+    CHECK(!scheduler.add(sensors[0]));              // one driver per sensor
+
+    for (int i = 0; i < count; i++) radars[i].send(basic_frames((uint8_t)(10 + i), backlog));
+    uint32_t parsed = 0;
+    for (int pass = 0; pass < 1000 && parsed < (uint32_t)(count * backlog); pass++) {
+        parsed += reactor.poll(100);
+    }
+    CHECK(parsed == (uint32_t)(count * backlog));
+    for (int i = 0; i < count; i++) {
+        CHECK(sensors[i].getSnapshot().sequence == (uint32_t)backlog);
+        CHECK(sensors[i].movingTargetDistance() == 10 + i);
+    }
+    CHECK(reactor.poll(0) == 0);
+
+    CHECK(reactor.remove(sensors[3]));
+    CHECK(!reactor.remove(sensors[3]));
+    CHECK(reactor.size() == count - 1);
+    radars[3].send(basic_frames(99, 1));
+    radars[4].send(basic_frames(44, 1));
+    for (int pass = 0; pass < 100 && sensors[4].getSnapshot().sequence == (uint32_t)backlog; pass++) reactor.poll(100);
+    CHECK(sensors[4].movingTargetDistance() == 44);
+    CHECK(sensors[3].getSnapshot().sequence == (uint32_t)backlog);
+    std::printf("ok\n");
+}
+
+// run() on its own thread: a blocking command from another thread goes out
+// through the reactor, and the fake radar's ACK comes back through it.
+static void test_reactor_commands() {
+    std::printf("test_reactor_commands ... ");
+    FakeRadar radar;
+    ld2410_linux_serial serial;
+    ld2410 sensor;
+    CHECK(serial.begin(radar.port()));
+    sensor.begin(serial, false);
+    ld2410_reactor reactor;
+    CHECK(reactor.add(sensor, serial));
+
+    std::atomic<bool> done(false);
+    std::vector<uint8_t> opcodes;
+    std::thread responder([&] {
+        while (!done) {
+            const std::vector<uint8_t> written = radar.receive(20);
+            for (size_t i = 0; i + 8 <= written.size(); i++) {
+                if (written[i] != 0xFD || written[i + 1] != 0xFC) continue;
+                const uint8_t op = written[i + 6];
+                opcodes.push_back(op);
+                const uint8_t length = op == 0xFF ? 8 : 4;
+                std::vector<uint8_t> ack = {0xFD, 0xFC, 0xFB, 0xFA, length, 0x00, op, 0x01, 0x00, 0x00};
+                for (uint8_t j = 4; j < length; j++) ack.push_back(0x00);
+                ack.insert(ack.end(), {0x04, 0x03, 0x02, 0x01});
+                radar.send(ack);
+            }
+        }
+    });
+    std::thread loop([&] { reactor.run(); });
+    for (int i = 0; i < 1000 && !sensor.isAutoReadTaskRunning(); i++) usleep(1000);
+    CHECK(reactor.isRunning());
+    CHECK(sensor.isAutoReadTaskRunning());
+
+    CHECK(sensor.requestStartEngineeringMode());
+    radar.send(basic_frames(25, 1));
+    for (int i = 0; i < 1000 && sensor.getSnapshot().sequence == 0; i++) usleep(1000);
+    CHECK(sensor.movingTargetDistance() == 25);
+
+    reactor.stop();
+    loop.join();
+    done = true;
+    responder.join();
+    CHECK(!reactor.isRunning());
+    CHECK(!sensor.isAutoReadTaskRunning());
+    CHECK((opcodes == std::vector<uint8_t>{0xFF, 0x62, 0xFE}));
+    std::printf("ok\n");
+}
+
+// A stop() while the reactor is idle is dropped, so the next run() runs
+// until stopped again, and a stopped reactor can be run again.
+static void test_reactor_restart() {
+    std::printf("test_reactor_restart ... ");
+    ld2410_reactor reactor;
+    reactor.stop();
+    for (int round = 0; round < 2; round++) {
+        std::thread loop([&] { reactor.run(); });
+        for (int i = 0; i < 1000 && !reactor.isRunning(); i++) usleep(1000);
+        CHECK(reactor.isRunning());
+        usleep(20000);
+        CHECK(reactor.isRunning());
+        reactor.stop();
+        loop.join();
+        CHECK(!reactor.isRunning());
+    }
+    std::printf("ok\n");
+}
+
+// A radar that goes away does not turn poll() into a busy loop, and a sensor
+// destroyed while registered unregisters itself.
+static void test_reactor_hangup() {
+    std::printf("test_reactor_hangup ... ");
+    FakeRadar radar;
+    ld2410_linux_serial serial;
+    ld2410_reactor reactor;
+    {
+        ld2410 sensor;
+        CHECK(serial.begin(radar.port()));
+        sensor.begin(serial, false);
+        CHECK(reactor.add(sensor, serial));
+        radar.send(basic_frames(30, 2));
+        for (int pass = 0; pass < 100 && sensor.getSnapshot().sequence < 2; pass++) reactor.poll(100);
+        CHECK(sensor.getSnapshot().sequence == 2);
+
+        radar.hangUp();
+        reactor.poll(100);                          // reports the hang-up once
+        const auto start = std::chrono::steady_clock::now();
+        CHECK(reactor.poll(50) == 0);
+        CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(40));
+    }
+    CHECK(reactor.size() == 0);
+    std::printf("ok\n");
+}
+
+int main() {
+    test_serial_stream();
+    test_reactor_many_sensors();
+    test_reactor_commands();
+    test_reactor_restart();
+    test_reactor_hangup();
+
+    return test_result();
+}
@@ -12,6 +12,7 @@
 
 #include <Arduino.h>
 #include <ld2410.h>
+#include "test_common.h"
 #include <cstdio>
 #include <cstring>
 #include <vector>
@@ -76,15 +77,6 @@ public:
     }
 };
 
-static int failures = 0;
-
-#define CHECK(cond) do { \
-    if (!(cond)) { \
-        std::fprintf(stderr, "FAIL %s:%d  %s\n", __FILE__, __LINE__, #cond); \
-        failures++; \
-    } \
-} while (0)
-
 #define CHECK_EQ(a, b) do { \
     auto _a = (a); auto _b = (b); \
     if (!(_a == _b)) { \
@@ -95,7 +87,7 @@ static int failures = 0;
 } while (0)
 
 // Helper: pump the parser by calling read() until all queued bytes are drained.
-static void drain(ld2410& r, MockSerial& s) {
+static void drain(ld2410_base& r, MockSerial& s) {
     while (s.available() > 0) {
         r.read();
     }
@@ -300,13 +292,13 @@ static void test_sequential_frames() {
 
 // ===========================================================================
 // Command-side tests (added by refactor/task-safe-commands).
-// These exercise the wait_for_ack_ + cmd_seq_ machinery via the public
+// These exercise the command engine + cmd_seq_ machinery via the public
 // request* API. Hardware is not available; we simulate the radar's ACK by
 // pre-loading the MockSerial with the bytes the real radar would send.
 //
 // On the host autoReadTask is not active (no FreeRTOS available), so all
-// commands take the polling branch of wait_for_ack_, which drains UART ->
-// circular buffer -> read_frame_() -> parse_command_frame_() inline.
+// blocking commands drive the engine themselves: UART -> circular buffer ->
+// read_frame_() -> parse_command_frame_() -> service_commands_() inline.
 // ===========================================================================
 
 // Build a 0xA0 (firmware version) ACK frame with major=1, minor=7, bugfix=0x22091516.
@@ -325,7 +317,7 @@ static std::vector<uint8_t> make_firmware_ack(uint8_t major, uint8_t minor,
 }
 
 // Build a generic short ACK (4-byte payload, status=success) for opcode `op`.
-// Used by enter_configuration_mode_'s ACK (0xFF) and most other commands.
+// Used for the enter-config ACK (0xFF) and most other commands.
 static std::vector<uint8_t> make_short_ack(uint8_t op, uint16_t intra_len = 4) {
     std::vector<uint8_t> v = {
         0xFD, 0xFC, 0xFB, 0xFA,
@@ -350,7 +342,7 @@ static void test_command_ack_polling() {
     MockSerial s;
     r.begin(s, /*waitForRadar=*/false);
 
-    // enter_configuration_mode_ -> ACK 0xFF with 8-byte payload (status + version + buffer)
+    // enter-config -> ACK 0xFF with 8-byte payload (status + version + buffer)
     // Stage three responses: each is released when the radar postamble is
     // written (i.e. immediately after the corresponding command bytes go out).
     s.inject_response(make_short_ack(0xFF, 8));
@@ -368,13 +360,13 @@ static void test_command_ack_polling() {
 
 // Test: ACK with wrong opcode -> command must time out, returns false.
 // Inject only enter-config ACK; the firmware command then receives no
-// matching ACK and wait_for_ack_ should give up at radar_uart_command_timeout_.
+// matching ACK and the engine should give up at radar_uart_command_timeout_.
 static void test_command_ack_stale() {
     std::printf("test_command_ack_stale ... ");
     ld2410 r;
     MockSerial s;
     r.begin(s, /*waitForRadar=*/false);
-    // Only enter-config ACK; nothing for the actual command. wait_for_ack_
+    // Only enter-config ACK; nothing for the actual command. The wait
     // for 0xA0 will time out (radar_uart_command_timeout_ = 100 ms).
     s.inject_response(make_short_ack(0xFF, 8));
 
@@ -546,6 +538,151 @@ static void test_resync_after_bogus_length() {
     std::printf("ok\n");
 }
 
+// ---------------------------------------------------------------------------
+// Test 14: a frame that wraps past the end of the circular buffer is decoded
+// in place through the two-span view, and getFrameData() hands back an exact
+// copy of its raw bytes.
+// ---------------------------------------------------------------------------
+static void test_frame_wrapping_ring_end() {
+    std::printf("test_frame_wrapping_ring_end ... ");
+    ld2410 r;
+    MockSerial s;
+    r.begin(s, false);
+    const std::vector<uint8_t> frame = {
+        0xF4, 0xF3, 0xF2, 0xF1, 0x0D, 0x00,
+        0x02, 0xAA, 0x02, 0x51, 0x00, 0x00, 0x00, 0x00, 0x3B, 0x00, 0x00,
+        0x55, 0x00,
+        0xF8, 0xF7, 0xF6, 0xF5
+    };
+    // Idle bytes push the write position to 10 bytes before the end of the
+    // ring, so the frame straddles the wrap.
+    s.inject(std::vector<uint8_t>(LD2410_BUFFER_SIZE - 10, 0x00));
+    drain(r, s);
+    CHECK(r.getFrameData().data == nullptr);       // nothing parsed yet
+    s.inject(frame);
+    drain(r, s);
+    CHECK_EQ((int)r.movingTargetDistance(), 81);
+    CHECK_EQ((int)r.stationaryTargetEnergy(), 59);
+    FrameData raw = r.getFrameData();
+    CHECK_EQ((int)raw.length, (int)frame.size());
+    CHECK(raw.data != nullptr && std::memcmp(raw.data, frame.data(), frame.size()) == 0);
+    std::printf("ok\n");
+}
+
+// ---------------------------------------------------------------------------
+// keepFrameData(): the parser copies each data frame as it is accepted, so
+// getFrameData() still has it once the ring has moved on, and an ACK after
+// it does not replace it.
+// ---------------------------------------------------------------------------
+static void test_keep_frame_data() {
+    std::printf("test_keep_frame_data ... ");
+    ld2410 r;
+    MockSerial s;
+    r.begin(s, false);
+    s.inject(kBasicFrame);
+    drain(r, s);
+    s.inject(std::vector<uint8_t>(2 * LD2410_BUFFER_SIZE, 0x00));
+    drain(r, s);
+    CHECK(r.getFrameData().data == nullptr);       // gone from the ring
+
+    r.keepFrameData();
+    CHECK(r.getFrameData().data == nullptr);       // nothing kept yet
+    s.inject(kBasicFrame);
+    drain(r, s);
+    s.inject(ack(0xA0, true, 12));
+    s.inject(std::vector<uint8_t>(2 * LD2410_BUFFER_SIZE, 0x00));
+    drain(r, s);
+    FrameData raw = r.getFrameData();
+    CHECK_EQ((int)raw.length, (int)kBasicFrame.size());
+    CHECK(raw.data != nullptr && std::memcmp(raw.data, kBasicFrame.data(), kBasicFrame.size()) == 0);
+
+    r.keepFrameData(false);
+    CHECK(r.getFrameData().data == nullptr);
+    std::printf("ok\n");
+}
+
+// ---------------------------------------------------------------------------
+// Test 15: a long run of junk, including stray 0xFD/0xF4 bytes and wrapping
+// the end of the ring, is skipped and the frame after it is still found.
+// ---------------------------------------------------------------------------
+static void test_resync_through_long_junk() {
+    std::printf("test_resync_through_long_junk ... ");
+    ld2410 r;
+    MockSerial s;
+    r.begin(s, false);
+    std::vector<uint8_t> junk(LD2410_BUFFER_SIZE + 40);
+    for (size_t i = 0; i < junk.size(); i++) junk[i] = (uint8_t)(i * 13 + 1);
+    junk[30] = 0xFD; junk[31] = 0xFC;                // truncated command header
+    junk[200] = 0xF4;                                // lone data header byte
+    s.inject(junk);
+    drain(r, s);
+    s.inject({
+        0xF4, 0xF3, 0xF2, 0xF1, 0x0D, 0x00,
+        0x02, 0xAA, 0x02, 0x51, 0x00, 0x00, 0x00, 0x00, 0x3B, 0x00, 0x00,
+        0x55, 0x00,
+        0xF8, 0xF7, 0xF6, 0xF5
+    });
+    drain(r, s);
+    CHECK_EQ((int)r.movingTargetDistance(), 81);
+    std::printf("ok\n");
+}
+
+// ---------------------------------------------------------------------------
+// Sizing: an ld2410_t with a 64 byte ring and basic-mode frames only, next
+// to a default ld2410. Both go through the same ld2410_base code.
+// ---------------------------------------------------------------------------
+static void feed_frames(ld2410_base& r, MockSerial& s, uint8_t first, uint8_t count) {
+    for (uint8_t d = first; d < first + count; d++) {
+        s.inject(basic_frame(d));
+        drain(r, s);
+    }
+}
+
+static void test_sized_instances() {
+    std::printf("test_sized_instances ... ");
+    typedef ld2410_t<64, LD2410_MIN_FRAME_LENGTH> small_ld2410;
+    CHECK(sizeof(ld2410) - sizeof(small_ld2410) >= (256 - 64) + (64 - LD2410_MIN_FRAME_LENGTH) - 8);
+    small_ld2410 small;
+    ld2410 big;
+    MockSerial small_serial, big_serial;
+    small.begin(small_serial, false);
+    big.begin(big_serial, false);
+
+    // 23 byte frames wrap the 64 byte ring every few frames.
+    feed_frames(small, small_serial, 10, 20);
+    feed_frames(big, big_serial, 10, 20);
+    CHECK_EQ((int)small.getStats().data_frames, 20);
+    CHECK_EQ((int)small.movingTargetDistance(), 29);
+    CHECK_EQ((int)big.movingTargetDistance(), 29);
+    FrameData frame = small.getFrameData();
+    CHECK_EQ((int)frame.length, 23);
+    CHECK(frame.data != nullptr && frame.data[9] == 29);
+
+    // An engineering frame (45 bytes) is too long for the small one.
+    const std::vector<uint8_t> engineering = {
+        0xF4, 0xF3, 0xF2, 0xF1, 0x23, 0x00,
+        0x01, 0xAA, 0x03, 0x1E, 0x00, 0x3C, 0x00, 0x00, 0x39, 0x00, 0x00,
+        0x08, 0x08,
+        0x3C, 0x22, 0x05, 0x03, 0x03, 0x04, 0x03, 0x06, 0x05,
+        0x00, 0x00, 0x39, 0x10, 0x13, 0x06, 0x06, 0x08, 0x04,
+        0x03, 0x05,
+        0x55, 0x00,
+        0xF8, 0xF7, 0xF6, 0xF5
+    };
+    small_serial.inject(engineering);
+    drain(small, small_serial);
+    big_serial.inject(engineering);
+    drain(big, big_serial);
+    CHECK(!small.engineeringRetrieved());
+    CHECK_EQ((int)small.getStats().bad_lengths, 1);
+    CHECK(big.engineeringRetrieved());
+
+    // The small one picks up again at the next frame.
+    feed_frames(small, small_serial, 40, 1);
+    CHECK_EQ((int)small.movingTargetDistance(), 40);
+    std::printf("ok\n");
+}
+
 int main() {
     test_basic_frame();
     test_engineering_frame();
@@ -560,11 +697,10 @@ int main() {
     test_resync_F4_at_wrong_position();
     test_no_early_termination_on_payload_footer();
     test_resync_after_bogus_length();
+    test_frame_wrapping_ring_end();
+    test_keep_frame_data();
+    test_resync_through_long_junk();
+    test_sized_instances();
 
-    if (failures == 0) {
-        std::printf("\nALL TESTS PASS\n");
-        return 0;
-    }
-    std::printf("\n%d FAILURE(S)\n", failures);
-    return 1;
+    return test_result();
 }
@@ -0,0 +1,138 @@
+// Native host-side stress test for ld2410_ring, the lock-free SPSC byte ring
+// that sits between UART ingestion and the frame parser.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// A producer thread and a consumer thread share one ring with no lock. The
+// producer writes a known byte sequence in irregular chunk sizes through
+// write_span()/commit(); the consumer drains it through read_span()/peek()/
+// consume() in different irregular chunk sizes and checks every byte. Any
+// lost, duplicated or torn byte breaks the sequence.
+
+#include <Arduino.h>
+#include <ld2410_ring.h>
+#include "test_common.h"
+#include <cstdio>
+#include <thread>
+
+// Sequence byte for stream position i: not a plain counter, so a chunk
+// replayed from the wrong lap of the ring cannot match by accident.
+static inline uint8_t pattern(uint32_t i) {
+    return (uint8_t)(i ^ (i >> 8) ^ (i >> 16));
+}
+
+static void test_single_thread_wrap() {
+    std::printf("test_single_thread_wrap ... ");
+    uint8_t storage[16];
+    ld2410_ring ring(storage, sizeof(storage));
+    uint32_t written = 0, read = 0;
+    for (int round = 0; round < 100; round++) {
+        uint16_t span;
+        uint8_t* p = ring.write_span(span);
+        const uint16_t n = span < 5 ? span : 5;
+        for (uint16_t i = 0; i < n; i++) p[i] = pattern(written + i);
+        ring.commit(n);
+        written += n;
+        while (ring.used() > 2) {
+            CHECK(ring.peek(0) == pattern(read));
+            ring.consume(1);
+            read++;
+        }
+    }
+    CHECK(ring.used() == written - read);
+    ring.clear();
+    CHECK(ring.used() == 0);
+    CHECK(ring.written() == written);
+    std::printf("ok\n");
+}
+
+static void test_full_ring() {
+    std::printf("test_full_ring ... ");
+    uint8_t storage[8];
+    ld2410_ring ring(storage, sizeof(storage));
+    uint16_t span;
+    ring.write_span(span);
+    CHECK(span == 8);                 // every byte of storage is usable
+    ring.commit(8);
+    ring.write_span(span);
+    CHECK(span == 0);
+    CHECK(ring.used() == 8);
+    ring.consume(3);
+    uint8_t* p = ring.write_span(span);
+    CHECK(span == 3 && p == storage);
+    std::printf("ok\n");
+}
+
+static void test_spsc_stress() {
+    std::printf("test_spsc_stress ... ");
+    const uint32_t total = 20u * 1024 * 1024;
+    uint8_t storage[256];
+    ld2410_ring ring(storage, sizeof(storage));
+    uint32_t mismatches = 0;
+    uint32_t consumed = 0;
+
+    std::thread producer([&] {
+        uint32_t i = 0;
+        uint32_t step = 1;
+        while (i < total) {
+            uint16_t span;
+            uint8_t* p = ring.write_span(span);
+            if (span == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            step = step * 1103515245u + 12345u;
+            uint32_t n = 1 + (step >> 16) % 97;
+            if (n > span) n = span;
+            if (n > total - i) n = total - i;
+            for (uint32_t k = 0; k < n; k++) p[k] = pattern(i + k);
+            ring.commit((uint16_t)n);
+            i += n;
+        }
+    });
+
+    std::thread consumer([&] {
+        uint32_t step = 7;
+        while (consumed < total) {
+            step = step * 1103515245u + 12345u;
+            if (step & 0x10000) {
+                // Bulk path, as the header scan uses it.
+                uint16_t span;
+                const uint8_t* p = ring.read_span(span);
+                if (span == 0) { std::this_thread::yield(); continue; }
+                uint16_t n = 1 + (step >> 20) % span;
+                for (uint16_t k = 0; k < n; k++) {
+                    if (p[k] != pattern(consumed + k)) mismatches++;
+                }
+                ring.consume(n);
+                consumed += n;
+            } else {
+                // Random-access path, as frame validation uses it.
+                const uint16_t used = ring.used();
+                if (used == 0) { std::this_thread::yield(); continue; }
+                const uint16_t n = 1 + (step >> 20) % used;
+                for (uint16_t k = 0; k < n; k++) {
+                    if (ring.peek(k) != pattern(consumed + k)) mismatches++;
+                }
+                ring.consume(n);
+                consumed += n;
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    CHECK(mismatches == 0);
+    CHECK(consumed == total);
+    CHECK(ring.used() == 0);
+    CHECK(ring.written() == total);
+    std::printf("ok\n");
+}
+
+int main() {
+    test_single_thread_wrap();
+    test_full_ring();
+    test_spsc_stress();
+
+    return test_result();
+}
@@ -0,0 +1,167 @@
+// Native host-side tests for ld2410_scheduler.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// Several sensors, each on its own mock UART, are serviced by one
+// scheduler. The host micros() advances by one per call, which makes the
+// time budget count budget checks, so a budget of 1 lets exactly one sensor
+// have a turn per pass.
+
+#include <Arduino.h>
+#include <ld2410_scheduler.h>
+#include "test_common.h"
+#include <cstdio>
+#include <vector>
+
+// ACKs every command frame written to it, successfully.
+class AckingSerial : public LockedSerial {
+public:
+    std::vector<uint8_t> opcodes;
+    size_t write(const uint8_t* buf, size_t n) override {
+        if (n >= 8 && buf[0] == 0xFD) {
+            const uint8_t op = buf[6];
+            opcodes.push_back(op);
+            const uint8_t length = op == 0xFF ? 8 : 4;
+            std::vector<uint8_t> ack = {0xFD, 0xFC, 0xFB, 0xFA, length, 0x00, op, 0x01, 0x00, 0x00};
+            for (uint8_t i = 4; i < length; i++) ack.push_back(0x00);
+            ack.insert(ack.end(), {0x04, 0x03, 0x02, 0x01});
+            inject(ack);
+        }
+        return n;
+    }
+    using Print::write;
+};
+
+static void test_service_all() {
+    std::printf("test_service_all ... ");
+    ld2410 a, b, c;
+    LockedSerial sa, sb, sc;
+    a.begin(sa, false);
+    b.begin(sb, false);
+    c.begin(sc, false);
+    ld2410_scheduler scheduler;
+    CHECK(scheduler.add(a));
+    CHECK(scheduler.add(b));
+    CHECK(scheduler.add(c));
+    CHECK(scheduler.size() == 3);
+
+    sa.inject(basic_frames(10, 3));
+    sb.inject(basic_frames(20, 1));
+    sc.inject(basic_frames(30, 2));
+    CHECK(scheduler.service(1000000));
+    CHECK(a.getSnapshot().sequence == 3);
+    CHECK(b.getSnapshot().sequence == 1);
+    CHECK(c.getSnapshot().sequence == 2);
+    CHECK(a.movingTargetDistance() == 10);
+    CHECK(b.movingTargetDistance() == 20);
+    CHECK(c.movingTargetDistance() == 30);
+    CHECK(!scheduler.service(1000000));
+    std::printf("ok\n");
+}
+
+// A radar with a deep backlog does not hold the others up: with one turn per
+// pass, the sensors are served in rotation.
+static void test_round_robin_budget() {
+    std::printf("test_round_robin_budget ... ");
+    ld2410 a, b, c;
+    LockedSerial sa, sb, sc;
+    a.begin(sa, false);
+    b.begin(sb, false);
+    c.begin(sc, false);
+    ld2410_scheduler scheduler;
+    scheduler.add(a);
+    scheduler.add(b);
+    scheduler.add(c);
+
+    sa.inject(basic_frames(10, 8));
+    sb.inject(basic_frames(20, 1));
+    sc.inject(basic_frames(30, 1));
+    CHECK(scheduler.service(1));
+    CHECK(a.getSnapshot().sequence == 1 && b.getSnapshot().sequence == 0 && c.getSnapshot().sequence == 0);
+    CHECK(scheduler.service(1));
+    CHECK(b.getSnapshot().sequence == 1 && c.getSnapshot().sequence == 0);
+    CHECK(scheduler.service(1));
+    CHECK(c.getSnapshot().sequence == 1);
+    CHECK(a.getSnapshot().sequence == 1);
+
+    // The rest of a's backlog, with time to spare.
+    CHECK(scheduler.service(1000000));
+    CHECK(a.getSnapshot().sequence == 8);
+    std::printf("ok\n");
+}
+
+static void test_commands_and_membership() {
+    std::printf("test_commands_and_membership ... ");
+    ld2410 a, b;
+    AckingSerial sa;
+    LockedSerial sb;
+    a.begin(sa, false);
+    b.begin(sb, false);
+    ld2410_scheduler scheduler;
+    scheduler.add(a);
+    scheduler.add(b);
+
+    // The scheduler steps each sensor's command engine.
+    const ld2410_command_handle handle = a.queueCommand(ld2410_command::requestStartEngineeringMode());
+    CHECK(handle != 0);
+    for (int i = 0; i < 2000 && a.commandsPending(); i++) scheduler.service();
+    CHECK(a.commandStatus(handle) == LD2410_COMMAND_SUCCEEDED);
+    CHECK((sa.opcodes == std::vector<uint8_t>{0xFF, 0x62, 0xFE}));
+
+    // Membership.
+    CHECK(!scheduler.add(a));                       // already registered
+    ld2410_scheduler other;
+    CHECK(!other.add(a));                           // belongs to another scheduler
+    CHECK(scheduler.remove(a));
+    CHECK(!scheduler.remove(a));
+    CHECK(other.add(a));
+    CHECK(scheduler.size() == 1 && other.size() == 1);
+    {
+        ld2410 temporary;
+        LockedSerial st;
+        temporary.begin(st, false);
+        CHECK(scheduler.add(temporary));
+        CHECK(scheduler.size() == 2);
+    }
+    CHECK(scheduler.size() == 1);                   // a destroyed sensor unregisters itself
+
+    ld2410 more[LD2410_SCHEDULER_MAX_SENSORS];
+    int added = 0;
+    for (ld2410& sensor : more) added += scheduler.add(sensor) ? 1 : 0;
+    CHECK(added == LD2410_SCHEDULER_MAX_SENSORS - 1);
+    std::printf("ok\n");
+}
+
+// With a shared wake source, any sensor's notifyDataAvailable() wakes the
+// scheduler.
+static void test_shared_wake_source() {
+    std::printf("test_shared_wake_source ... ");
+    ld2410 a, b;
+    LockedSerial sa, sb;
+    a.begin(sa, false);
+    b.begin(sb, false);
+    ld2410_scheduler scheduler;
+    scheduler.add(a);
+    ld2410_condvar_wake_source wake;
+    scheduler.setWakeSource(wake);
+    scheduler.add(b);
+
+    sb.inject(basic_frames(20, 1));
+    b.notifyDataAvailable();
+    CHECK(scheduler.waitAndService(5000));
+    CHECK(b.getSnapshot().sequence == 1);
+    sa.inject(basic_frames(10, 1));
+    a.notifyDataAvailable();
+    CHECK(scheduler.waitAndService(5000));
+    CHECK(a.getSnapshot().sequence == 1);
+    std::printf("ok\n");
+}
+
+int main() {
+    test_service_all();
+    test_round_robin_budget();
+    test_commands_and_membership();
+    test_shared_wake_source();
+
+    return test_result();
+}
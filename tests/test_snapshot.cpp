@@ -0,0 +1,106 @@
+// Native host-side tests for ld2410::getSnapshot().
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// The concurrent test runs the parser on one std::thread and getSnapshot()
+// on another, the way autoReadTask and loop() share an ld2410 on ESP32.
+// Every frame carries one counter value in all of its fields, so a snapshot
+// that mixes two frames is detectable.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "test_common.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Engineering frame whose distances, energies and per-gate energies are all
+// derived from `v`.
+static std::vector<uint8_t> make_frame(uint8_t v) {
+    std::vector<uint8_t> f = {
+        0xF4, 0xF3, 0xF2, 0xF1, 0x23, 0x00,
+        0x01, 0xAA, 0x03,
+        v, 0x00, v,                    // moving distance, moving energy
+        v, 0x00, v,                    // stationary distance, stationary energy
+        v, 0x00,                       // detection distance
+        0x08, 0x08
+    };
+    for (int g = 0; g < 18; g++) f.push_back(v);
+    f.insert(f.end(), {0x00, 0x00, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5});
+    return f;
+}
+
+static bool consistent(const RadarSnapshot& s) {
+    const uint8_t v = s.moving_target_energy;
+    if (s.moving_target_distance != v || s.stationary_target_distance != v ||
+        s.stationary_target_energy != v || s.detection_distance != v) return false;
+    for (int g = 0; g < 9; g++) {
+        if (s.moving_gate_energy[g] != v || s.stationary_gate_energy[g] != v) return false;
+    }
+    return true;
+}
+
+static void test_snapshot_fields() {
+    std::printf("test_snapshot_fields ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    RadarSnapshot empty = r.getSnapshot();
+    CHECK(empty.sequence == 0);
+    s.inject(make_frame(42));
+    while (s.available() > 0) r.read();
+    RadarSnapshot snap = r.getSnapshot();
+    CHECK(snap.sequence == 1);
+    CHECK(snap.target_type == 3);
+    CHECK(snap.engineering);
+    CHECK(consistent(snap));
+    CHECK(snap.moving_target_distance == 42);
+    CHECK(r.movingTargetDistance() == 42);          // getters read the same state
+    std::printf("ok\n");
+}
+
+static void test_snapshot_concurrent() {
+    std::printf("test_snapshot_concurrent ... ");
+    const int frames = 20000;
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    std::atomic<bool> done(false);
+    int torn = 0;
+    uint32_t reads = 0;
+    uint32_t last_sequence = 0;
+    bool sequence_went_back = false;
+
+    std::thread parser([&] {
+        for (int i = 0; i < frames; i++) {
+            s.inject(make_frame((uint8_t)(i % 200 + 1)));
+            while (s.available() > 0) r.read();
+        }
+        done = true;
+    });
+    std::thread reader([&] {
+        while (!done) {
+            RadarSnapshot snap = r.getSnapshot();
+            if (!consistent(snap)) torn++;
+            if (snap.sequence < last_sequence) sequence_went_back = true;
+            last_sequence = snap.sequence;
+            reads++;
+        }
+    });
+    parser.join();
+    reader.join();
+
+    CHECK(torn == 0);
+    CHECK(!sequence_went_back);
+    CHECK(reads > 0);
+    CHECK(r.getSnapshot().sequence == (uint32_t)frames);
+    std::printf("ok\n");
+}
+
+int main() {
+    test_snapshot_fields();
+    test_snapshot_concurrent();
+
+    return test_result();
+}
@@ -0,0 +1,191 @@
+// Native host-side tests for the parser health counters (getStats(),
+// resetStats()) and the ring overflow policies.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "test_common.h"
+#include <cstdio>
+#include <vector>
+
+static void test_frame_counts() {
+    std::printf("test_frame_counts ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    RadarStats stats = r.getStats();
+    CHECK(stats.data_frames == 0 && stats.bytes_discarded == 0 && stats.buffer_overruns == 0);
+
+    feed(r, s, kBasicFrame);
+    feed(r, s, kBasicFrame);
+    feed(r, s, kEngineeringFrame);
+    feed(r, s, ack(0x62));
+    feed(r, s, ack(0x7E));                          // not a command word the library knows
+    stats = r.getStats();
+    CHECK(stats.data_frames == 2);
+    CHECK(stats.engineering_frames == 1);
+    CHECK(stats.ack_frames == 2);
+    CHECK(stats.unknown_acks == 1);
+    CHECK(stats.invalid_frames == 0);
+    CHECK(stats.header_resyncs == 0 && stats.bytes_discarded == 0);
+    std::printf("ok\n");
+}
+
+static void test_error_counts() {
+    std::printf("test_error_counts ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+
+    // Junk before a frame: skipped in one go, up to the header.
+    std::vector<uint8_t> noisy = {0x11, 0x22, 0x33, 0x44, 0x55};
+    noisy.insert(noisy.end(), kBasicFrame.begin(), kBasicFrame.end());
+    feed(r, s, noisy);
+    RadarStats stats = r.getStats();
+    CHECK(stats.data_frames == 1);
+    CHECK(stats.header_resyncs == 1);
+    CHECK(stats.bytes_discarded == 5);
+
+    // A false header start: 0xF4 without the rest of the magic.
+    feed(r, s, {0xF4, 0x00, 0x00, 0x00});
+    stats = r.getStats();
+    CHECK(stats.header_resyncs == 3);               // the 0xF4, then the three 0x00
+    CHECK(stats.bytes_discarded == 9);
+
+    // An impossible length.
+    std::vector<uint8_t> bad_length = kBasicFrame;
+    bad_length[4] = 0xFF;
+    feed(r, s, bad_length);
+    CHECK(r.getStats().bad_lengths == 1);
+
+    // A footer that is not where the length says.
+    std::vector<uint8_t> bad_footer = kBasicFrame;
+    bad_footer[20] = 0x00;
+    feed(r, s, bad_footer);
+    CHECK(r.getStats().footer_mismatches == 1);
+
+    // Header, length and footer fine, contents not.
+    std::vector<uint8_t> bad_marker = kBasicFrame;
+    bad_marker[7] = 0xAB;
+    feed(r, s, bad_marker);
+    stats = r.getStats();
+    CHECK(stats.invalid_frames == 1);
+    CHECK(stats.data_frames == 1);
+    std::printf("ok\n");
+}
+
+// More bytes than the ring holds arrive before anything is parsed.
+static void test_overrun_and_reset() {
+    std::printf("test_overrun_and_reset ... ");
+    ld2410 r;
+    LockedSerial s;
+    r.begin(s, false);
+    std::vector<uint8_t> burst;
+    while (burst.size() < LD2410_BUFFER_SIZE + 3 * kBasicFrame.size()) {
+        burst.insert(burst.end(), kBasicFrame.begin(), kBasicFrame.end());
+    }
+    feed(r, s, burst);
+    RadarStats stats = r.getStats();
+    CHECK(stats.buffer_overruns == 1);
+    CHECK(stats.bytes_dropped == burst.size() - LD2410_BUFFER_SIZE);
+    CHECK(stats.buffer_high_water == burst.size());
+    CHECK(stats.data_frames > 0 && stats.data_frames < burst.size() / kBasicFrame.size());
+
+    r.resetStats();
+    stats = r.getStats();
+    CHECK(stats.buffer_overruns == 0 && stats.bytes_dropped == 0 && stats.buffer_high_water == 0 && stats.data_frames == 0 &&
+          stats.bytes_discarded == 0 && stats.header_resyncs == 0);
+    feed(r, s, kBasicFrame);
+    stats = r.getStats();
+    CHECK(stats.data_frames == 1);
+    CHECK(stats.buffer_high_water == kBasicFrame.size());
+    std::printf("ok\n");
+}
+
+// 15 frames (345 bytes) in one go: 89 more than the ring holds.
+static std::vector<uint8_t> overflowing_burst() {
+    std::vector<uint8_t> burst;
+    for (int i = 0; i < 15; i++) {
+        burst.insert(burst.end(), kBasicFrame.begin(), kBasicFrame.end());
+    }
+    return burst;
+}
+
+static void test_overflow_policies() {
+    std::printf("test_overflow_policies ... ");
+    static_assert(LD2410_BUFFER_SIZE == 256, "the expected counts assume the default ring");
+    const std::vector<uint8_t> burst = overflowing_burst();
+
+    // Drop oldest: the ring ends up holding the last 256 bytes, which start
+    // 3 bytes before the end of a frame.
+    {
+        ld2410 r;
+        LockedSerial s;
+        r.begin(s, false);
+        feed(r, s, burst);
+        RadarStats stats = r.getStats();
+        CHECK(stats.bytes_dropped == 89);
+        CHECK(stats.data_frames == 11);
+        CHECK(stats.header_resyncs == 1 && stats.bytes_discarded == 3);
+    }
+
+    // Drop oldest frame: four whole frames go, and the rest parse cleanly.
+    {
+        ld2410 r;
+        LockedSerial s;
+        r.begin(s, false);
+        r.setOverflowPolicy(LD2410_OVERFLOW_DROP_FRAME);
+        feed(r, s, burst);
+        RadarStats stats = r.getStats();
+        CHECK(stats.buffer_overruns == 1);
+        CHECK(stats.bytes_dropped == 4 * kBasicFrame.size());
+        CHECK(stats.data_frames == 11);
+        CHECK(stats.header_resyncs == 0 && stats.bytes_discarded == 0);
+        CHECK(stats.buffer_high_water == burst.size());
+    }
+
+    // Drop newest: the first 256 bytes stay, and the next frame resyncs past
+    // the 3 bytes of the frame that was cut short.
+    {
+        ld2410 r;
+        LockedSerial s;
+        r.begin(s, false);
+        r.setOverflowPolicy(LD2410_OVERFLOW_DROP_NEWEST);
+        feed(r, s, burst);
+        RadarStats stats = r.getStats();
+        CHECK(stats.buffer_overruns == 1);
+        CHECK(stats.bytes_dropped == 89);
+        CHECK(stats.data_frames == 11);
+        CHECK(s.available() == 0);
+        feed(r, s, kBasicFrame);
+        stats = r.getStats();
+        CHECK(stats.data_frames == 12);
+        CHECK(stats.bytes_discarded == 3);
+    }
+
+    // Junk in the way of a frame boundary goes with the frames.
+    {
+        ld2410 r;
+        LockedSerial s;
+        r.begin(s, false);
+        r.setOverflowPolicy(LD2410_OVERFLOW_DROP_FRAME);
+        std::vector<uint8_t> noisy = {0x00, 0xF4, 0xF3, 0x11};
+        noisy.insert(noisy.end(), burst.begin(), burst.end());
+        feed(r, s, noisy);
+        RadarStats stats = r.getStats();
+        CHECK(stats.bytes_dropped == 4 + 4 * kBasicFrame.size());
+        CHECK(stats.data_frames == 11);
+        CHECK(stats.bytes_discarded == 0);
+    }
+    std::printf("ok\n");
+}
+
+int main() {
+    test_frame_counts();
+    test_error_counts();
+    test_overrun_and_reset();
+    test_overflow_policies();
+
+    return test_result();
+}
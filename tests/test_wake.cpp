@@ -0,0 +1,76 @@
+// Native host-side tests for the event-driven read loop: waitAndRead() with
+// a pluggable wake source.
+//
+// Build & run:  bash tests/run.sh   (from the repo root)
+//
+// ld2410_condvar_wake_source stands in for the FreeRTOS task notification
+// used on ESP32: a feeder thread injects a frame and calls
+// notifyDataAvailable(), as a UART receive callback would.
+
+#include <Arduino.h>
+#include <ld2410.h>
+#include "test_common.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+// A notify() that lands before the wait must not be lost.
+static void test_notify_before_wait() {
+    std::printf("test_notify_before_wait ... ");
+    ld2410_condvar_wake_source wake;
+    wake.notify();
+    auto t0 = std::chrono::steady_clock::now();
+    CHECK(wake.wait(5000));
+    CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::seconds(1));
+    CHECK(!wake.wait(1));                          // consumed; now it times out
+    std::printf("ok\n");
+}
+
+// waitAndRead() wakes on notification and parses every frame that landed.
+static void test_wait_and_read_wakes_on_notify() {
+    std::printf("test_wait_and_read_wakes_on_notify ... ");
+    ld2410 r;
+    LockedSerial s;
+    ld2410_condvar_wake_source wake;
+    r.begin(s, false);
+    r.setWakeSource(wake);
+
+    std::thread feeder([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::vector<uint8_t> two = kBasicFrame;
+        two.insert(two.end(), kBasicFrame.begin(), kBasicFrame.end());
+        s.inject(two);
+        r.notifyDataAvailable();
+    });
+    auto t0 = std::chrono::steady_clock::now();
+    bool parsed = r.waitAndRead(5000);
+    auto waited = std::chrono::steady_clock::now() - t0;
+    feeder.join();
+
+    CHECK(parsed);
+    CHECK(waited < std::chrono::seconds(2));       // woken, not timed out
+    CHECK(r.getSnapshot().sequence == 2);          // both frames in one pass
+    CHECK(r.movingTargetDistance() == 81);
+    std::printf("ok\n");
+}
+
+// With nothing arriving, waitAndRead() returns after its timeout.
+static void test_wait_and_read_timeout() {
+    std::printf("test_wait_and_read_timeout ... ");
+    ld2410 r;
+    LockedSerial s;
+    ld2410_condvar_wake_source wake;
+    r.begin(s, false);
+    r.setWakeSource(wake);
+    CHECK(!r.waitAndRead(10));
+    CHECK(r.getSnapshot().sequence == 0);
+    std::printf("ok\n");
+}
+
+int main() {
+    test_notify_before_wait();
+    test_wait_and_read_wakes_on_notify();
+    test_wait_and_read_timeout();
+
+    return test_result();
+}